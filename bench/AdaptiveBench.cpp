@@ -0,0 +1,49 @@
+/**
+ * @file AdaptiveBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief fixed sample counts against adaptive sampling at a few thresholds
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "benches.h"
+
+namespace {
+	void report(const std::string &label, double seconds, const Camera &camera) {
+		uint64_t samples = 0;
+		int pixels = 0, converged = 0;
+		for (const auto &stats: camera.getTileStats()) {
+			samples += stats.samples;
+			pixels += stats.pixels;
+			converged += stats.converged;
+		}
+		if (pixels == 0) {
+			spdlog::info("  {}: {:.3f}s, {} samples per pixel", label, seconds, camera.getSampleCount());
+			return;
+		}
+		spdlog::info("  {}: {:.3f}s, {:.1f} samples per pixel, {:.1f}% pixels converged", label, seconds,
+					 static_cast<double>(samples) / pixels, 100.0 * converged / pixels);
+	}
+} // namespace
+
+void adaptiveBench() {
+	auto world = makeCornellBoxWorld();
+	Camera camera(480, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
+	camera.setSampleCount(256);
+	camera.setRenderDepth(8);
+	camera.setChunkDimension(32);
+	camera.setBackground(Color{0, 0, 0});
+	spdlog::info("cornellBox: {}x{}, {} spp budget", camera.getWidth(), camera.getHeight(), camera.getSampleCount());
+
+	camera.setAdaptiveThreshold(0);
+	auto fixed = timeSeconds([&] { camera.Render(world, "adaptive_fixed.ppm", IMG_OUTPUT_DIR); });
+	report("fixed", fixed, camera);
+	for (float threshold: {0.02f, 0.05f, 0.1f}) {
+		camera.setAdaptiveThreshold(threshold);
+		auto name = fmt::format("adaptive_{}.ppm", threshold);
+		auto seconds = timeSeconds([&] { camera.Render(world, name, IMG_OUTPUT_DIR); });
+		report(fmt::format("threshold {}", threshold), seconds, camera);
+	}
+}
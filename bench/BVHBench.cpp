@@ -0,0 +1,128 @@
+/**
+ * @file BVHBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief BVH traversal against the original shared_ptr tree, and SAH build times
+ */
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include "BVH.h"
+#include "BVHBuilder.h"
+#include "BenchUtil.h"
+#include "benches.h"
+
+namespace {
+	/**
+	 * the pointer based BVH as it was before the flattened one replaced it, kept here as the baseline
+	 */
+	class PointerBVHNode : public IHittable {
+	public:
+		PointerBVHNode(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end) {
+			auto modifiable_objects = objects;
+			auto axis = randomInt(0, 2);
+			auto comparator = [axis](const std::shared_ptr<IHittable> &a, const std::shared_ptr<IHittable> &b) {
+				return a->boundingBox().axis(axis).min < b->boundingBox().axis(axis).min;
+			};
+			auto object_span = end - start;
+
+			if (object_span == 1) {
+				left = right = objects[start];
+			} else if (object_span == 2) {
+				if (comparator(objects[start], objects[start + 1])) {
+					left = objects[start];
+					right = objects[start + 1];
+				} else {
+					left = objects[start + 1];
+					right = objects[start];
+				}
+			} else {
+				std::sort(modifiable_objects.begin() + start, modifiable_objects.begin() + end, comparator);
+				auto mid = start + object_span / 2;
+				left = std::make_shared<PointerBVHNode>(modifiable_objects, start, mid);
+				right = std::make_shared<PointerBVHNode>(modifiable_objects, mid, end);
+			}
+			bbox = AABB(left->boundingBox(), right->boundingBox());
+		}
+
+		bool hit(const Ray &r, Interval interval, HitRecord &record) const override {
+			if (!bbox.hit(r, interval)) {
+				return false;
+			}
+			bool hit_left = left->hit(r, interval, record);
+			bool hit_right = right->hit(r, Interval(interval.min, hit_left ? record.t : interval.max), record);
+			return hit_left || hit_right;
+		}
+
+		AABB boundingBox() const override { return bbox; }
+
+	private:
+		std::shared_ptr<IHittable> left;
+		std::shared_ptr<IHittable> right;
+		AABB bbox;
+	};
+
+	struct TraceResult {
+		double seconds;
+		int hits;
+		double t_sum;
+	};
+
+	TraceResult trace(const IHittable &accel, const std::vector<Ray> &rays) {
+		TraceResult result{0, 0, 0};
+		result.seconds = timeSeconds([&] {
+			for (const auto &r: rays) {
+				HitRecord record;
+				if (accel.hit(r, Interval(EPS, INF), record)) {
+					result.hits++;
+					result.t_sum += record.t;
+				}
+			}
+		});
+		return result;
+	}
+} // namespace
+
+void bvhBench() {
+	const int ray_count = 500000;
+	for (int primitive_count: {1000, 10000}) {
+		float extent = 20;
+		auto world = makeSphereField(primitive_count, extent);
+		auto rays = makeIncomingRays(ray_count, extent);
+
+		std::shared_ptr<PointerBVHNode> tree;
+		auto tree_build = timeSeconds([&] { tree = std::make_shared<PointerBVHNode>(world.objects, 0, world.objects.size()); });
+		std::shared_ptr<BVHNode> flat;
+		auto flat_build = timeSeconds([&] { flat = std::make_shared<BVHNode>(world); });
+
+		auto tree_result = trace(*tree, rays);
+		auto flat_result = trace(*flat, rays);
+
+		spdlog::info("{} spheres, {} rays", primitive_count, ray_count);
+		spdlog::info("  pointer tree: build {:.3f}s, {:.2f} Mrays/s, {} hits", tree_build,
+					 ray_count / tree_result.seconds / 1e6, tree_result.hits);
+		spdlog::info("  linear bvh:   build {:.3f}s, {:.2f} Mrays/s, {} hits ({} nodes)", flat_build,
+					 ray_count / flat_result.seconds / 1e6, flat_result.hits, flat->getNodes().size());
+		spdlog::info("  speedup {:.2f}x", tree_result.seconds / flat_result.seconds);
+		if (tree_result.hits != flat_result.hits) {
+			spdlog::warn("  hit count mismatch between the two hierarchies");
+		}
+	}
+
+	for (int primitive_count: {100000, 1000000}) {
+		std::vector<AABB> bounds;
+		bounds.reserve(primitive_count);
+		for (int i = 0; i < primitive_count; i++) {
+			auto center = randomVec3(-100, 100);
+			auto r = Vec3::Constant(randomFloat(0.05, 0.3));
+			bounds.emplace_back(center - r, center + r);
+		}
+		BVHBuildOptions serial;
+		serial.parallel_threshold = static_cast<size_t>(primitive_count) + 1;
+		BVHBuildResult result;
+		auto serial_build = timeSeconds([&] { result = buildBVH(bounds, serial); });
+		auto parallel_build = timeSeconds([&] { result = buildBVH(bounds); });
+		spdlog::info("sah build of {} boxes: serial {:.3f}s, parallel {:.3f}s, {} nodes", primitive_count,
+					 serial_build, parallel_build, result.nodes.size());
+	}
+}
@@ -0,0 +1,158 @@
+/**
+ * @file BenchUtil.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief helpers shared by the benchmarks
+ */
+
+#ifndef RAYTRACING_BENCHUTIL_H
+#define RAYTRACING_BENCHUTIL_H
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <vector>
+#include "BVH.h"
+#include "GraphicObjects.h"
+#include "Material.h"
+#include "MathUtil.h"
+#include "SpherePool.h"
+
+template<typename F>
+double timeSeconds(F &&func) {
+	auto begin = std::chrono::steady_clock::now();
+	func();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+/**
+ * scatter small spheres in a cube of the given extent, the same kind of content as randomSpheres but
+ * at an arbitrary primitive count
+ */
+inline HittableList makeSphereField(int count, float extent) {
+	HittableList world;
+	auto mat = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+	for (int i = 0; i < count; i++) {
+		auto center = randomVec3(-extent, extent);
+		world.add(std::make_shared<Sphere>(randomFloat(0.05, 0.3), center, mat));
+	}
+	return world;
+}
+
+/**
+ * rays starting on a sphere around the scene and aimed at random points inside its bounds
+ */
+inline std::vector<Ray> makeIncomingRays(int count, float extent) {
+	std::vector<Ray> rays;
+	rays.reserve(count);
+	for (int i = 0; i < count; i++) {
+		Point3 origin = randomUnitVec3() * extent * 3;
+		Point3 target = randomVec3(-extent, extent);
+		rays.emplace_back(origin, target - origin);
+	}
+	return rays;
+}
+
+/**
+ * the randomSpheres scene, every small sphere gets its own lambertian, metal or glass material.
+ * the generator is reset first, so both layouts get the same spheres
+ * @param pooled put the spheres in one SpherePool instead of separate Sphere objects
+ */
+inline HittableList makeRandomSpheresWorld(bool pooled = false) {
+	threadRng() = Pcg32();
+	HittableList world;
+	auto pool = std::make_shared<SpherePool>();
+	auto add = [&](float radius, const Point3 &center, const std::shared_ptr<IMaterial> &mat) {
+		if (pooled) {
+			pool->add(center, radius, mat);
+		} else {
+			world.add(std::make_shared<Sphere>(radius, center, center, mat));
+		}
+	};
+	auto ground = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+	world.add(std::make_shared<Quad>(Vec3{-500, 0, -500}, Vec3{0, 0, 1000},
+									 Vec3{1000, 0, 0}, ground));
+	add(1, Vec3{0, 1, 0}, std::make_shared<Metal>(Color{0.9, 0.7, 0.7}, 0.4));
+	add(1, Vec3{4, 1, 0}, std::make_shared<Dielectric>(1.5, Color{0.8, 0.8, 0.8}));
+	add(1, Vec3{-4, 1, 0}, std::make_shared<Lambertian>(Color{0.4, 0.8, 1}));
+	for (int i = -22; i < 22; i += 2) {
+		for (int j = -22; j < 22; j += 2) {
+			auto coord = Vec3{(i + randomFloat(-1, 1)), 0.2, (j + randomFloat(-1, 1))};
+			if ((coord - Vec3{0, 1, 0}).norm() <= 0.9)
+				continue;
+			std::shared_ptr<IMaterial> mat;
+			switch (randomInt(0, 2)) {
+				case 0:
+					mat = std::make_shared<Lambertian>(Color{randomVec3().cwiseProduct(randomVec3())});
+					break;
+				case 1:
+					mat = std::make_shared<Metal>(Color{randomVec3(0.5, 1)}, randomFloat(0.2, 0.5));
+					break;
+				default:
+					mat = std::make_shared<Dielectric>(randomFloat(1, 2), Color{randomVec3(0.7, 1)});
+					break;
+			}
+			add(0.2, coord, mat);
+		}
+	}
+	if (pooled) {
+		pool->build();
+		world.add(pool);
+	}
+	return HittableList(std::make_shared<BVHNode>(world));
+}
+
+struct SphereMesh {
+	std::vector<Eigen::Vector3f> positions;
+	std::vector<Eigen::Vector3f> normals;
+	std::vector<uint32_t> indices;
+};
+
+/**
+ * latitude longitude sphere with 2 * stacks * slices triangles, the poles are rings of zero radius
+ */
+inline SphereMesh makeSphereMesh(int stacks, int slices, float radius) {
+	SphereMesh mesh;
+	for (int i = 0; i <= stacks; i++) {
+		auto theta = std::numbers::pi * i / stacks;
+		for (int j = 0; j <= slices; j++) {
+			auto phi = 2 * std::numbers::pi * j / slices;
+			Eigen::Vector3f n{static_cast<float>(std::sin(theta) * std::cos(phi)), static_cast<float>(std::cos(theta)),
+							  static_cast<float>(std::sin(theta) * std::sin(phi))};
+			mesh.positions.emplace_back(n * radius);
+			mesh.normals.push_back(n);
+		}
+	}
+	auto vertex = [slices](int i, int j) { return static_cast<uint32_t>(i * (slices + 1) + j); };
+	for (int i = 0; i < stacks; i++) {
+		for (int j = 0; j < slices; j++) {
+			mesh.indices.insert(mesh.indices.end(), {vertex(i, j), vertex(i, j + 1), vertex(i + 1, j)});
+			mesh.indices.insert(mesh.indices.end(), {vertex(i, j + 1), vertex(i + 1, j + 1), vertex(i + 1, j)});
+		}
+	}
+	return mesh;
+}
+
+/**
+ * the empty cornell box
+ */
+inline HittableList makeCornellBoxWorld() {
+	HittableList world;
+	auto red = std::make_shared<Lambertian>(Color{.65, .05, .05});
+	auto white = std::make_shared<Lambertian>(Color{.73, .73, .73});
+	auto green = std::make_shared<Lambertian>(Color{.12, .45, .15});
+	auto light = std::make_shared<DiffuseLight>(Color{15, 15, 15});
+	world.add(std::make_shared<Quad>(Point3{555, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, green));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, red));
+	world.add(std::make_shared<Quad>(Point3{343, 554, 332}, Vec3{-130, 0, 0}, Vec3{0, 0, -105},
+									 light));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{555, 0, 0}, Vec3{0, 0, 555}, white));
+	world.add(std::make_shared<Quad>(Point3{555, 555, 555}, Vec3{-555, 0, 0}, Vec3{0, 0, -555},
+									 white));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 555}, Vec3{555, 0, 0}, Vec3{0, 555, 0}, white));
+	return HittableList(std::make_shared<BVHNode>(world));
+}
+
+#endif // RAYTRACING_BENCHUTIL_H
@@ -0,0 +1,113 @@
+/**
+ * @file InstanceBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief many instances of one mesh against as many transformed copies of it
+ */
+
+#include <spdlog/spdlog.h>
+#include "BVH.h"
+#include "BenchUtil.h"
+#include "InstanceBVH.h"
+#include "TriangleMesh.h"
+#include "benches.h"
+
+namespace {
+	std::vector<Affine3> randomPlacements(int count, float extent) {
+		std::vector<Affine3> placements;
+		for (int i = 0; i < count; i++) {
+			Affine3 transform = Translation3(randomVec3(-extent, extent)) *
+											   AngleAxis(randomFloat(0, 2 * PI), randomUnitVec3()) *
+											   Eigen::Scaling(randomVec3(0.5, 2));
+			placements.push_back(transform);
+		}
+		return placements;
+	}
+
+	/**
+	 * the same scene with the vertices of every copy transformed and a mesh built for each
+	 */
+	std::shared_ptr<BVHNode> makeCopies(const SphereMesh &mesh, const std::vector<Affine3> &placements,
+										const std::shared_ptr<IMaterial> &mat, size_t &bytes) {
+		HittableList copies;
+		bytes = 0;
+		for (const auto &transform: placements) {
+			std::vector<Eigen::Vector3f> positions;
+			std::vector<Eigen::Vector3f> normals;
+			Mat3 normal_matrix = transform.linear().inverse().transpose();
+			for (size_t i = 0; i < mesh.positions.size(); i++) {
+				positions.emplace_back((transform * mesh.positions[i].cast<Real>()).cast<float>());
+				normals.emplace_back((normal_matrix * mesh.normals[i].cast<Real>()).normalized().cast<float>());
+			}
+			auto copy = std::make_shared<TriangleMesh>(std::move(positions), mesh.indices, mat, std::move(normals));
+			bytes += copy->memoryUsage();
+			copies.add(copy);
+		}
+		return std::make_shared<BVHNode>(copies);
+	}
+} // namespace
+
+void instanceBench() {
+	const int instance_count = 1000;
+	// 2 * 40 * 60 = 4800 triangles
+	auto sphere = makeSphereMesh(40, 60, 1);
+	auto mat = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+	auto placements = randomPlacements(instance_count, 40);
+	auto moved = randomPlacements(instance_count, 40);
+
+	auto mesh = std::make_shared<TriangleMesh>(sphere.positions, sphere.indices, mat, sphere.normals);
+	InstanceBVH instances;
+	auto geometry = instances.addGeometry(mesh);
+	auto instanced_build = timeSeconds([&] {
+		for (const auto &transform: placements) {
+			instances.addInstance(geometry, transform);
+		}
+		instances.build();
+	});
+	auto instanced_bytes = mesh->memoryUsage() + instance_count * (sizeof(Affine3) * 2 + 8) +
+						   (2 * instance_count - 1) * sizeof(LinearBVHNode);
+
+	size_t copy_bytes;
+	std::shared_ptr<BVHNode> copies;
+	auto copy_build = timeSeconds([&] { copies = makeCopies(sphere, placements, mat, copy_bytes); });
+
+	auto rays = makeIncomingRays(200000, 40);
+	const IHittable &instanced = instances;
+	const IHittable &copied = *copies;
+	int instanced_hits = 0, copy_hits = 0, mismatches = 0;
+	std::vector<float> copy_t(rays.size());
+	auto copy_rays = timeSeconds([&] {
+		HitRecord record;
+		for (size_t i = 0; i < rays.size(); i++) {
+			bool hit = copied.hit(rays[i], Interval(EPS, INF), record);
+			copy_hits += hit;
+			copy_t[i] = hit ? record.t : INF;
+		}
+	});
+	auto instanced_rays = timeSeconds([&] {
+		HitRecord record;
+		for (size_t i = 0; i < rays.size(); i++) {
+			bool hit = instanced.hit(rays[i], Interval(EPS, INF), record);
+			instanced_hits += hit;
+			// transformed vertices round differently, only count real disagreements
+			mismatches += std::abs((hit ? record.t : INF) - copy_t[i]) > 1e-3f * std::max(1.0f, copy_t[i]);
+		}
+	});
+
+	// every instance moves, only the top level is rebuilt
+	auto instanced_move = timeSeconds([&] {
+		for (int i = 0; i < instance_count; i++) {
+			instances.setTransform(i, moved[i]);
+		}
+		instances.build();
+	});
+	auto copy_move = timeSeconds([&] { copies = makeCopies(sphere, moved, mat, copy_bytes); });
+
+	auto mrays = static_cast<double>(rays.size()) / 1e6;
+	spdlog::info("{} instances of a {} triangle sphere, {} rays, {} mismatches", instance_count,
+				 mesh->triangleCount(), rays.size(), mismatches);
+	spdlog::info("  copies:    {:.1f} MB, build {:.3f}s, {:.2f} Mray/s, {} hits, move all {:.3f}s", copy_bytes / 1e6,
+				 copy_build, mrays / copy_rays, copy_hits, copy_move);
+	spdlog::info("  instances: {:.1f} MB, build {:.3f}s, {:.2f} Mray/s, {} hits, move all {:.3f}s",
+				 instanced_bytes / 1e6, instanced_build, mrays / instanced_rays, instanced_hits, instanced_move);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file LightSamplingBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief samples per pixel the empty cornell box needs to reach a target error, with and without light sampling
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "Framebuffer.h"
+#include "benches.h"
+
+namespace {
+	constexpr int reference_samples = 4096;
+	constexpr int max_samples = 1024;
+
+	double rmse(const Framebuffer &image, const Framebuffer &reference) {
+		double squared_error = 0;
+		for (int y = 0; y < image.height(); y++) {
+			for (int x = 0; x < image.width(); x++) {
+				squared_error += (image.getColor(x, y) - reference.getColor(x, y)).squaredNorm();
+			}
+		}
+		return std::sqrt(squared_error / (3.0 * image.width() * image.height()));
+	}
+
+	double meanRadiance(const Framebuffer &image) {
+		double sum = 0;
+		for (int y = 0; y < image.height(); y++) {
+			for (int x = 0; x < image.width(); x++) {
+				sum += image.getColor(x, y).sum() / 3;
+			}
+		}
+		return sum / (image.width() * image.height());
+	}
+
+	struct Point {
+		int samples;
+		double seconds;
+		double error;
+	};
+
+	/**
+	 * errors at doubling sample counts up to max_samples
+	 */
+	std::vector<Point> sweep(Camera &camera, const IHittable &world, const Framebuffer &reference, bool light_sampling,
+							 double &mean) {
+		std::vector<Point> points;
+		camera.setLightSampling(light_sampling);
+		for (int samples = 1; samples <= max_samples; samples *= 2) {
+			Framebuffer image(camera.getWidth(), camera.getHeight(), FB_SAMPLE_COUNT);
+			camera.setSampleCount(samples);
+			auto seconds = timeSeconds([&] { camera.renderTo(world, image); });
+			points.push_back(Point{samples, seconds, rmse(image, reference)});
+			mean = meanRadiance(image);
+		}
+		return points;
+	}
+
+	const Point *firstBelow(const std::vector<Point> &points, double target) {
+		for (const auto &point: points) {
+			if (point.error <= target)
+				return &point;
+		}
+		return nullptr;
+	}
+} // namespace
+
+void lightSamplingBench() {
+	auto world = makeCornellBoxWorld();
+	Camera camera(96, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
+	camera.setRenderDepth(4);
+	camera.setChunkDimension(16);
+	camera.setBackground(Color{0, 0, 0});
+	auto level = spdlog::get_level();
+	spdlog::set_level(spdlog::level::warn);
+
+	// another frame, so the reference shares no random numbers with the images it is compared to
+	Framebuffer reference(camera.getWidth(), camera.getHeight(), FB_SAMPLE_COUNT);
+	camera.setFrame(1);
+	camera.setLightSampling(true);
+	camera.setSampleCount(reference_samples);
+	auto reference_seconds = timeSeconds([&] { camera.renderTo(world, reference); });
+	camera.setFrame(0);
+
+	double brute_mean = 0, nee_mean = 0;
+	auto brute = sweep(camera, world, reference, false, brute_mean);
+	auto nee = sweep(camera, world, reference, true, nee_mean);
+	spdlog::set_level(level);
+
+	spdlog::info("empty cornellBox {}x{}, depth {}, reference {} spp with light sampling in {:.1f}s",
+				 camera.getWidth(), camera.getHeight(), camera.getRenderDepth(), reference_samples, reference_seconds);
+	spdlog::info("  {:>5}  {:>22}  {:>22}", "spp", "bounces only", "light sampling + MIS");
+	for (size_t i = 0; i < brute.size(); i++) {
+		spdlog::info("  {:>5}  rmse {:8.4f} {:7.3f}s  rmse {:8.4f} {:7.3f}s", brute[i].samples, brute[i].error,
+					 brute[i].seconds, nee[i].error, nee[i].seconds);
+	}
+	// both have to converge to the same image, only the noise may differ
+	spdlog::info("  mean radiance at {} spp: {:.4f} bounces only, {:.4f} light sampling, {:.4f} reference", max_samples,
+				 brute_mean, nee_mean, meanRadiance(reference));
+	auto target = brute.back().error;
+	const auto *reached = firstBelow(nee, target);
+	if (reached != nullptr) {
+		spdlog::info("  rmse {:.4f}: {} spp in {:.3f}s bounces only, {} spp in {:.3f}s with light sampling", target,
+					 brute.back().samples, brute.back().seconds, reached->samples, reached->seconds);
+	}
+}
@@ -0,0 +1,133 @@
+/**
+ * @file MaterialBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief shading through the IMaterial vtable against the switch over the flat material records
+ */
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include "BenchUtil.h"
+#include "benches.h"
+
+namespace {
+	// small enough to stay in cache, so memory traffic does not hide the dispatch
+	constexpr int hit_count = 1 << 14;
+	constexpr int repeats = 16;
+
+	struct ShadingPoint {
+		Ray ray;
+		HitRecord record;
+	};
+
+	struct Result {
+		double seconds;
+		Color sum;
+	};
+
+	constexpr int trials = 5;
+
+	/**
+	 * shade every point repeats times, best time of a few trials since the differences are small
+	 */
+	template<typename F>
+	Result shadeAll(const std::vector<ShadingPoint> &points, F &&shade) {
+		Result result{INF, Color{0, 0, 0}};
+		for (int trial = 0; trial < trials; trial++) {
+			threadRng() = Pcg32();
+			Color sum{0, 0, 0};
+			auto seconds = timeSeconds([&] {
+				for (int i = 0; i < repeats; i++) {
+					for (const auto &point: points) {
+						sum += shade(point);
+					}
+				}
+			});
+			result.seconds = std::min(result.seconds, seconds);
+			result.sum = sum;
+		}
+		return result;
+	}
+} // namespace
+
+void materialBench() {
+	auto first = static_cast<uint32_t>(MaterialRegistry::instance().size());
+	auto world = makeRandomSpheresWorld();
+	auto last = static_cast<uint32_t>(MaterialRegistry::instance().size());
+
+	threadRng() = Pcg32();
+	std::vector<ShadingPoint> points;
+	points.reserve(hit_count);
+	for (int i = 0; i < hit_count; i++) {
+		ShadingPoint point;
+		point.ray = Ray(randomVec3(-10, 10), randomUnitVec3());
+		point.record.p = randomVec3(-10, 10);
+		point.record.setFaceNormal(point.ray, randomUnitVec3());
+		point.record.u = randomFloat();
+		point.record.v = randomFloat();
+		point.record.t = 1;
+		point.record.material_id = static_cast<uint32_t>(randomInt(first, last - 1));
+		points.push_back(point);
+	}
+	auto sorted = points;
+	std::stable_sort(sorted.begin(), sorted.end(), [](const ShadingPoint &a, const ShadingPoint &b) {
+		auto type_a = MaterialRegistry::record(a.record.material_id).type;
+		auto type_b = MaterialRegistry::record(b.record.material_id).type;
+		return type_a != type_b ? type_a < type_b : a.record.material_id < b.record.material_id;
+	});
+
+	// emission and one scatter per point, the work a path does at every bounce
+	auto virtual_shade = [](const ShadingPoint &point) {
+		const auto *material = MaterialRegistry::get(point.record.material_id);
+		Color color = material->emitted(point.record.u, point.record.v, point.record.p);
+		Ray scattered;
+		Color attenuation;
+		if (material->scatter(point.ray, point.record, attenuation, scattered)) {
+			color += attenuation + scattered.dir();
+		}
+		return color;
+	};
+	auto switch_shade = [](const ShadingPoint &point) {
+		const auto &record = point.record;
+		Color color = MaterialRegistry::emitted(record.material_id, record.u, record.v, record.p);
+		Ray scattered;
+		Color attenuation;
+		if (MaterialRegistry::scatter(record.material_id, point.ray, record, attenuation, scattered)) {
+			color += attenuation + scattered.dir();
+		}
+		return color;
+	};
+	// no random numbers and no new ray, what is left is mostly the dispatch
+	auto virtual_lookup = [](const ShadingPoint &point) {
+		const auto *material = MaterialRegistry::get(point.record.material_id);
+		Color color = material->emitted(point.record.u, point.record.v, point.record.p);
+		return color + Color::Constant(material->scatteringPdf(point.ray, point.record, -point.ray.dir()));
+	};
+	auto switch_lookup = [](const ShadingPoint &point) {
+		const auto &record = point.record;
+		Color color = MaterialRegistry::emitted(record.material_id, record.u, record.v, record.p);
+		return color + Color::Constant(MaterialRegistry::scatteringPdf(record.material_id, point.ray, record,
+																	   -point.ray.dir()));
+	};
+	auto virtual_random = shadeAll(points, virtual_shade);
+	auto switch_random = shadeAll(points, switch_shade);
+	auto virtual_sorted = shadeAll(sorted, virtual_shade);
+	auto switch_sorted = shadeAll(sorted, switch_shade);
+	auto virtual_lookup_random = shadeAll(points, virtual_lookup);
+	auto switch_lookup_random = shadeAll(points, switch_lookup);
+
+	auto report = [&](const char *name, const Result &result, const Result &baseline) {
+		auto shades = static_cast<double>(hit_count) * repeats;
+		spdlog::info("  {:<28} {:6.2f} M shades/s, {:.2f}x, checksum {:.6e}", name, shades / result.seconds / 1e6,
+					 baseline.seconds / result.seconds, result.sum.sum());
+	};
+	spdlog::info("{} shading points over the {} materials of randomSpheres", hit_count, last - first);
+	spdlog::info("emission and scatter:");
+	report("virtual, random order", virtual_random, virtual_random);
+	report("switch, random order", switch_random, virtual_random);
+	report("virtual, sorted by material", virtual_sorted, virtual_random);
+	report("switch, sorted by material", switch_sorted, virtual_random);
+	spdlog::info("emission and scattering pdf only:");
+	report("virtual, random order", virtual_lookup_random, virtual_lookup_random);
+	report("switch, random order", switch_lookup_random, virtual_lookup_random);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file MeshBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief a tessellated sphere as one TriangleMesh against separate Triangle objects
+ */
+
+#include <spdlog/spdlog.h>
+#include "BVH.h"
+#include "BenchUtil.h"
+#include "TriangleMesh.h"
+#include "benches.h"
+
+void meshBench() {
+	// 2 * 500 * 1000 = 1M triangles
+	auto sphere = makeSphereMesh(500, 1000, 2);
+	auto mat = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+
+	HittableList triangles;
+	for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+		Point3 a = sphere.positions[sphere.indices[i]].cast<Real>();
+		Point3 b = sphere.positions[sphere.indices[i + 1]].cast<Real>();
+		Point3 c = sphere.positions[sphere.indices[i + 2]].cast<Real>();
+		triangles.add(std::make_shared<Triangle>(a, b - a, c - a, mat));
+	}
+	BVHNode *object_bvh = nullptr;
+	auto object_build = timeSeconds([&] { object_bvh = new BVHNode(triangles); });
+	std::unique_ptr<BVHNode> object_owner(object_bvh);
+	// every object costs the Triangle, its shared_ptr control block and the two pointers held to it
+	auto object_bytes = triangles.objects.size() *
+						(sizeof(Triangle) + 2 * sizeof(void *) + 2 * sizeof(std::shared_ptr<IHittable>));
+
+	auto triangle_count = sphere.indices.size() / 3;
+	std::unique_ptr<TriangleMesh> mesh;
+	auto mesh_build = timeSeconds([&] {
+		mesh = std::make_unique<TriangleMesh>(sphere.positions, sphere.indices, mat, sphere.normals);
+	});
+
+	auto rays = makeIncomingRays(500000, 2);
+	const IHittable &objects = *object_bvh;
+	const IHittable &meshed = *mesh;
+	int object_hits = 0, mesh_hits = 0;
+	auto object_rays = timeSeconds([&] {
+		HitRecord record;
+		for (const auto &ray: rays) {
+			object_hits += objects.hit(ray, Interval(EPS, INF), record);
+		}
+	});
+	auto mesh_rays = timeSeconds([&] {
+		HitRecord record;
+		for (const auto &ray: rays) {
+			mesh_hits += meshed.hit(ray, Interval(EPS, INF), record);
+		}
+	});
+
+	auto mrays = static_cast<double>(rays.size()) / 1e6;
+	spdlog::info("tessellated sphere: {} triangles, {} vertices, {} rays", triangle_count, mesh->vertexCount(),
+				 rays.size());
+	spdlog::info("  triangle objects: {:.1f} MB without the hierarchy, build {:.3f}s, {:.2f} Mray/s, {} hits",
+				 object_bytes / 1e6, object_build, mrays / object_rays, object_hits);
+	spdlog::info("  triangle mesh:    {:.1f} MB with the hierarchy, build {:.3f}s, {:.2f} Mray/s, {} hits, {:.2f}x",
+				 mesh->memoryUsage() / 1e6, mesh_build, mrays / mesh_rays, mesh_hits, object_rays / mesh_rays);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file MeshLoadBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief time to first ray for OBJ and PLY meshes, parsed against mapped from the cache
+ */
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "MeshLoader.h"
+#include "benches.h"
+
+namespace {
+	void writeObj(const std::string &filepath, const SphereMesh &mesh) {
+		std::ofstream out(filepath);
+		for (const auto &p: mesh.positions) {
+			out << fmt::format("v {} {} {}\n", p.x(), p.y(), p.z());
+		}
+		for (const auto &n: mesh.normals) {
+			out << fmt::format("vn {} {} {}\n", n.x(), n.y(), n.z());
+		}
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			auto a = mesh.indices[i] + 1, b = mesh.indices[i + 1] + 1, c = mesh.indices[i + 2] + 1;
+			out << fmt::format("f {}//{} {}//{} {}//{}\n", a, a, b, b, c, c);
+		}
+	}
+
+	void writePly(const std::string &filepath, const SphereMesh &mesh) {
+		std::ofstream out(filepath, std::ios::binary);
+		out << "ply\nformat binary_little_endian 1.0\n";
+		out << "element vertex " << mesh.positions.size() << "\n";
+		out << "property float x\nproperty float y\nproperty float z\n";
+		out << "property float nx\nproperty float ny\nproperty float nz\n";
+		out << "element face " << mesh.indices.size() / 3 << "\n";
+		out << "property list uchar int vertex_indices\nend_header\n";
+		for (size_t i = 0; i < mesh.positions.size(); i++) {
+			out.write(reinterpret_cast<const char *>(mesh.positions[i].data()), 3 * sizeof(float));
+			out.write(reinterpret_cast<const char *>(mesh.normals[i].data()), 3 * sizeof(float));
+		}
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			uint8_t count = 3;
+			out.write(reinterpret_cast<const char *>(&count), 1);
+			out.write(reinterpret_cast<const char *>(&mesh.indices[i]), 3 * sizeof(uint32_t));
+		}
+	}
+
+	/**
+	 * seconds from asking for the mesh until the first ray has been traced through it
+	 */
+	double timeToFirstRay(const std::string &filepath, std::shared_ptr<TriangleMesh> &mesh) {
+		auto mat = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+		return timeSeconds([&] {
+			mesh = loadMesh(filepath, mat);
+			HitRecord record;
+			if (mesh == nullptr || !mesh->hit(Ray(Point3{0, 0, 10}, Vec3{0, 0, -1}), Interval(EPS, INF),
+											  record)) {
+				spdlog::error("first ray through {} missed", filepath);
+			}
+		});
+	}
+
+	/**
+	 * the parsed and the mapped mesh have to give the same records
+	 */
+	int countMismatches(const TriangleMesh &parsed, const TriangleMesh &mapped, const std::vector<Ray> &rays) {
+		int mismatches = 0;
+		for (const auto &ray: rays) {
+			HitRecord a{}, b{};
+			bool hit_a = parsed.hit(ray, Interval(EPS, INF), a);
+			bool hit_b = mapped.hit(ray, Interval(EPS, INF), b);
+			mismatches += hit_a != hit_b || (hit_a && (a.t != b.t || a.normal != b.normal || a.u != b.u));
+		}
+		return mismatches;
+	}
+} // namespace
+
+void meshLoadBench() {
+	// 2 * 1000 * 1500 = 3M triangles
+	auto sphere = makeSphereMesh(1000, 1500, 2);
+	auto rays = makeIncomingRays(100000, 2);
+	for (const auto &extension: {".obj", ".ply"}) {
+		auto filepath = (std::filesystem::path(IMG_OUTPUT_DIR) / (std::string("sphere") + extension)).string();
+		auto write_time = timeSeconds([&] {
+			if (std::string(extension) == ".obj")
+				writeObj(filepath, sphere);
+			else
+				writePly(filepath, sphere);
+		});
+		std::filesystem::remove(meshCachePath(filepath));
+
+		std::shared_ptr<TriangleMesh> parsed, mapped;
+		auto cold = timeToFirstRay(filepath, parsed);
+		auto warm = timeToFirstRay(filepath, mapped);
+		if (parsed == nullptr || mapped == nullptr)
+			continue;
+		spdlog::info("{}: {} triangles, {:.1f} MB file written in {:.3f}s, {:.1f} MB cache", filepath,
+					 parsed->triangleCount(), std::filesystem::file_size(filepath) / 1e6, write_time,
+					 std::filesystem::file_size(meshCachePath(filepath)) / 1e6);
+		spdlog::info("  time to first ray: parsed {:.3f}s, mapped {:.3f}ms, {} mismatches over {} rays", cold,
+					 warm * 1e3, countMismatches(*parsed, *mapped, rays), rays.size());
+	}
+}
@@ -0,0 +1,199 @@
+/**
+ * @file NoiseBench.cpp
+ * @author ayano
+ * @date 10/18/26
+ * @brief octave noise evaluations per second, scalar as it was, vectorized over octaves and baked
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "benches.h"
+
+namespace {
+	constexpr int point_count = 1 << 18;
+
+	// Ken Perlin's reference permutation, the table of Perlin, repeated once so hashes never wrap
+	constexpr int reference_perm[] = {
+			151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225,
+			140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23, 190, 6, 148,
+			247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32,
+			57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175,
+			74, 165, 71, 134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122,
+			60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244, 102, 143, 54,
+			65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169,
+			200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64,
+			52, 217, 226, 250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212,
+			207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42, 223, 183, 170, 213,
+			119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
+			129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104,
+			218, 246, 97, 228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241,
+			81, 51, 145, 235, 249, 14, 239, 107, 49, 192, 214, 31, 181, 199, 106, 157,
+			184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138, 236, 205, 93,
+			222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180};
+
+	struct OldPerlinTable {
+		int perm[512];
+
+		OldPerlinTable() {
+			for (int i = 0; i < 512; i++)
+				perm[i] = reference_perm[i & 255];
+		}
+	};
+
+	const OldPerlinTable old_table;
+
+	/**
+	 * Perlin::gradientDotProd as it was
+	 */
+	float oldGradient(int hash, float x, float y, float z) {
+		switch (hash & 0xF) {
+			case 0x0:
+				return x + y;
+			case 0x1:
+				return -x + y;
+			case 0x2:
+				return x - y;
+			case 0x3:
+				return -x - y;
+			case 0x4:
+				return x + z;
+			case 0x5:
+				return -x + z;
+			case 0x6:
+				return x - z;
+			case 0x7:
+				return -x - z;
+			case 0x8:
+				return y + z;
+			case 0x9:
+				return -y + z;
+			case 0xA:
+				return y - z;
+			case 0xB:
+				return -y - z;
+			case 0xC:
+				return y + x;
+			case 0xD:
+				return -y + z;
+			case 0xE:
+				return y - x;
+			case 0xF:
+				return -y - z;
+			default:
+				return 0;
+		}
+	}
+
+	float fade(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+
+	float lerp(float begin, float end, float weight) { return begin + weight * (end - begin); }
+
+	/**
+	 * Perlin::rawNoise as it was, three levels of lookups for every corner
+	 */
+	float oldRawNoise(const Point3 &p) {
+		const int *perm = old_table.perm;
+		float x = p[0], y = p[1], z = p[2];
+		int xi = static_cast<int>(floor(x)) & 255;
+		int yi = static_cast<int>(floor(y)) & 255;
+		int zi = static_cast<int>(floor(z)) & 255;
+		x -= floor(x);
+		y -= floor(y);
+		z -= floor(z);
+		int llb = perm[perm[perm[xi] + yi] + zi];
+		int lrb = perm[perm[perm[xi + 1] + yi] + zi];
+		int ulb = perm[perm[perm[xi] + yi + 1] + zi];
+		int urb = perm[perm[perm[xi + 1] + yi + 1] + zi];
+		int llf = perm[perm[perm[xi] + yi] + zi + 1];
+		int lrf = perm[perm[perm[xi + 1] + yi] + zi + 1];
+		int ulf = perm[perm[perm[xi] + yi + 1] + zi + 1];
+		int urf = perm[perm[perm[xi + 1] + yi + 1] + zi + 1];
+		float u = fade(x), v = fade(y), w = fade(z);
+		float x0 = lerp(oldGradient(llb, x, y, z), oldGradient(lrb, x - 1, y, z), u);
+		float x1 = lerp(oldGradient(ulb, x, y - 1, z), oldGradient(urb, x - 1, y - 1, z), u);
+		float x2 = lerp(oldGradient(llf, x, y, z - 1), oldGradient(lrf, x - 1, y, z - 1), u);
+		float x3 = lerp(oldGradient(ulf, x, y - 1, z - 1), oldGradient(urf, x - 1, y - 1, z - 1), u);
+		return lerp(lerp(x0, x1, v), lerp(x2, x3, v), w);
+	}
+
+	/**
+	 * the octave loop of Perlin::octaveNoise as it was, over any single octave function
+	 */
+	template<typename F>
+	float octaveLoop(F &&raw, const Point3 &p, float frequency, int octave_count, float persistence) {
+		float sum = 0;
+		float max_value = 0;
+		float amplitude = 1;
+		for (int i = 0; i < octave_count; ++i) {
+			sum += raw(p * frequency) * amplitude;
+			max_value += amplitude;
+			amplitude *= persistence;
+			frequency *= 2;
+		}
+		return sum / max_value;
+	}
+
+	struct Result {
+		double seconds;
+		std::vector<float> values;
+	};
+
+	template<typename F>
+	Result run(const std::vector<Point3> &points, F &&noise) {
+		Result result;
+		result.values.resize(points.size());
+		result.seconds = timeSeconds([&] {
+			for (size_t i = 0; i < points.size(); i++) {
+				result.values[i] = noise(points[i]);
+			}
+		});
+		return result;
+	}
+} // namespace
+
+void noiseBench() {
+	threadRng() = Pcg32();
+	// the terrain scene: noise of frequency 0.5, 10 octaves, persistence 0.5 on a sphere of radius 10
+	const float frequency = 0.5, persistence = 0.5;
+	const int octave_count = 10;
+	const float radius = 10;
+	std::vector<Point3> points;
+	points.reserve(point_count);
+	for (int i = 0; i < point_count; i++) {
+		points.emplace_back(randomUnitVec3() * radius);
+	}
+
+	Perlin perlin;
+	auto old = run(points, [&](const Point3 &p) {
+		return octaveLoop(oldRawNoise, p, frequency, octave_count, persistence);
+	});
+	auto report = [&](const char *name, const Result &result) {
+		float max_error = 0;
+		double error = 0;
+		for (size_t i = 0; i < points.size(); i++) {
+			float e = std::fabs(result.values[i] - old.values[i]);
+			max_error = std::max(max_error, e);
+			error += e;
+		}
+		spdlog::info("  {:<32} {:6.2f} M evals/s, {:5.2f}x, mean error {:.2e}, max error {:.2e}", name,
+					 points.size() / result.seconds / 1e6, old.seconds / result.seconds, error / points.size(),
+					 max_error);
+	};
+	spdlog::info("{} points, {} octaves", points.size(), octave_count);
+	report("scalar, as it was", old);
+	report("scalar, shared hashes and table", run(points, [&](const Point3 &p) {
+		return octaveLoop([&](const Point3 &q) { return perlin.rawNoise(q); }, p, frequency, octave_count,
+						  persistence);
+	}));
+	report("octaves in Float8 lanes", run(points, [&](const Point3 &p) {
+		return perlin.octaveNoise(p, frequency, octave_count, persistence);
+	}));
+	AABB bounds(Point3{-radius, -radius, -radius}, Point3{radius, radius, radius});
+	for (int resolution: {128, 256}) {
+		OctaveNoise noise(frequency, octave_count, persistence);
+		auto bake = timeSeconds([&] { noise.bake(bounds, resolution); });
+		auto result = run(points, [&](const Point3 &p) { return noise.value(p); });
+		auto name = fmt::format("{} baked, {} grid, {:.1f}s bake", noise.bakedOctaves(), resolution, bake);
+		report(name.c_str(), result);
+	}
+}
@@ -0,0 +1,79 @@
+/**
+ * @file PacketBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief primary ray throughput, one ray at a time against 4x2 packets
+ */
+
+#include <spdlog/spdlog.h>
+#include "BVH.h"
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "Material.h"
+#include "RayPacket.h"
+#include "benches.h"
+
+namespace {
+	void compare(const std::string &name, const IHittable &world, Camera &camera) {
+		const int width = camera.getWidth(), height = camera.getHeight();
+		std::vector<Ray> rays;
+		rays.reserve(static_cast<size_t>(width) * height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				seedSampleStream(0, static_cast<uint32_t>(y * width + x), 0);
+				rays.emplace_back(camera.getRay(x, y));
+			}
+		}
+
+		int scalar_hits = 0;
+		auto scalar = timeSeconds([&] {
+			HitRecord record;
+			for (const auto &ray: rays) {
+				scalar_hits += world.hit(ray, Interval(EPS, INF), record);
+			}
+		});
+
+		int packet_hits = 0;
+		auto packet_time = timeSeconds([&] {
+			RayPacket packet{};
+			HitRecord records[RayPacket::size];
+			for (int by = 0; by < height; by += 2) {
+				for (int bx = 0; bx < width; bx += 4) {
+					packet.active = 0;
+					for (int lane = 0; lane < RayPacket::size; lane++) {
+						int x = bx + lane % 4, y = by + lane / 4;
+						if (x < width && y < height)
+							packet.set(lane, rays[static_cast<size_t>(y) * width + x]);
+					}
+					packet_hits += std::popcount(world.hitPacket(packet, packet.active, EPS, records));
+				}
+			}
+		});
+
+		auto mrays = static_cast<double>(rays.size()) / 1e6;
+		spdlog::info("{}: {} primary rays", name, rays.size());
+		spdlog::info("  single rays: {:.3f}s, {:.2f} Mray/s, {} hits", scalar, mrays / scalar, scalar_hits);
+		spdlog::info("  4x2 packets: {:.3f}s, {:.2f} Mray/s, {} hits, {:.2f}x", packet_time, mrays / packet_time,
+					 packet_hits, scalar / packet_time);
+	}
+} // namespace
+
+void packetBench() {
+#if defined(RAYTRACING_SIMD_AVX)
+	spdlog::info("packet lanes run on AVX");
+#elif defined(RAYTRACING_SIMD_SSE)
+	spdlog::info("packet lanes run on SSE");
+#else
+	spdlog::info("packet lanes run as scalar loops");
+#endif
+	{
+		auto world = makeRandomSpheresWorld();
+		Camera camera(1920, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
+		compare("randomSpheres", world, camera);
+	}
+	{
+		auto world = makeCornellBoxWorld();
+		Camera camera(1920, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
+		compare("cornellBox", world, camera);
+	}
+}
@@ -0,0 +1,123 @@
+/**
+ * @file PrecisionBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief the sphere kernel in float against double, throughput and how far the float image drifts
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "GraphicObjects.h"
+#include "benches.h"
+
+namespace {
+	constexpr int width = 640;
+	constexpr int height = 360;
+
+	struct SphereSet {
+		std::vector<Vec3> centers;
+		std::vector<float> radii;
+	};
+
+	SphereSet makeSpheres(int count, const Vec3 &offset) {
+		threadRng() = Pcg32();
+		SphereSet set;
+		for (int i = 0; i < count; i++) {
+			set.centers.push_back(offset + Vec3{randomFloat(-8, 8), randomFloat(-4, 4), randomFloat(-20, -6)});
+			set.radii.push_back(randomFloat(0.3, 1.5));
+		}
+		return set;
+	}
+
+	/**
+	 * primary rays of a pinhole camera at offset looking down -z, built in double and rounded once
+	 */
+	template<typename T>
+	std::vector<RayT<T>> makeCameraRays(const Vec3 &offset) {
+		using V = typename Precision<T>::Vec3;
+		std::vector<RayT<T>> rays;
+		rays.reserve(width * height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				Eigen::Vector3d dir{(x + 0.5) / height * 2 - static_cast<double>(width) / height,
+									1 - (y + 0.5) / height * 2, -1.5};
+				rays.emplace_back(offset.cast<double>().cast<T>().eval(), V(dir.cast<T>()));
+			}
+		}
+		return rays;
+	}
+
+	/**
+	 * nearest sphere per ray shaded by a headlight, -1 for a miss. distances go to t
+	 */
+	template<typename T>
+	double render(const SphereSet &set, const Vec3 &offset, std::vector<float> &image, std::vector<float> &t) {
+		using V = typename Precision<T>::Vec3;
+		std::vector<V> centers;
+		std::vector<T> radii;
+		for (size_t i = 0; i < set.centers.size(); i++) {
+			centers.push_back(set.centers[i].template cast<T>());
+			radii.push_back(static_cast<T>(set.radii[i]));
+		}
+		auto rays = makeCameraRays<T>(offset);
+		image.assign(rays.size(), -1);
+		t.assign(rays.size(), INF);
+		return timeSeconds([&] {
+			for (size_t i = 0; i < rays.size(); i++) {
+				const auto &r = rays[i];
+				T closest = std::numeric_limits<T>::infinity();
+				int nearest = -1;
+				for (size_t s = 0; s < centers.size(); s++) {
+					T root;
+					if (sphereRoot<T>(r, centers[s], radii[s], T(1e-3), closest, root)) {
+						closest = root;
+						nearest = static_cast<int>(s);
+					}
+				}
+				if (nearest >= 0) {
+					V normal = (r.at(closest) - centers[nearest]) / radii[nearest];
+					image[i] = static_cast<float>(-normal.dot(r.dir()) / r.dir().norm());
+					t[i] = static_cast<float>(closest);
+				}
+			}
+		});
+	}
+
+	void compare(const char *label, const Vec3 &offset) {
+		auto spheres = makeSpheres(64, offset);
+		std::vector<float> image_d, image_f, t_d, t_f;
+		auto double_time = render<double>(spheres, offset, image_d, t_d);
+		auto float_time = render<float>(spheres, offset, image_f, t_f);
+
+		int coverage_mismatches = 0, hits = 0;
+		double squared_error = 0, max_error = 0, t_error = 0;
+		for (size_t i = 0; i < image_d.size(); i++) {
+			if ((image_d[i] < 0) != (image_f[i] < 0)) {
+				coverage_mismatches++;
+				continue;
+			}
+			if (image_d[i] < 0)
+				continue;
+			hits++;
+			double diff = std::abs(image_d[i] - image_f[i]);
+			squared_error += diff * diff;
+			max_error = std::max(max_error, diff);
+			t_error += std::abs(t_d[i] - t_f[i]) / t_d[i];
+		}
+		auto mrays = static_cast<double>(image_d.size()) / 1e6;
+		spdlog::info("{}: 64 spheres, {}x{} primary rays", label, width, height);
+		spdlog::info("  double: {:.2f} Mray/s", mrays / double_time);
+		spdlog::info("  float:  {:.2f} Mray/s, {:.2f}x", mrays / float_time, double_time / float_time);
+		spdlog::info("  float image: rmse {:.2e}, max {:.2e}, mean relative t error {:.2e}, {} pixels covered "
+					 "differently",
+					 hits > 0 ? std::sqrt(squared_error / hits) : 0.0, max_error, hits > 0 ? t_error / hits : 0.0,
+					 coverage_mismatches);
+	}
+} // namespace
+
+void precisionBench() {
+	spdlog::info("tracer compiled with {} precision", sizeof(Real) == sizeof(float) ? "single" : "double");
+	compare("at the origin", Vec3{0, 0, 0});
+	// float loses about 1e-3 of absolute precision this far out
+	compare("offset by 1e4", Vec3{1e4, 1e4, 1e4});
+}
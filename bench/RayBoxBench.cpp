@@ -0,0 +1,180 @@
+/**
+ * @file RayBoxBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief ray box tests per second for every kernel in RayBox.h against AABB::hit and the old min/max test
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "RayBox.h"
+#include "benches.h"
+
+namespace {
+	constexpr int box_count = 1024;
+	constexpr int ray_count = 32768;
+
+	/**
+	 * LinearBVHNode::hit as it was, a division free min/max slab test that orders the slab distances
+	 * instead of picking them by the sign of the direction
+	 */
+	bool minMaxSlab(const SlabRay &r, const float *bounds, float t_min, float t_max) {
+		for (int i = 0; i < 3; i++) {
+			float t0 = (bounds[i] - r.origin[i]) * r.inv_dir[i];
+			float t1 = (bounds[3 + i] - r.origin[i]) * r.inv_dir[i];
+			t_min = std::max(t_min, std::min(t0, t1));
+			t_max = std::min(t_max, std::max(t0, t1));
+		}
+		return t_min <= t_max;
+	}
+
+	struct Boxes {
+		// min x y z max x y z and two floats of padding, the 32 byte stride of LinearBVHNode
+		std::vector<std::array<float, 8>> aos;
+		std::vector<AABB> aabbs;
+		// structure of arrays in groups of eight, groups of four are the two halves
+		struct alignas(32) Group8 {
+			float bounds_min[3][8];
+			float bounds_max[3][8];
+		};
+		struct alignas(16) Group4 {
+			float bounds_min[3][4];
+			float bounds_max[3][4];
+		};
+		std::vector<Group8> groups8;
+		std::vector<Group4> groups4;
+	};
+
+	Boxes makeBoxes(float extent) {
+		Boxes boxes;
+		for (int i = 0; i < box_count; i++) {
+			Point3 a = randomVec3(-extent, extent);
+			Point3 b = a + randomVec3(0.5, extent / 4);
+			boxes.aabbs.emplace_back(a, b);
+			std::array<float, 8> flat{};
+			for (int axis = 0; axis < 3; axis++) {
+				flat[axis] = static_cast<float>(a[axis]);
+				flat[3 + axis] = static_cast<float>(b[axis]);
+			}
+			boxes.aos.push_back(flat);
+		}
+		boxes.groups8.resize(box_count / 8);
+		boxes.groups4.resize(box_count / 4);
+		for (int i = 0; i < box_count; i++) {
+			for (int axis = 0; axis < 3; axis++) {
+				boxes.groups8[i / 8].bounds_min[axis][i % 8] = boxes.aos[i][axis];
+				boxes.groups8[i / 8].bounds_max[axis][i % 8] = boxes.aos[i][3 + axis];
+				boxes.groups4[i / 4].bounds_min[axis][i % 4] = boxes.aos[i][axis];
+				boxes.groups4[i / 4].bounds_max[axis][i % 4] = boxes.aos[i][3 + axis];
+			}
+		}
+		return boxes;
+	}
+
+	/**
+	 * random rays, and axis parallel rays starting on box faces so the NaN slabs get exercised
+	 */
+	std::vector<Ray> makeRays(const Boxes &boxes, float extent) {
+		auto rays = makeIncomingRays(ray_count - ray_count / 8, extent);
+		for (int i = 0; i < ray_count / 8; i++) {
+			const auto &box = boxes.aos[randomInt(0, box_count - 1)];
+			int axis = i % 3;
+			Vec3 dir = Vec3::Zero();
+			dir[axis] = i % 2 ? 1 : -1;
+			Point3 origin{box[0], box[1], box[2]};
+			origin[(axis + 1) % 3] = box[3 + (axis + 1) % 3];
+			origin[axis] -= dir[axis] * extent;
+			rays.emplace_back(origin, dir);
+		}
+		return rays;
+	}
+
+	struct Result {
+		double seconds;
+		std::vector<uint32_t> masks;
+	};
+
+	/**
+	 * run test(ray, group) for every ray and group of boxes, test returns the hit mask of the group
+	 */
+	template<typename F>
+	Result run(const std::vector<SlabRay> &rays, int group_count, F &&test) {
+		Result result;
+		result.masks.resize(rays.size() * group_count);
+		result.seconds = timeSeconds([&] {
+			for (size_t r = 0; r < rays.size(); r++) {
+				for (int g = 0; g < group_count; g++) {
+					result.masks[r * group_count + g] = test(rays[r], g);
+				}
+			}
+		});
+		return result;
+	}
+
+	/**
+	 * boxes whose hit bit differs from the reference, masks hold one bit per box of a group
+	 */
+	int countMismatches(const Result &result, int group_size, const Result &reference) {
+		int mismatches = 0;
+		for (size_t i = 0; i < result.masks.size(); i++) {
+			for (int b = 0; b < group_size; b++) {
+				size_t box = i * group_size + b;
+				mismatches += ((result.masks[i] >> b) & 1u) != reference.masks[box];
+			}
+		}
+		return mismatches;
+	}
+} // namespace
+
+void rayBoxBench() {
+	const float extent = 50;
+	const float t_max = INF;
+	auto boxes = makeBoxes(extent);
+	auto rays = makeRays(boxes, extent);
+	std::vector<SlabRay> slab_rays;
+	for (const auto &ray: rays) {
+		slab_rays.emplace_back(ray);
+	}
+
+	auto aabb = run(slab_rays, box_count, [&](const SlabRay &, int) { return 0u; });
+	aabb.seconds = timeSeconds([&] {
+		for (size_t r = 0; r < rays.size(); r++) {
+			for (int b = 0; b < box_count; b++) {
+				aabb.masks[r * box_count + b] = boxes.aabbs[b].hit(rays[r], Interval(EPS, t_max));
+			}
+		}
+	});
+	auto min_max = run(slab_rays, box_count,
+					   [&](const SlabRay &r, int b) { return minMaxSlab(r, boxes.aos[b].data(), EPS, t_max); });
+	auto scalar = run(slab_rays, box_count,
+					  [&](const SlabRay &r, int b) { return rayBoxScalar(r, boxes.aos[b].data(), EPS, t_max); });
+	auto sse = run(slab_rays, box_count,
+				   [&](const SlabRay &r, int b) { return rayBoxSse(r, boxes.aos[b].data(), EPS, t_max); });
+	auto two = run(slab_rays, box_count / 2, [&](const SlabRay &r, int g) {
+		return rayBox2(r, boxes.aos[2 * g].data(), boxes.aos[2 * g + 1].data(), EPS, t_max);
+	});
+	float near[8];
+	auto four = run(slab_rays, box_count / 4, [&](const SlabRay &r, int g) {
+		const auto &group = boxes.groups4[g];
+		return rayBox4(r, group.bounds_min, group.bounds_max, EPS, t_max, near);
+	});
+	auto eight = run(slab_rays, box_count / 8, [&](const SlabRay &r, int g) {
+		const auto &group = boxes.groups8[g];
+		return rayBox8(r, group.bounds_min, group.bounds_max, EPS, t_max, near);
+	});
+
+	auto report = [&](const char *name, const Result &result, int group_size) {
+		auto tests = static_cast<double>(rays.size()) * box_count;
+		spdlog::info("  {:<28} {:7.1f} Mbox/s, {:.2f}x, {} boxes differ from scalar", name,
+					 tests / result.seconds / 1e6, aabb.seconds / result.seconds,
+					 countMismatches(result, group_size, scalar));
+	};
+	spdlog::info("{} rays against {} boxes, speedup against AABB::hit", rays.size(), box_count);
+	report("AABB::hit, double", aabb, 1);
+	report("min/max slab (old node test)", min_max, 1);
+	report("rayBoxScalar", scalar, 1);
+	report("rayBoxSse", sse, 1);
+	report("rayBox2, AVX", two, 2);
+	report("rayBox4, SoA", four, 4);
+	report("rayBox8, SoA", eight, 8);
+}
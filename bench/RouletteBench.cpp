@@ -0,0 +1,89 @@
+/**
+ * @file RouletteBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief path length, time and noise with and without russian roulette
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "Framebuffer.h"
+#include "benches.h"
+
+namespace {
+	constexpr int reference_factor = 16;
+
+	double rmse(const Framebuffer &image, const Framebuffer &reference) {
+		double squared_error = 0;
+		for (int y = 0; y < image.height(); y++) {
+			for (int x = 0; x < image.width(); x++) {
+				squared_error += (image.getColor(x, y) - reference.getColor(x, y)).squaredNorm();
+			}
+		}
+		return std::sqrt(squared_error / (3.0 * image.width() * image.height()));
+	}
+
+	struct Run {
+		double seconds;
+		double error;
+		double path_length;
+	};
+
+	Run run(Camera &camera, const IHittable &world, const Framebuffer &reference, int min_depth) {
+		Framebuffer image(camera.getWidth(), camera.getHeight(), FB_SAMPLE_COUNT);
+		camera.setRouletteMinDepth(min_depth);
+		auto seconds = timeSeconds([&] { camera.renderTo(world, image); });
+		return Run{seconds, rmse(image, reference), camera.getAveragePathLength()};
+	}
+
+	void compare(const std::string &name, const IHittable &world, Camera &camera, int samples) {
+		auto level = spdlog::get_level();
+		spdlog::set_level(spdlog::level::warn);
+		// roulette keeps the image unbiased, so the reference may use it too. another frame keeps its
+		// random numbers apart from the runs it is compared to
+		Framebuffer reference(camera.getWidth(), camera.getHeight(), FB_SAMPLE_COUNT);
+		camera.setFrame(1);
+		camera.setSampleCount(samples * reference_factor);
+		camera.setRouletteMinDepth(5);
+		camera.renderTo(world, reference);
+		camera.setFrame(0);
+		camera.setSampleCount(samples);
+		auto off = run(camera, world, reference, camera.getRenderDepth());
+		std::vector<std::pair<int, Run>> on;
+		for (int min_depth: {1, 3, 5}) {
+			on.emplace_back(min_depth, run(camera, world, reference, min_depth));
+		}
+		spdlog::set_level(level);
+
+		spdlog::info("{}: {}x{}, {} spp, depth {}, reference {} spp", name, camera.getWidth(), camera.getHeight(),
+					 samples, camera.getRenderDepth(), samples * reference_factor);
+		spdlog::info("  no roulette:         {:6.3f}s, {:5.2f} rays per path, rmse {:.4f}", off.seconds,
+					 off.path_length, off.error);
+		for (const auto &[min_depth, r]: on) {
+			// time times variance is the cost of reaching a given noise level
+			auto speedup = off.seconds * off.error * off.error / (r.seconds * r.error * r.error);
+			spdlog::info("  roulette from {}:     {:6.3f}s, {:5.2f} rays per path, rmse {:.4f}, {:.2f}x at equal noise",
+						 min_depth, r.seconds, r.path_length, r.error, speedup);
+		}
+	}
+} // namespace
+
+void rouletteBench() {
+	{
+		auto world = makeRandomSpheresWorld();
+		Camera camera(160, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
+		camera.setRenderDepth(50);
+		camera.setChunkDimension(16);
+		camera.setBackground(Color{0.7, 0.8, 1});
+		compare("randomSpheres", world, camera, 64);
+	}
+	{
+		auto world = makeCornellBoxWorld();
+		Camera camera(96, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
+		camera.setRenderDepth(50);
+		camera.setChunkDimension(16);
+		camera.setBackground(Color{0, 0, 0});
+		compare("cornellBox", world, camera, 256);
+	}
+}
@@ -0,0 +1,139 @@
+/**
+ * @file SceneBench.cpp
+ * @author ayano
+ * @date 10/18/26
+ * @brief every still scene of scenes.cpp at a fixed seed, resolution and sample count, timed stage by stage
+ * and written to scenes.json in the output directory so runs of different versions can be compared
+ */
+
+#include <fstream>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include "BenchUtil.h"
+#include "Material.h"
+#include "benches.h"
+#include "scenes.h"
+
+namespace {
+	constexpr int image_width = 480;
+	constexpr int sample_count = 16;
+
+	/**
+	 * VmHWM of this process in bytes, 0 if /proc is not there
+	 */
+	uint64_t peakResidentBytes() {
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line)) {
+			if (line.starts_with("VmHWM:")) {
+				return std::stoull(line.substr(6)) * 1024;
+			}
+		}
+		return 0;
+	}
+
+	/**
+	 * start VmHWM over from the current resident size, so every scene gets its own high-water mark.
+	 * kernels before 4.0 ignore this and the mark keeps growing over the whole suite
+	 */
+	void resetPeakResident() {
+		std::ofstream clear_refs("/proc/self/clear_refs");
+		clear_refs << "5";
+	}
+
+	struct SceneResult {
+		std::string name;
+		int width;
+		int height;
+		int depth;
+		double setup_seconds;
+		double bvh_seconds;
+		double write_seconds;
+		RenderStats stats;
+		uint64_t peak_bytes;
+
+		double raysPerSecond(uint64_t rays) const { return stats.seconds > 0 ? rays / stats.seconds : 0; }
+	};
+
+	std::string toJson(const std::vector<SceneResult> &results, int threads) {
+		std::string json = "{\n";
+		json += fmt::format("  \"precision\": \"{}\",\n", sizeof(Real) == sizeof(float) ? "float" : "double");
+		json += fmt::format("  \"threads\": {},\n", threads);
+		json += fmt::format("  \"samples_per_pixel\": {},\n", sample_count);
+		json += "  \"scenes\": [\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			const auto &r = results[i];
+			json += fmt::format("    {{\"name\": \"{}\", \"width\": {}, \"height\": {}, \"depth\": {}, ", r.name,
+								r.width, r.height, r.depth);
+			json += fmt::format("\"setup_seconds\": {:.6f}, \"bvh_seconds\": {:.6f}, \"render_seconds\": {:.6f}, "
+								"\"write_seconds\": {:.6f}, ",
+								r.setup_seconds, r.bvh_seconds, r.stats.seconds, r.write_seconds);
+			json += fmt::format("\"primary_rays\": {}, \"secondary_rays\": {}, \"shadow_rays\": {}, ",
+								r.stats.primary_rays, r.stats.secondary_rays, r.stats.shadow_rays);
+			json += fmt::format("\"primary_rays_per_second\": {:.0f}, \"secondary_rays_per_second\": {:.0f}, "
+								"\"rays_per_second\": {:.0f}, ",
+								r.raysPerSecond(r.stats.primary_rays), r.raysPerSecond(r.stats.secondary_rays),
+								r.raysPerSecond(r.stats.primary_rays + r.stats.secondary_rays + r.stats.shadow_rays));
+			json += fmt::format("\"peak_resident_bytes\": {}}}{}\n", r.peak_bytes, i + 1 < results.size() ? "," : "");
+		}
+		json += "  ]\n}\n";
+		return json;
+	}
+} // namespace
+
+void sceneBench() {
+	const int threads = std::thread::hardware_concurrency() == 0 ? 12 : std::thread::hardware_concurrency();
+	std::vector<SceneResult> results;
+	for (const auto &[name, make]: sceneSuite()) {
+		resetPeakResident();
+		SceneResult result;
+		result.name = name;
+		// the random scenes draw from the generator of this thread, render samples seed their own streams
+		threadRng() = Pcg32();
+		std::optional<Scene> scene;
+		result.setup_seconds = timeSeconds([&] { scene = make(); });
+		result.bvh_seconds = timeSeconds([&] { buildSceneBVH(*scene); });
+		auto &camera = scene->camera;
+		camera.setWidth(image_width);
+		camera.setSampleCount(sample_count);
+		camera.setRenderThreadCount(threads);
+		camera.setProgressivePassSamples(0);
+		camera.setCheckpointPath("");
+		result.width = camera.getWidth();
+		result.height = camera.getHeight();
+		result.depth = camera.getRenderDepth();
+
+		Framebuffer image(camera.getWidth(), camera.getHeight(), FB_SAMPLE_COUNT);
+		camera.renderTo(scene->world, image);
+		result.stats = camera.getRenderStats();
+		result.write_seconds = timeSeconds([&] {
+			auto filepath = mkdir(IMG_OUTPUT_DIR, "bench_" + scene->file);
+			auto writer = makeImageWriter(scene->file);
+			if (!writer->begin(filepath, camera.getWidth(), camera.getHeight())) {
+				spdlog::error("failed to write {}", filepath);
+				return;
+			}
+			writer->writeRows(image, 0, camera.getHeight());
+			writer->finish();
+		});
+		result.peak_bytes = peakResidentBytes();
+		results.push_back(result);
+		// drop the materials and textures of this scene before the next one is measured
+		scene.reset();
+		MaterialRegistry::instance().clear();
+	}
+
+	spdlog::info("{} pixels wide, {} samples per pixel, {} threads", image_width, sample_count, threads);
+	spdlog::info("  {:<22} {:>8} {:>8} {:>8} {:>8} {:>10} {:>10} {:>10} {:>8}", "scene", "setup s", "bvh s",
+				 "render s", "write s", "primary/s", "second./s", "shadow/s", "peak MB");
+	for (const auto &r: results) {
+		spdlog::info("  {:<22} {:8.3f} {:8.4f} {:8.3f} {:8.3f} {:9.2f}M {:9.2f}M {:9.2f}M {:8.1f}", r.name,
+					 r.setup_seconds, r.bvh_seconds, r.stats.seconds, r.write_seconds,
+					 r.raysPerSecond(r.stats.primary_rays) / 1e6, r.raysPerSecond(r.stats.secondary_rays) / 1e6,
+					 r.raysPerSecond(r.stats.shadow_rays) / 1e6, r.peak_bytes / 1e6);
+	}
+	auto path = mkdir(IMG_OUTPUT_DIR, "scenes.json");
+	std::ofstream(path) << toJson(results, threads);
+	spdlog::info("results written to {}", path);
+}
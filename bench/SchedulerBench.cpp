@@ -0,0 +1,179 @@
+/**
+ * @file SchedulerBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief work stealing tile scheduler against the KawaiiMQ task/result queues it replaced
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Framebuffer.h"
+#include "ImageUtil.h"
+#include "KawaiiMQ/kawaiiMQ.h"
+#include "TileScheduler.h"
+#include "benches.h"
+
+namespace {
+	struct QueuedChunk : public KawaiiMQ::MessageData {
+		ImageChunk chunk;
+		std::vector<std::vector<Color>> partial;
+	};
+
+	struct DispatchResult {
+		double seconds;
+		// time between the first and the last worker running out of tiles
+		double tail;
+	};
+
+	/**
+	 * synthetic per pixel work, a hot spot in one corner costs far more than the rest of the frame
+	 */
+	Color shade(int x, int y, int width, int height, int cost) {
+		float dx = static_cast<float>(x) / width - 0.8f;
+		float dy = static_cast<float>(y) / height - 0.2f;
+		int iterations = static_cast<int>(cost * (1 + 30 * std::exp(-(dx * dx + dy * dy) * 40)));
+		float acc = 0;
+		for (int i = 0; i < iterations; i++) {
+			acc += std::sin(acc + static_cast<float>(i));
+		}
+		return Color{acc, 0, 0};
+	}
+
+	class FinishClock {
+	public:
+		void finished() {
+			auto now = std::chrono::steady_clock::now();
+			std::lock_guard lock(mutex);
+			first = std::min(first, now);
+			last = std::max(last, now);
+		}
+
+		double tail() const { return std::chrono::duration<double>(last - first).count(); }
+
+	private:
+		std::mutex mutex;
+		std::chrono::steady_clock::time_point first = std::chrono::steady_clock::time_point::max();
+		std::chrono::steady_clock::time_point last = std::chrono::steady_clock::time_point::min();
+	};
+
+	/**
+	 * the dispatch path Camera::Render used before the tile scheduler: chunks go out as messages,
+	 * rows come back as heap allocated vectors and are copied into the image after every thread joined
+	 */
+	DispatchResult queueDispatch(int width, int height, int tile, int workers, int cost) {
+		std::vector<std::vector<Color>> image(height, std::vector<Color>(width));
+		FinishClock clock;
+		auto seconds = timeSeconds([&] {
+			auto m = KawaiiMQ::MessageQueueManager::Instance();
+			auto task_queue = KawaiiMQ::makeQueue("benchTaskQueue");
+			auto task_topic = KawaiiMQ::Topic("benchTask");
+			auto result_queue = KawaiiMQ::makeQueue("benchResult");
+			auto result_topic = KawaiiMQ::Topic("benchRenderResult");
+			m->relate(task_topic, task_queue);
+			m->relate(result_topic, result_queue);
+			KawaiiMQ::Producer prod("benchChunkPusher");
+			prod.subscribe(task_topic);
+			int idx = 0;
+			for (int y = 0; y < height; y += tile) {
+				for (int x = 0; x < width; x += tile) {
+					QueuedChunk message;
+					message.chunk = ImageChunk{x, y, idx++, std::min(tile, width - x), std::min(tile, height - y)};
+					prod.broadcastMessage(KawaiiMQ::makeMessage(message));
+				}
+			}
+			prod.unsubscribe(task_topic);
+
+			std::vector<std::thread> threads;
+			for (int w = 0; w < workers; w++) {
+				threads.emplace_back([&] {
+					auto result_producer = KawaiiMQ::Producer("benchProducer");
+					result_producer.subscribe(result_topic);
+					auto chunk_message = std::shared_ptr<KawaiiMQ::MessageData>();
+					while (task_queue->tryWait(chunk_message)) {
+						auto message = KawaiiMQ::getMessage<QueuedChunk>(chunk_message);
+						const auto &chunk = message.chunk;
+						for (int i = chunk.starty; i < chunk.starty + chunk.height; i++) {
+							auto hori = std::vector<Color>();
+							hori.reserve(chunk.width);
+							for (int j = chunk.startx; j < chunk.startx + chunk.width; j++) {
+								hori.emplace_back(shade(j, i, width, height, cost));
+							}
+							message.partial.emplace_back(hori);
+						}
+						result_producer.broadcastMessage(KawaiiMQ::makeMessage(message));
+					}
+					result_producer.unsubscribe(result_topic);
+					clock.finished();
+				});
+			}
+			for (auto &t: threads) {
+				t.join();
+			}
+			auto consumer = KawaiiMQ::Consumer("benchResultConsumer");
+			consumer.subscribe(result_topic);
+			while (!result_queue->empty()) {
+				auto message = KawaiiMQ::getMessage<QueuedChunk>(consumer.fetchSingleTopic(result_topic)[0]);
+				const auto &chunk = message.chunk;
+				for (int i = chunk.starty; i < chunk.starty + chunk.height; i++) {
+					for (int j = chunk.startx; j < chunk.startx + chunk.width; j++) {
+						image[i][j] = message.partial[i - chunk.starty][j - chunk.startx];
+					}
+				}
+			}
+			m->unrelate(task_topic, task_queue);
+			m->unrelate(result_topic, result_queue);
+		});
+		return {seconds, clock.tail()};
+	}
+
+	DispatchResult stealingDispatch(int width, int height, int tile, int workers, int cost, uint64_t &steals) {
+		Framebuffer image(width, height);
+		FinishClock clock;
+		auto seconds = timeSeconds([&] {
+			TileScheduler scheduler(width, height, tile, workers);
+			std::vector<std::thread> threads;
+			for (int w = 0; w < workers; w++) {
+				threads.emplace_back([&, w] {
+					ImageChunk chunk;
+					while (scheduler.next(w, chunk)) {
+						auto view = image.tile(chunk);
+						for (int i = 0; i < chunk.height; i++) {
+							for (int j = 0; j < chunk.width; j++) {
+								view.setColor(j, i, shade(chunk.startx + j, chunk.starty + i, width, height, cost));
+							}
+						}
+					}
+					clock.finished();
+				});
+			}
+			for (auto &t: threads) {
+				t.join();
+			}
+			steals = scheduler.stealCount();
+		});
+		return {seconds, clock.tail()};
+	}
+} // namespace
+
+void schedulerBench() {
+	auto hardware = std::thread::hardware_concurrency();
+	int workers = hardware == 0 ? 12 : static_cast<int>(hardware);
+	const int width = 1920, height = 1080;
+	// cost 0 measures pure dispatch overhead, the others an uneven frame
+	for (int cost: {0, 8, 32}) {
+		for (int tile: {16, 64}) {
+			uint64_t steals = 0;
+			auto queue = queueDispatch(width, height, tile, workers, cost);
+			auto stealing = stealingDispatch(width, height, tile, workers, cost, steals);
+			spdlog::info("{}x{} frame, {}px tiles, work {}, {} threads", width, height, tile, cost, workers);
+			spdlog::info("  kawaiimq queues:  {:.3f}s, tail {:.3f}s", queue.seconds, queue.tail);
+			spdlog::info("  work stealing:    {:.3f}s, tail {:.3f}s, {} steals", stealing.seconds, stealing.tail,
+						 steals);
+		}
+	}
+}
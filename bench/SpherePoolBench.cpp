@@ -0,0 +1,55 @@
+/**
+ * @file SpherePoolBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief randomSpheres with separate Sphere objects against one SpherePool
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "benches.h"
+
+void spherePoolBench() {
+	auto object_world = makeRandomSpheresWorld(false);
+	auto pool_world = makeRandomSpheresWorld(true);
+	const IHittable &objects = object_world;
+	const IHittable &pooled = pool_world;
+
+	Camera camera(480, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
+	camera.setSampleCount(16);
+	camera.setRenderDepth(50);
+	camera.setChunkDimension(32);
+	camera.setBackground(Color{0.7, 0.8, 1});
+
+	// secondary rays are what the spheres mostly see, so shoot rays from random points of the scene too
+	auto rays = makeIncomingRays(200000, 12);
+	for (int i = 0; i < 200000; i++) {
+		Point3 origin = randomVec3(-12, 12);
+		origin.y() = randomFloat(0.05, 2);
+		rays.emplace_back(origin, randomUnitVec3());
+	}
+	int object_hits = 0, pool_hits = 0;
+	auto object_rays = timeSeconds([&] {
+		HitRecord record;
+		for (const auto &ray: rays) {
+			object_hits += objects.hit(ray, Interval(EPS, INF), record);
+		}
+	});
+	auto pool_rays = timeSeconds([&] {
+		HitRecord record;
+		for (const auto &ray: rays) {
+			pool_hits += pooled.hit(ray, Interval(EPS, INF), record);
+		}
+	});
+	auto object_render = timeSeconds([&] { camera.Render(objects, "spheres_objects.ppm", IMG_OUTPUT_DIR); });
+	auto pool_render = timeSeconds([&] { camera.Render(pooled, "spheres_pool.ppm", IMG_OUTPUT_DIR); });
+
+	auto mrays = static_cast<double>(rays.size()) / 1e6;
+	spdlog::info("randomSpheres: {} rays, render {}x{} at {} spp", rays.size(), camera.getWidth(), camera.getHeight(),
+				 camera.getSampleCount());
+	spdlog::info("  sphere objects: {:.2f} Mray/s, {} hits, render {:.3f}s", mrays / object_rays, object_hits,
+				 object_render);
+	spdlog::info("  sphere pool:    {:.2f} Mray/s, {} hits, render {:.3f}s, {:.2f}x / {:.2f}x", mrays / pool_rays,
+				 pool_hits, pool_render, object_rays / pool_rays, object_render / pool_render);
+}
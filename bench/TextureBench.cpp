@@ -0,0 +1,116 @@
+/**
+ * @file TextureBench.cpp
+ * @author ayano
+ * @date 10/18/26
+ * @brief texture lookups per second through TextureCache against the old nearest lookup into the stb buffer
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "TextureCache.h"
+#include "benches.h"
+
+namespace {
+	constexpr int image_size = 2048;
+	constexpr int lookup_count = 1 << 20;
+
+	/**
+	 * smooth color ramps with a fine checker on top, so every level of the pyramid differs
+	 */
+	std::vector<unsigned char> makeImage() {
+		std::vector<unsigned char> rgb(3 * image_size * image_size);
+		for (int y = 0; y < image_size; y++) {
+			for (int x = 0; x < image_size; x++) {
+				auto pixel = rgb.data() + 3 * (y * image_size + x);
+				int checker = ((x >> 2) + (y >> 2)) % 2 ? 40 : 0;
+				pixel[0] = static_cast<unsigned char>(x * 200 / image_size + checker);
+				pixel[1] = static_cast<unsigned char>(y * 200 / image_size + checker);
+				pixel[2] = static_cast<unsigned char>((x + y) * 100 / image_size + checker);
+			}
+		}
+		return rgb;
+	}
+
+	/**
+	 * ImageTexture::value as it was, nearest texel straight from the bytes, converted on every access
+	 */
+	Color rawNearest(const std::vector<unsigned char> &rgb, float u, float v) {
+		u = Interval(0, 1).clamp(u);
+		v = 1.0 - Interval(0, 1).clamp(v);
+		auto i = std::min(static_cast<int>(u * image_size), image_size - 1);
+		auto j = std::min(static_cast<int>(v * image_size), image_size - 1);
+		auto pixel = rgb.data() + 3 * (j * image_size + i);
+		float color_scale = 1.0 / 255.0;
+		return Color{color_scale * pixel[0], color_scale * pixel[1], color_scale * pixel[2]};
+	}
+
+	/**
+	 * uv of a 1024 * 1024 screen looking at the texture rotated by 30 degrees, in scanline order, and
+	 * the same points shuffled
+	 */
+	std::vector<std::pair<float, float>> makeLookups(bool coherent) {
+		std::vector<std::pair<float, float>> uvs;
+		uvs.reserve(lookup_count);
+		float c = std::cos(0.5236f), s = std::sin(0.5236f);
+		for (int i = 0; i < lookup_count; i++) {
+			float x = (i % 1024) / 1024.0f - 0.5f, y = (i / 1024) / 1024.0f - 0.5f;
+			uvs.emplace_back(0.5f + 0.7f * (c * x - s * y), 0.5f + 0.7f * (s * x + c * y));
+		}
+		if (!coherent) {
+			for (int i = lookup_count - 1; i > 0; i--) {
+				std::swap(uvs[i], uvs[randomInt(0, i)]);
+			}
+		}
+		return uvs;
+	}
+
+	template<typename F>
+	double run(const std::vector<std::pair<float, float>> &uvs, Color &sum, F &&lookup) {
+		sum = Color::Zero();
+		return timeSeconds([&] {
+			for (const auto &[u, v]: uvs) {
+				sum += lookup(u, v);
+			}
+		});
+	}
+} // namespace
+
+void textureBench() {
+	threadRng() = Pcg32();
+	auto rgb = makeImage();
+	auto &cache = TextureCache::instance();
+	uint32_t id;
+	auto build = timeSeconds([&] { id = cache.add(rgb.data(), image_size, image_size); });
+	spdlog::info("{} * {} texture, pyramid built and written in {:.3f}s", image_size, image_size, build);
+	// a screen texel covers about 1.4 texels of level 0
+	const float width = 0.7f / 1024;
+
+	for (bool coherent: {true, false}) {
+		auto uvs = makeLookups(coherent);
+		spdlog::info("{} lookups, {} order", uvs.size(), coherent ? "scanline" : "random");
+		Color sum;
+		auto raw = run(uvs, sum, [&](float u, float v) { return rawNearest(rgb, u, v); });
+		spdlog::info("  {:<26} {:6.2f} M lookups/s, mean {:.4f}", "old nearest, stb buffer",
+					 lookup_count / raw / 1e6, sum.mean() / lookup_count);
+		auto report = [&](const char *name, size_t budget, auto &&lookup) {
+			cache.setBudget(budget);
+			cache.clear();
+			auto cold = run(uvs, sum, lookup);
+			auto misses = cache.stats().misses;
+			auto warm = run(uvs, sum, lookup);
+			auto stats = cache.stats();
+			spdlog::info("  {:<26} cold {:5.2f}, warm {:5.2f} M lookups/s, {:.2f}x, mean {:.4f}, {} + {} misses, "
+						 "{:.2f} MB resident",
+						 name, lookup_count / cold / 1e6, lookup_count / warm / 1e6, raw / warm,
+						 sum.mean() / lookup_count, misses, stats.misses - misses, stats.resident_bytes / 1e6);
+		};
+		size_t all = 256ull << 20, small = 1ull << 20;
+		report("nearest, whole pyramid", all, [&](float u, float v) { return cache.nearest(id, 0, u, v); });
+		report("bilinear, whole pyramid", all, [&](float u, float v) { return cache.bilinear(id, 0, u, v); });
+		report("trilinear, whole pyramid", all, [&](float u, float v) { return cache.trilinear(id, u, v, width); });
+		report("bilinear, 1 MB budget", small, [&](float u, float v) { return cache.bilinear(id, 0, u, v); });
+		report("trilinear, 1 MB budget", small, [&](float u, float v) { return cache.trilinear(id, u, v, width); });
+	}
+	cache.setBudget(256ull << 20);
+	cache.clear();
+}
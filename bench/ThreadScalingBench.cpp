@@ -0,0 +1,36 @@
+/**
+ * @file ThreadScalingBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief render time from one worker thread up to every hardware thread
+ */
+
+#include <algorithm>
+#include <thread>
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "benches.h"
+
+void threadScalingBench() {
+	auto world = makeRandomSpheresWorld();
+	Camera camera(480, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
+	camera.setSampleCount(16);
+	camera.setRenderDepth(50);
+	camera.setChunkDimension(16);
+	camera.setBackground(Color{0.7, 0.8, 1});
+	const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+	spdlog::info("randomSpheres: {}x{}, {} spp, up to {} threads", camera.getWidth(), camera.getHeight(),
+				 camera.getSampleCount(), max_threads);
+	double single = 0;
+	for (int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+		camera.setRenderThreadCount(threads);
+		auto seconds = timeSeconds([&] { camera.Render(world, "threads.ppm", IMG_OUTPUT_DIR); });
+		if (threads == 1)
+			single = seconds;
+		spdlog::info("  {} threads: {:.3f}s, {:.2f}x, {:.0f}% efficiency", threads, seconds, single / seconds,
+					 100.0 * single / seconds / threads);
+		if (threads == max_threads)
+			break;
+	}
+}
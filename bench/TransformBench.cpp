@@ -0,0 +1,109 @@
+/**
+ * @file TransformBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief rotated boxes through Transform against the old homogeneous Rotation and unrotated boxes
+ */
+
+#include <spdlog/spdlog.h>
+#include "BVH.h"
+#include "BenchUtil.h"
+#include "benches.h"
+
+namespace {
+	/**
+	 * Rotation as it was before Transform replaced it, kept here as the baseline. it inverts a 4x4
+	 * matrix on every hit. its bounds are taken from Transform, the old ones only covered two corners
+	 */
+	class HomogeneousRotation : public IHittable {
+	public:
+		HomogeneousRotation(std::shared_ptr<IHittable> obj, float psi, float theta, float phi, Point3 about_pt) :
+			object(obj), rotation_matrix(makeEulerRotationMatrixAboutPt(about_pt, psi, theta, phi)),
+			inverse_rotation_matrix(makeEulerRotationMatrixAboutPt(about_pt, -psi, -theta, -phi)),
+			bbox(Rotation(obj, psi, theta, phi, about_pt).boundingBox()) {}
+
+		AABB boundingBox() const override { return bbox; }
+
+		bool hit(const Ray &r, Interval interval, HitRecord &record) const override {
+			Ray rotated(deHomo(rotation_matrix * makeHomo(r.pos())), deHomo(rotation_matrix * makeHomo(r.dir())),
+						r.time());
+			if (!object->hit(rotated, interval, record)) {
+				return false;
+			}
+			auto inverse_transpose = Mat4(inverse_rotation_matrix.inverse().transpose());
+			record.normal = deHomo(inverse_transpose * makeHomo(record.normal));
+			record.p = deHomo(inverse_rotation_matrix * makeHomo(record.p));
+			return true;
+		}
+
+	private:
+		std::shared_ptr<IHittable> object;
+		Mat4 rotation_matrix, inverse_rotation_matrix;
+		AABB bbox;
+	};
+
+	enum class Placement { Plain, Homogeneous, Transformed };
+
+	/**
+	 * a grid of boxes, each rotated about y by its own angle unless plain
+	 */
+	HittableList makeBoxGrid(Placement placement) {
+		threadRng() = Pcg32();
+		HittableList world;
+		auto mat = std::make_shared<Lambertian>(Color{0.73, 0.73, 0.73});
+		for (int i = 0; i < 20; i++) {
+			for (int j = 0; j < 20; j++) {
+				auto angle = randomFloat(-PI, PI);
+				Point3 corner{static_cast<Real>(i * 3), 0, static_cast<Real>(j * 3)};
+				std::shared_ptr<IHittable> object = box(corner, corner + Point3{1.5, randomFloat(1, 3), 1.5}, mat);
+				Point3 center = corner + Point3{0.75, 0, 0.75};
+				if (placement == Placement::Homogeneous) {
+					object = std::make_shared<HomogeneousRotation>(object, 0, angle, 0, center);
+				} else if (placement == Placement::Transformed) {
+					object = std::make_shared<Rotation>(object, 0, angle, 0, center);
+				}
+				world.add(object);
+			}
+		}
+		return HittableList(std::make_shared<BVHNode>(world));
+	}
+} // namespace
+
+void transformBench() {
+	auto plain_world = makeBoxGrid(Placement::Plain);
+	auto homogeneous_world = makeBoxGrid(Placement::Homogeneous);
+	auto transformed_world = makeBoxGrid(Placement::Transformed);
+	const IHittable &plain = plain_world;
+	const IHittable &homogeneous = homogeneous_world;
+	const IHittable &transformed = transformed_world;
+
+	std::vector<Ray> rays;
+	for (int i = 0; i < 200000; i++) {
+		Point3 origin{randomFloat(-10, 70), randomFloat(1, 20), randomFloat(-10, 70)};
+		Point3 target{randomFloat(0, 60), randomFloat(0, 3), randomFloat(0, 60)};
+		rays.emplace_back(origin, target - origin);
+	}
+	auto trace = [&](const IHittable &world, std::vector<float> &distances) {
+		return timeSeconds([&] {
+			HitRecord record;
+			for (size_t i = 0; i < rays.size(); i++) {
+				distances[i] = world.hit(rays[i], Interval(EPS, INF), record) ? record.t : INF;
+			}
+		});
+	};
+	std::vector<float> plain_t(rays.size()), homogeneous_t(rays.size()), transformed_t(rays.size());
+	auto plain_time = trace(plain, plain_t);
+	auto homogeneous_time = trace(homogeneous, homogeneous_t);
+	auto transformed_time = trace(transformed, transformed_t);
+	int mismatches = 0;
+	for (size_t i = 0; i < rays.size(); i++) {
+		mismatches += std::abs(homogeneous_t[i] - transformed_t[i]) > 1e-3f * std::max(1.0f, homogeneous_t[i]);
+	}
+
+	auto mrays = static_cast<double>(rays.size()) / 1e6;
+	spdlog::info("400 boxes, {} rays, the two rotations disagree on {} rays", rays.size(), mismatches);
+	spdlog::info("  unrotated:            {:.2f} Mray/s", mrays / plain_time);
+	spdlog::info("  homogeneous rotation: {:.2f} Mray/s", mrays / homogeneous_time);
+	spdlog::info("  transform:            {:.2f} Mray/s, {:.2f}x", mrays / transformed_time,
+				 homogeneous_time / transformed_time);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file WavefrontBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief full renders with the recursive and the wavefront integrator
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "Camera.h"
+#include "benches.h"
+
+namespace {
+	void compare(const std::string &name, const IHittable &world, Camera &camera) {
+		camera.setIntegrator(INTEGRATOR_RECURSIVE);
+		auto recursive = timeSeconds([&] { camera.Render(world, name + "_recursive.ppm", IMG_OUTPUT_DIR); });
+		camera.setIntegrator(INTEGRATOR_WAVEFRONT);
+		auto wavefront = timeSeconds([&] { camera.Render(world, name + "_wavefront.ppm", IMG_OUTPUT_DIR); });
+		spdlog::info("{}: {}x{}, {} spp, depth {}", name, camera.getWidth(), camera.getHeight(),
+					 camera.getSampleCount(), camera.getRenderDepth());
+		spdlog::info("  recursive: {:.3f}s", recursive);
+		spdlog::info("  wavefront: {:.3f}s, {:.2f}x", wavefront, recursive / wavefront);
+	}
+} // namespace
+
+void wavefrontBench() {
+	{
+		auto world = makeRandomSpheresWorld();
+		Camera camera(480, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
+		camera.setSampleCount(32);
+		camera.setRenderDepth(50);
+		camera.setChunkDimension(32);
+		camera.setBackground(Color{0.7, 0.8, 1});
+		compare("randomSpheres", world, camera);
+	}
+	{
+		auto world = makeCornellBoxWorld();
+		Camera camera(480, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
+		camera.setSampleCount(64);
+		camera.setRenderDepth(8);
+		camera.setChunkDimension(32);
+		camera.setBackground(Color{0, 0, 0});
+		// the wavefront integrator never samples lights, keep the work the same
+		camera.setLightSampling(false);
+		compare("cornellBox", world, camera);
+	}
+}
@@ -0,0 +1,81 @@
+/**
+ * @file WideBVHBench.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief the binary BVH against its 4 and 8 wide collapses
+ */
+
+#include <spdlog/spdlog.h>
+#include "BenchUtil.h"
+#include "WideBVH.h"
+#include "benches.h"
+
+namespace {
+	struct Trace {
+		double seconds;
+		std::vector<float> t;
+		int hits = 0;
+	};
+
+	Trace trace(const IHittable &world, const std::vector<Ray> &rays) {
+		Trace result;
+		result.t.resize(rays.size());
+		result.seconds = timeSeconds([&] {
+			HitRecord record;
+			for (size_t i = 0; i < rays.size(); i++) {
+				bool hit = world.hit(rays[i], Interval(EPS, INF), record);
+				result.hits += hit;
+				result.t[i] = hit ? record.t : INF;
+			}
+		});
+		return result;
+	}
+
+	int countMismatches(const Trace &a, const Trace &b) {
+		int mismatches = 0;
+		for (size_t i = 0; i < a.t.size(); i++) {
+			mismatches += a.t[i] != b.t[i];
+		}
+		return mismatches;
+	}
+
+	void compare(const char *label, const HittableList &world, const std::vector<Ray> &rays) {
+		std::shared_ptr<BVHNode> binary;
+		std::shared_ptr<BVH4> bvh4;
+		std::shared_ptr<BVH8> bvh8;
+		auto binary_build = timeSeconds([&] { binary = std::make_shared<BVHNode>(world); });
+		auto bvh4_build = timeSeconds([&] { bvh4 = std::make_shared<BVH4>(world); });
+		auto bvh8_build = timeSeconds([&] { bvh8 = std::make_shared<BVH8>(world); });
+		auto binary_trace = trace(*binary, rays);
+		auto bvh4_trace = trace(*bvh4, rays);
+		auto bvh8_trace = trace(*bvh8, rays);
+
+		auto mrays = static_cast<double>(rays.size()) / 1e6;
+		auto report = [&](const char *name, double build, size_t node_count, size_t node_size, const Trace &result) {
+			spdlog::info("  {:<7} build {:.3f}s, {:7} nodes, {:6.2f} MB, {:.2f} Mray/s, {:.2f}x, {} hits, {} differ",
+						 name, build, node_count, node_count * node_size / 1e6, mrays / result.seconds,
+						 binary_trace.seconds / result.seconds, result.hits, countMismatches(result, binary_trace));
+		};
+		spdlog::info("{}: {} primitives, {} rays", label, world.objects.size(), rays.size());
+		report("binary", binary_build, binary->getNodes().size(), sizeof(LinearBVHNode), binary_trace);
+		report("bvh4", bvh4_build, bvh4->getNodes().size(), sizeof(WideBVHNode<4>), bvh4_trace);
+		report("bvh8", bvh8_build, bvh8->getNodes().size(), sizeof(WideBVHNode<8>), bvh8_trace);
+	}
+} // namespace
+
+void wideBVHBench() {
+	threadRng() = Pcg32();
+	compare("sphere field", makeSphereField(100000, 100), makeIncomingRays(500000, 100));
+
+	// 2 * 300 * 600 = 360k triangles
+	auto sphere = makeSphereMesh(300, 600, 2);
+	auto mat = std::make_shared<Lambertian>(Color{0.5, 0.5, 0.5});
+	HittableList triangles;
+	for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+		Point3 a = sphere.positions[sphere.indices[i]].cast<Real>();
+		Point3 b = sphere.positions[sphere.indices[i + 1]].cast<Real>();
+		Point3 c = sphere.positions[sphere.indices[i + 2]].cast<Real>();
+		triangles.add(std::make_shared<Triangle>(a, b - a, c - a, mat));
+	}
+	compare("sphere of triangles", triangles, makeIncomingRays(500000, 2));
+}
@@ -0,0 +1,51 @@
+/**
+ * @file benches.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#ifndef RAYTRACING_BENCHES_H
+#define RAYTRACING_BENCHES_H
+
+void bvhBench();
+
+void schedulerBench();
+
+void packetBench();
+
+void wavefrontBench();
+
+void adaptiveBench();
+
+void threadScalingBench();
+
+void spherePoolBench();
+
+void meshBench();
+
+void meshLoadBench();
+
+void instanceBench();
+
+void transformBench();
+
+void precisionBench();
+
+void rayBoxBench();
+
+void wideBVHBench();
+
+void lightSamplingBench();
+
+void rouletteBench();
+
+void materialBench();
+
+void textureBench();
+
+void noiseBench();
+
+void sceneBench();
+
+#endif // RAYTRACING_BENCHES_H
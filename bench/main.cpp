@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "benches.h"
+
+int main(int argc, char **argv) {
+	const std::vector<std::pair<std::string, void (*)()>> benches = {
+			{"bvh", bvhBench},
+			{"scheduler", schedulerBench},
+			{"packet", packetBench},
+			{"wavefront", wavefrontBench},
+			{"adaptive", adaptiveBench},
+			{"threads", threadScalingBench},
+			{"spherepool", spherePoolBench},
+			{"mesh", meshBench},
+			{"meshload", meshLoadBench},
+			{"instance", instanceBench},
+			{"transform", transformBench},
+			{"precision", precisionBench},
+			{"raybox", rayBoxBench},
+			{"widebvh", wideBVHBench},
+			{"lights", lightSamplingBench},
+			{"roulette", rouletteBench},
+			{"material", materialBench},
+			{"texture", textureBench},
+			{"noise", noiseBench},
+			{"scenes", sceneBench},
+	};
+	if (argc != 2) {
+		std::cerr << "Usage: " << argv[0] << " <bench_name|all>" << std::endl;
+		std::cerr << "available benches:";
+		for (const auto &[name, func]: benches) {
+			std::cerr << " " << name;
+		}
+		std::cerr << std::endl;
+		return 1;
+	}
+	auto selected = std::string(argv[1]);
+	bool found = false;
+	for (const auto &[name, func]: benches) {
+		if (selected == "all" || selected == name) {
+			spdlog::info("running bench {}", name);
+			func();
+			found = true;
+		}
+	}
+	if (!found) {
+		std::cerr << "unknown bench: " << selected << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file BVH.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Flattened bounding volume hierarchy
+ */
+
+#ifndef RAYTRACING_BVH_H
+#define RAYTRACING_BVH_H
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+#include "RayBox.h"
+#include "RayPacket.h"
+
+/**
+ * one node of the flattened hierarchy, exactly half a cache line.
+ * interior nodes keep their first child right after themselves in the node array, so only the
+ * offset of the second child is stored. leaves store a range into the primitive array instead.
+ */
+struct alignas(32) LinearBVHNode {
+	float bounds_min[3];
+	float bounds_max[3];
+	union {
+		uint32_t primitive_offset;
+		uint32_t second_child_offset;
+	};
+	uint16_t primitive_count;
+	uint8_t axis;
+	uint8_t pad;
+
+	void setBounds(const AABB &box);
+
+	bool isLeaf() const { return primitive_count > 0; }
+
+	[[nodiscard]] bool hit(const SlabRay &r, float t_min, float t_max) const {
+		return rayBoxSse(r, bounds_min, t_min, t_max);
+	}
+
+	/**
+	 * slab test for every lane of a packet at once, lanes failing it are cleared from the mask
+	 */
+	[[nodiscard]] uint32_t hitPacket(const RayPacket &packet, float t_min, uint32_t lanes) const;
+};
+
+static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode should stay 32 bytes");
+
+class BVHNode : public IHittable {
+public:
+	BVHNode() = default;
+
+	BVHNode(const HittableList &list);
+
+	BVHNode(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end);
+
+	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+
+	/**
+	 * traverse the hierarchy with the whole packet, subtrees reached by at most
+	 * scalar_fallback_lanes rays are finished one ray at a time
+	 */
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	AABB boundingBox() const override;
+
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	const std::vector<LinearBVHNode> &getNodes() const;
+
+	const std::vector<std::shared_ptr<IHittable>> &getPrimitives() const;
+
+	static constexpr int max_depth = 64;
+
+	static constexpr int scalar_fallback_lanes = 2;
+
+private:
+	bool traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const;
+
+	std::vector<LinearBVHNode> nodes;
+	std::vector<std::shared_ptr<IHittable>> primitives;
+	AABB bbox;
+};
+
+/**
+ * closest hit traversal of a flattened hierarchy starting at root, children are visited front to back.
+ * leaf(node, interval) tests the primitives of a leaf, lowers interval.max to the closest hit and
+ * returns whether it hit anything
+ */
+template<typename Leaf>
+bool traverseLinearBVH(const LinearBVHNode *nodes, uint32_t root, const Ray &r, Interval interval, Leaf &&leaf) {
+	const SlabRay slab_ray(r);
+
+	uint32_t stack[BVHNode::max_depth];
+	int stack_size = 0;
+	uint32_t current = root;
+	bool hit_anything = false;
+	while (true) {
+		const auto &node = nodes[current];
+		if (node.hit(slab_ray, interval.min, interval.max)) {
+			if (node.isLeaf()) {
+				hit_anything |= leaf(node, interval);
+				if (stack_size == 0)
+					break;
+				current = stack[--stack_size];
+			} else if (slab_ray.sign[node.axis]) {
+				// the second child lies further along the axis, so visit it first
+				stack[stack_size++] = current + 1;
+				current = node.second_child_offset;
+			} else {
+				stack[stack_size++] = node.second_child_offset;
+				current = current + 1;
+			}
+		} else {
+			if (stack_size == 0)
+				break;
+			current = stack[--stack_size];
+		}
+	}
+	return hit_anything;
+}
+
+/**
+ * packet version of traverseLinearBVH. leaf(node, lanes) tests the primitives of a leaf for the given
+ * lanes and returns the lanes that hit, lowering their t_max. once a subtree is reached by at most
+ * BVHNode::scalar_fallback_lanes rays, scalar(node index, lane) finishes it for each of them and
+ * returns whether the lane hit
+ */
+template<typename Scalar, typename Leaf>
+uint32_t traverseLinearBVHPacket(const LinearBVHNode *nodes, RayPacket &packet, uint32_t lanes, float t_min,
+								 Scalar &&scalar, Leaf &&leaf) {
+	if (lanes == 0) {
+		return 0;
+	}
+	// coherent rays share direction signs, so the first ray decides the child order for everyone
+	int leader = std::countr_zero(lanes);
+	const bool dir_neg[3] = {packet.inv_x[leader] < 0, packet.inv_y[leader] < 0, packet.inv_z[leader] < 0};
+
+	struct StackEntry {
+		uint32_t node;
+		uint32_t lanes;
+	};
+	StackEntry stack[BVHNode::max_depth];
+	int stack_size = 0;
+	uint32_t current = 0;
+	uint32_t hits = 0;
+	while (true) {
+		const auto &node = nodes[current];
+		lanes = node.hitPacket(packet, t_min, lanes);
+		if (lanes != 0 && std::popcount(lanes) <= BVHNode::scalar_fallback_lanes) {
+			forEachLane(lanes, [&](int lane) {
+				if (scalar(current, lane))
+					hits |= 1u << lane;
+			});
+		} else if (lanes != 0) {
+			if (node.isLeaf()) {
+				hits |= leaf(node, lanes);
+			} else if (dir_neg[node.axis]) {
+				stack[stack_size++] = {current + 1, lanes};
+				current = node.second_child_offset;
+				continue;
+			} else {
+				stack[stack_size++] = {node.second_child_offset, lanes};
+				current = current + 1;
+				continue;
+			}
+		}
+		if (stack_size == 0)
+			break;
+		--stack_size;
+		current = stack[stack_size].node;
+		lanes = stack[stack_size].lanes;
+	}
+	return hits;
+}
+
+#endif // RAYTRACING_BVH_H
@@ -0,0 +1,43 @@
+/**
+ * @file BVHBuilder.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Binned SAH builder producing flattened BVHs
+ */
+
+#ifndef RAYTRACING_BVHBUILDER_H
+#define RAYTRACING_BVHBUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BVH.h"
+#include "MathUtil.h"
+
+struct BVHBuildOptions {
+	// number of centroid bins evaluated per axis for every split
+	int bin_count = 16;
+	// a range is never turned into a leaf if it holds more primitives than this
+	int max_leaf_size = 4;
+	// ranges larger than this are built in their own task
+	size_t parallel_threshold = 4096;
+	float traversal_cost = 1.0f;
+	float intersection_cost = 1.0f;
+};
+
+struct BVHBuildResult {
+	std::vector<LinearBVHNode> nodes;
+	// primitive_order[i] is the index of the input primitive that leaves refer to as i
+	std::vector<uint32_t> primitive_order;
+};
+
+/**
+ * build a flattened hierarchy over the given primitive bounds with the surface area heuristic.
+ * primitives are partitioned in place over an index array, large subtrees are built in parallel.
+ * @param primitive_bounds bounding box of every primitive
+ * @param options build parameters
+ * @return nodes in depth first order and the primitive order the leaves index into
+ */
+BVHBuildResult buildBVH(const std::vector<AABB> &primitive_bounds, const BVHBuildOptions &options = {});
+
+#endif // RAYTRACING_BVHBUILDER_H
@@ -8,15 +8,58 @@
 #ifndef ONEWEEKEND_CAMERA_H
 #define ONEWEEKEND_CAMERA_H
 
+#include <string>
 #include <thread>
+#include <vector>
 #include "Eigen/Dense"
+#include "Framebuffer.h"
 #include "GraphicObjects.h"
 #include "ImageUtil.h"
+#include "ImageWriter.h"
+#include "LightList.h"
 #include "MathUtil.h"
+#include "TileScheduler.h"
+#include "Wavefront.h"
+
+/**
+ * how the camera follows paths through the scene
+ */
+enum RenderIntegrator : uint8_t {
+	// one sample at a time, recursing through its bounces
+	INTEGRATOR_RECURSIVE,
+	// batches of paths advanced one bounce at a time, see WavefrontIntegrator
+	INTEGRATOR_WAVEFRONT,
+};
+
+/**
+ * what adaptive sampling did with one tile
+ */
+struct TileStats {
+	int chunk_idx;
+	int pixels;
+	// pixels whose block error fell below the threshold
+	int converged;
+	uint64_t samples;
+	float max_error;
+};
+
+/**
+ * what the last pass of a render traced and how long it took, which is the whole render unless it is
+ * progressive. the wavefront integrator does not count its rays
+ */
+struct RenderStats {
+	// one per path, traced from the camera
+	uint64_t primary_rays = 0;
+	// bounces after the camera ray
+	uint64_t secondary_rays = 0;
+	// traced towards sampled lights
+	uint64_t shadow_rays = 0;
+	double seconds = 0;
+};
 
 class Camera {
 public:
-	Camera(int width, float aspect_ratio, float fov, Point3 position, Eigen::Vector3d target, float dof_angle);
+	Camera(int width, float aspect_ratio, float fov, Point3 position, Vec3 target, float dof_angle);
 
 	int getWidth() const;
 
@@ -36,13 +79,13 @@ public:
 
 	const Point3 &getPosition() const;
 
-	const Eigen::Vector3d &getHoriVec() const;
+	const Vec3 &getHoriVec() const;
 
-	const Eigen::Vector3d &getVertVec() const;
+	const Vec3 &getVertVec() const;
 
-	const Eigen::Vector3d &getPixDeltaX() const;
+	const Vec3 &getPixDeltaX() const;
 
-	const Eigen::Vector3d &getPixDeltaY() const;
+	const Vec3 &getPixDeltaY() const;
 
 	const Point3 &getViewportUl() const;
 
@@ -62,6 +105,11 @@ public:
 
 	std::string Render(const IHittable &world, const std::string &name, const std::string &path);
 
+	/**
+	 * render every sample into image without writing a file, image needs the sample count channel
+	 */
+	void renderTo(const IHittable &world, Framebuffer &image);
+
 	int getRenderDepth() const;
 
 	void setRenderDepth(int renderDepth);
@@ -88,26 +136,171 @@ public:
 
 	void setShutterSpeed(float shutterSpeed);
 
-	void setRotation(const Eigen::Vector3d &rot);
+	void setRotation(const Vec3 &rot);
 
-	Eigen::Vector3d getRotation() const;
+	Vec3 getRotation() const;
 
 	Color getBackground() const;
 
 	void setBackground(const Color &background);
 
+	int getFrame() const;
+
+	void setFrame(int frame);
+
+	bool getPacketTracing() const;
+
+	/**
+	 * trace primary rays in packets of neighbouring pixels, bounces are always traced one by one
+	 */
+	void setPacketTracing(bool enabled);
+
+	bool getLightSampling() const;
+
+	/**
+	 * sample the emissive primitives of the world directly at every diffuse bounce and weight both
+	 * ways of reaching a light with multiple importance sampling. without it lights are only found by
+	 * bounces that happen to hit them. lights behind a Transform or inside an InstanceBVH are never
+	 * sampled either, only found by bounces. the wavefront integrator never samples lights
+	 */
+	void setLightSampling(bool enabled);
+
+	int getRouletteMinDepth() const;
+
+	/**
+	 * bounces every path takes before russian roulette may end it. after that a path survives each
+	 * bounce with the probability of the largest channel of its throughput and the survivors are scaled
+	 * up by its inverse, so dim paths stop early without biasing the image. render_depth or more turns
+	 * roulette off
+	 */
+	void setRouletteMinDepth(int depth);
+
+	/**
+	 * rays traced per path in the last render, the camera ray included and shadow rays not. the
+	 * wavefront integrator is not counted
+	 */
+	double getAveragePathLength() const;
+
+	RenderStats getRenderStats() const;
+
+	RenderIntegrator getIntegrator() const;
+
+	void setIntegrator(RenderIntegrator integrator);
+
+	float getAdaptiveThreshold() const;
+
+	/**
+	 * stop sampling a block of pixels once the root mean square of the standard errors of its pixel
+	 * means, relative to the mean luminance of the block, falls below the threshold. this is a per pixel
+	 * error, not the error of the block mean. the samples it did not use go to the noisier blocks of its
+	 * tile, up to adaptive_max_factor times sample_count per pixel. 0 turns adaptive sampling off
+	 */
+	void setAdaptiveThreshold(float threshold);
+
+	int getAdaptiveMinSamples() const;
+
+	/**
+	 * samples every pixel takes before its error is first checked
+	 */
+	void setAdaptiveMinSamples(int samples);
+
+	/**
+	 * convergence of every tile of the last adaptive render, indexed by chunk index
+	 */
+	const std::vector<TileStats> &getTileStats() const;
+
+	static constexpr int adaptive_max_factor = 4;
+
+	int getProgressivePassSamples() const;
+
+	/**
+	 * render in passes of this many samples per pixel, writing the image after every pass. 0 renders
+	 * all samples in one go
+	 */
+	void setProgressivePassSamples(int samples);
+
+	const std::string &getCheckpointPath() const;
+
+	/**
+	 * file a progressive render checkpoints its accumulated image into, and resumes from if it already
+	 * holds a checkpoint of the same image size, frame and render fingerprint. empty disables checkpoints
+	 */
+	void setCheckpointPath(const std::string &path);
+
+	const std::string &getCheckpointKey() const;
+
+	/**
+	 * goes into the render fingerprint next to the camera and integrator settings, the output name and
+	 * the bounds and light count of the world. change it when the scene changes in a way those miss,
+	 * such as a material, so an old checkpoint is not resumed
+	 */
+	void setCheckpointKey(const std::string &key);
+
+	float getCheckpointInterval() const;
+
+	/**
+	 * minimum seconds between two checkpoints, they are only taken between passes and always after
+	 * the last one
+	 */
+	void setCheckpointInterval(float seconds);
+
 private:
 	Color rayColor(const Ray &ray, const IHittable &object, int depth);
 
+	/**
+	 * hash of everything a checkpointed image depends on besides its size and frame
+	 */
+	uint64_t renderFingerprint(const IHittable &world, const std::string &name) const;
+
+	/**
+	 * follow a path from its first hit until it leaves the scene, is absorbed, is ended by russian
+	 * roulette or reaches depth rays
+	 */
+	Color shade(const Ray &ray, const HitRecord &record, const IHittable &object, int depth);
+
+	/**
+	 * light arriving at record from one direction sampled towards the lights, already weighted against
+	 * finding the same light by scattering
+	 */
+	Color sampleLights(const Ray &ray, const HitRecord &record, const IHittable &object, const Color &attenuation);
+
+	struct PathStats {
+		uint64_t paths = 0;
+		uint64_t rays = 0;
+		uint64_t shadow_rays = 0;
+	};
+
+	struct PixelSample {
+		int x;
+		int y;
+		uint32_t sample;
+	};
+
+	std::string renderProgressive(const IHittable &world, const std::string &name, const std::string &path);
+
+	/**
+	 * add samples [first_sample, first_sample + samples) of every pixel to image
+	 */
+	void renderPass(const IHittable &world, Framebuffer &image, int first_sample, int samples,
+					AsyncImageWriter *writer);
+
+	void tracePacketTile(const IHittable &world, FramebufferTile &tile, int first_sample, int samples);
+
+	/**
+	 * radiance of up to RayPacket::size pixel samples, traced as one packet when packet tracing is on
+	 */
+	void traceSamples(const IHittable &world, const PixelSample *samples, int count, Color *colors);
+
+	TileStats traceAdaptiveTile(const IHittable &world, FramebufferTile &tile);
+
 	void updateVectors();
 
-	Eigen::Vector3d randomDisplacement() const;
+	Vec3 randomDisplacement() const;
 
 	Point3 dofDiskSample() const;
 
-	void RenderWorker(const IHittable &world);
-
-	int partition() const;
+	void RenderWorker(const IHittable &world, TileScheduler &scheduler, int worker_idx, Framebuffer &image,
+					  AsyncImageWriter *writer, int first_sample, int samples);
 
 	int width;
 	int height;
@@ -122,20 +315,45 @@ private:
 	int chunk_dimension = width / render_thread_count < 0 ? width : width / render_thread_count;
 	float dof_angle = 0;
 	float shutter_speed = 1;
-	Eigen::Vector3d u, v, w;
+	int frame = 0;
+	bool packet_tracing = true;
+	bool light_sampling = true;
+	int roulette_min_depth = 5;
+	// one slot per worker of the last pass
+	std::vector<PathStats> path_stats;
+	// counted by the calling worker, copied into path_stats when it finishes
+	static thread_local PathStats worker_path_stats;
+	double pass_seconds = 0;
+	// lights of the world being rendered, collected at the start of every pass
+	LightList lights;
+	RenderIntegrator integrator = INTEGRATOR_RECURSIVE;
+	float adaptive_threshold = 0;
+	int adaptive_min_samples = 16;
+	// samples per pixel between two error checks
+	static constexpr int adaptive_batch = 16;
+	// side of the pixel blocks that converge together
+	static constexpr int adaptive_block = 8;
+	// keeps the relative error of nearly black pixels from blowing up
+	static constexpr double adaptive_dark_floor = 0.1;
+	std::vector<TileStats> tile_stats;
+	int progressive_pass_samples = 0;
+	std::string checkpoint_path;
+	std::string checkpoint_key;
+	float checkpoint_interval = 60;
+	Vec3 u, v, w;
 	Point3 position;
-	Eigen::Vector3d rotation_ypr = {0, 0, 0};
-	Eigen::Matrix3d rotation_matrix = Eigen::Matrix3d::Identity();
+	Vec3 rotation_ypr = {0, 0, 0};
+	Mat3 rotation_matrix = Mat3::Identity();
 	Point3 target;
-	Eigen::Vector3d UP = Eigen::Vector3d::UnitY();
-	Eigen::Vector3d hori_vec;
-	Eigen::Vector3d vert_vec;
-	Eigen::Vector3d pix_delta_x;
-	Eigen::Vector3d pix_delta_y;
+	Vec3 UP = Vec3::UnitY();
+	Vec3 hori_vec;
+	Vec3 vert_vec;
+	Vec3 pix_delta_x;
+	Vec3 pix_delta_y;
 	Point3 viewport_ul;
 	Point3 pixel_00;
-	Eigen::Vector3d dof_disk_h;
-	Eigen::Vector3d dof_disk_v;
+	Vec3 dof_disk_h;
+	Vec3 dof_disk_v;
 	Color background;
 };
 
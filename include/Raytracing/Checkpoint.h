@@ -0,0 +1,82 @@
+/**
+ * @file Checkpoint.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Memory mapped snapshot of a progressive render that survives the process
+ */
+
+#ifndef RAYTRACING_CHECKPOINT_H
+#define RAYTRACING_CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Framebuffer.h"
+
+/**
+ * the file holds a header and two slots, each with the running mean color and the sample count of
+ * every pixel. a save fills the slot that is not current, syncs it, then flips the header over to it,
+ * so a crash in the middle of a save leaves the previous snapshot intact.
+ * samples are seeded from (frame, pixel, sample index), the sample counts are all the random state a
+ * render needs to continue exactly where it stopped.
+ */
+class Checkpoint {
+public:
+	/**
+	 * map the checkpoint at filepath, an existing file is reused if it was written for the same image
+	 * size, frame and fingerprint, anything else is replaced by an empty checkpoint
+	 * @param fingerprint hash of everything else the image depends on, see Camera::renderFingerprint
+	 */
+	Checkpoint(const std::string &filepath, int width, int height, int frame, uint64_t fingerprint);
+
+	~Checkpoint();
+
+	Checkpoint(const Checkpoint &other) = delete;
+
+	Checkpoint &operator=(const Checkpoint &other) = delete;
+
+	bool isOpen() const;
+
+	/**
+	 * samples per pixel in the current snapshot, 0 for a new checkpoint
+	 */
+	uint32_t samplesDone() const;
+
+	/**
+	 * copy the current snapshot into img, which needs the FB_SAMPLE_COUNT channel
+	 * @return samples per pixel in the snapshot
+	 */
+	uint32_t restore(Framebuffer &img) const;
+
+	/**
+	 * snapshot img after samples_done samples per pixel and sync it to disk
+	 * @return false if the snapshot could not be synced, the previous one is still current then
+	 */
+	bool save(const Framebuffer &img, uint32_t samples_done);
+
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		int32_t width;
+		int32_t height;
+		int32_t frame;
+		uint32_t current;
+		uint32_t samples_done[2];
+		uint64_t fingerprint;
+	};
+
+	float *slotColor(uint32_t slot) const;
+
+	uint32_t *slotSampleCount(uint32_t slot) const;
+
+	std::string filepath;
+	int img_width;
+	int img_height;
+	int fd = -1;
+	std::byte *mapping = nullptr;
+	size_t slot_size = 0;
+	size_t file_size = 0;
+};
+
+#endif // RAYTRACING_CHECKPOINT_H
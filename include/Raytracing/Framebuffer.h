@@ -0,0 +1,135 @@
+/**
+ * @file Framebuffer.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Contiguous multi-channel image the render pipeline writes into
+ */
+
+#ifndef RAYTRACING_FRAMEBUFFER_H
+#define RAYTRACING_FRAMEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ImageUtil.h"
+#include "MathUtil.h"
+
+/**
+ * optional channels, linear RGB color is always present
+ */
+enum FramebufferChannel : uint32_t {
+	FB_ALPHA = 1 << 0,
+	FB_DEPTH = 1 << 1,
+	FB_NORMAL = 1 << 2,
+	FB_SAMPLE_COUNT = 1 << 3,
+};
+
+class FramebufferTile;
+
+/**
+ * every channel is a plane inside one 64 byte aligned allocation, rows are stored top to bottom.
+ * color and normal planes hold three interleaved floats per pixel, the rest one value per pixel.
+ * color is linear radiance, gamma is applied by whoever writes the image out.
+ */
+class Framebuffer {
+public:
+	Framebuffer(int width, int height, uint32_t channels = 0);
+
+	Framebuffer(const Framebuffer &other) = delete;
+
+	Framebuffer &operator=(const Framebuffer &other) = delete;
+
+	Framebuffer(Framebuffer &&other) noexcept = default;
+
+	Framebuffer &operator=(Framebuffer &&other) noexcept = default;
+
+	int width() const;
+
+	int height() const;
+
+	bool hasChannel(FramebufferChannel channel) const;
+
+	void clear();
+
+	Color getColor(int x, int y) const;
+
+	void setColor(int x, int y, const Color &c);
+
+	/**
+	 * @return pointer to the first of the three color floats of row y
+	 */
+	float *colorRow(int y);
+
+	const float *colorRow(int y) const;
+
+	float *alphaRow(int y);
+
+	float *depthRow(int y);
+
+	float *normalRow(int y);
+
+	uint32_t *sampleCountRow(int y);
+
+	const uint32_t *sampleCountRow(int y) const;
+
+	/**
+	 * view over the pixels of one chunk, workers write through it without copying
+	 */
+	FramebufferTile tile(const ImageChunk &chunk);
+
+private:
+	struct AlignedFree {
+		void operator()(std::byte *p) const;
+	};
+
+	template<typename T>
+	T *plane(size_t offset, int y, int components) const {
+		return reinterpret_cast<T *>(storage.get() + offset) + static_cast<size_t>(y) * img_width * components;
+	}
+
+	int img_width;
+	int img_height;
+	uint32_t channels;
+	size_t color_offset = 0;
+	size_t alpha_offset = 0;
+	size_t depth_offset = 0;
+	size_t normal_offset = 0;
+	size_t sample_count_offset = 0;
+	size_t byte_size = 0;
+	std::unique_ptr<std::byte[], AlignedFree> storage;
+};
+
+class FramebufferTile {
+public:
+	FramebufferTile(Framebuffer &target, const ImageChunk &chunk);
+
+	const ImageChunk &chunk() const;
+
+	/**
+	 * all coordinates are relative to the upper left corner of the chunk
+	 */
+	void setColor(int x, int y, const Color &c);
+
+	Color getColor(int x, int y) const;
+
+	void setSampleCount(int x, int y, uint32_t count);
+
+	uint32_t getSampleCount(int x, int y) const;
+
+	/**
+	 * fold the sum of samples new radiance samples into the pixel's running mean, the sample count
+	 * says how many samples the mean already holds and goes up by samples. without the sample count
+	 * channel the pixel is simply overwritten with the mean of the new samples
+	 */
+	void accumulateColor(int x, int y, const Color &sum, uint32_t samples);
+
+	void setDepth(int x, int y, float depth);
+
+	void setNormal(int x, int y, const Vec3 &normal);
+
+private:
+	Framebuffer &target;
+	ImageChunk region;
+};
+
+#endif // RAYTRACING_FRAMEBUFFER_H
@@ -9,6 +9,7 @@
 #define GLOBUTIL_HPP
 
 #include "Eigen/Dense"
+#include "Precision.h"
 #include <limits>
 #include <sstream>
 #include <string>
@@ -19,13 +20,13 @@ const float EPS = 1e-3;
 
 inline float deg2Rad(float deg) { return deg * PI / 180.0; }
 
-inline std::string vecToStr(const Eigen::Vector3d &v) {
+inline std::string vecToStr(const Vec3 &v) {
     std::stringstream ss;
     ss << v.x() << " " << v.y() << " " << v.z();
     return ss.str();
 }
 
-inline std::string vecToStr(const Eigen::Vector4d &v) {
+inline std::string vecToStr(const Vec4 &v) {
     std::stringstream ss;
     ss << v.x() << " " << v.y() << " " << v.z() << " " << v.w();
     return ss.str();
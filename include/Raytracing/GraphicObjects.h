@@ -9,8 +9,10 @@
 #define ONEWEEKEND_GRAPHICOBJECTS_H
 
 #include "MathUtil.h"
+#include "RayPacket.h"
 
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 class IMaterial;
@@ -18,22 +20,52 @@ class IMaterial;
 struct HitRecord {
 	bool hit;
 	Point3 p;
-	float t;
-	float u;
-	float v;
-	Eigen::Vector3d normal;
-	std::shared_ptr<IMaterial> material;
+	Real t;
+	Real u;
+	Real v;
+	Vec3 normal;
+	// id in MaterialRegistry, copying a record never touches a reference count
+	uint32_t material_id;
 	bool front_face;
-	void setFaceNormal(const Ray &r, const Eigen::Vector3d &normal_out);
+	void setFaceNormal(const Ray &r, const Vec3 &normal_out);
 };
 
+static_assert(std::is_trivially_destructible_v<HitRecord>, "HitRecord is copied on every closer hit");
+
 class IHittable {
 public:
 	virtual ~IHittable() = default;
 
 	virtual bool hit(const Ray &r, Interval interval, HitRecord &record) const = 0;
 
+	/**
+	 * intersect the given lanes of a packet, every lane searches (t_min, packet.t_max[lane]).
+	 * lanes that hit get their record written and t_max lowered to the hit distance.
+	 * the default traces the lanes one by one through hit()
+	 * @return mask of the lanes that hit
+	 */
+	virtual uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const;
+
 	virtual AABB boundingBox() const = 0;
+
+	/**
+	 * append every primitive below this object that emits light and can be sampled, see LightList.
+	 * primitives behind a Transform or inside an InstanceBVH are not collected, their samples would
+	 * have to be moved into world space. emissive spheres of a SpherePool are collected as the
+	 * Sphere they stand for, an emissive TriangleMesh as one light
+	 */
+	virtual void collectLights(std::vector<const IHittable *> &lights) const;
+
+	/**
+	 * direction from origin towards a random point of the object, only meaningful for objects that
+	 * add themselves in collectLights
+	 */
+	virtual Vec3 sampleDirection(const Point3 &origin) const;
+
+	/**
+	 * solid angle density of sampleDirection returning direction, 0 if the direction misses the object
+	 */
+	virtual float directionPdf(const Point3 &origin, const Vec3 &direction) const;
 };
 
 class HittableList : public IHittable {
@@ -54,65 +86,91 @@ public:
 
 	AABB boundingBox() const override;
 
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
 private:
 	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
 
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
 	AABB bbox;
 };
 
+/**
+ * nearest root of the ray sphere quadratic strictly inside (t_min, t_max). templated on the scalar so
+ * the precision bench runs the arithmetic of Sphere in both float and double
+ * @return false if the ray misses the sphere within the range
+ */
+template<typename T>
+inline bool sphereRoot(const RayT<T> &r, const typename Precision<T>::Vec3 &center, T radius, T t_min, T t_max,
+					   T &root) {
+	typename Precision<T>::Vec3 oc = r.pos() - center;
+	T a = r.dir().squaredNorm();
+	T h = oc.dot(r.dir());
+	T c = oc.squaredNorm() - radius * radius;
+
+	T discriminant = h * h - a * c;
+	if (discriminant < 0)
+		return false;
+	T discri_sqrt = std::sqrt(discriminant);
+
+	root = (-h - discri_sqrt) / a;
+	if (root <= t_min || t_max <= root) {
+		root = (-h + discri_sqrt) / a;
+		if (root <= t_min || t_max <= root) {
+			return false;
+		}
+	}
+	return true;
+}
+
 class Sphere : public IHittable {
 public:
-	Sphere(float radius, Eigen::Vector3d position, std::shared_ptr<IMaterial> mat);
+	Sphere(Real radius, Vec3 position, std::shared_ptr<IMaterial> mat);
 
-	Sphere(float radius, const Point3 &init_position, const Point3 &final_position, std::shared_ptr<IMaterial> mat);
+	Sphere(Real radius, const Point3 &init_position, const Point3 &final_position, std::shared_ptr<IMaterial> mat);
 
-	Eigen::Vector3d getPosition(float time) const;
+	Vec3 getPosition(Real time) const;
 
 	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
 
-	AABB boundingBox() const override;
-
-private:
-	static void getSphereUV(const Point3 &p, float &u, float &v);
-
-	Eigen::Vector3d direction_vec;
-	bool is_moving = false;
-	float radius;
-	AABB bbox;
-	Eigen::Vector3d position;
-	std::shared_ptr<IMaterial> material;
-};
-
-class BVHNode : public IHittable {
-public:
-	BVHNode() = default;
-
-	BVHNode(const HittableList &list);
-
-	BVHNode(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end);
-
-	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
 
 	AABB boundingBox() const override;
 
-private:
-	std::shared_ptr<IHittable> left;
-	std::shared_ptr<IHittable> right;
+	/**
+	 * only a sphere that does not move is collected
+	 */
+	void collectLights(std::vector<const IHittable *> &lights) const override;
 
-	static bool compare(const std::shared_ptr<IHittable> &a, const std::shared_ptr<IHittable> &b, int axis);
+	/**
+	 * uniform over the cone of directions the sphere covers, over every direction from inside it
+	 */
+	Vec3 sampleDirection(const Point3 &origin) const override;
 
-	static bool compareX(const std::shared_ptr<IHittable> &a, const std::shared_ptr<IHittable> &b);
+	float directionPdf(const Point3 &origin, const Vec3 &direction) const override;
 
-	static bool compareY(const std::shared_ptr<IHittable> &a, const std::shared_ptr<IHittable> &b);
+	/**
+	 * ray against a sphere with the given center at the ray's time, shared with SpherePool so both
+	 * produce the same records
+	 */
+	static bool intersect(const Ray &r, const Point3 &center, Real radius, uint32_t material_id, Interval interval,
+						  HitRecord &record);
 
-	static bool compareZ(const std::shared_ptr<IHittable> &a, const std::shared_ptr<IHittable> &b);
+private:
+	static void getSphereUV(const Point3 &p, Real &u, Real &v);
 
+	Vec3 direction_vec;
+	bool is_moving = false;
+	Real radius;
 	AABB bbox;
+	Vec3 position;
+	uint32_t material_id;
 };
 
 class Quad : public IHittable {
 public:
-	Quad(const Eigen::Vector3d &Q, const Eigen::Vector3d &u, const Eigen::Vector3d &v, std::shared_ptr<IMaterial> mat);
+	Quad(const Vec3 &Q, const Vec3 &u, const Vec3 &v, std::shared_ptr<IMaterial> mat);
 
 	virtual ~Quad() = default;
 
@@ -122,20 +180,32 @@ public:
 
 	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
 
-	bool inside(float a, float b, HitRecord &rec) const;
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	/**
+	 * uniform over the area of the quad
+	 */
+	Vec3 sampleDirection(const Point3 &origin) const override;
+
+	float directionPdf(const Point3 &origin, const Vec3 &direction) const override;
+
+	bool inside(Real a, Real b, HitRecord &rec) const;
 
 private:
-	Eigen::Vector3d Q, u, v;
-	Eigen::Vector3d normal;
-	float D;
-	Eigen::Vector3d w;
-	std::shared_ptr<IMaterial> mat;
+	Vec3 Q, u, v;
+	Vec3 normal;
+	Real D;
+	Real area;
+	Vec3 w;
+	uint32_t material_id;
 	AABB bbox;
 };
 
 class Triangle : public IHittable {
 public:
-	Triangle(const Eigen::Vector3d &Q, const Eigen::Vector3d &u, const Eigen::Vector3d &v,
+	Triangle(const Vec3 &Q, const Vec3 &u, const Vec3 &v,
 			 std::shared_ptr<IMaterial> mat);
 
 	virtual ~Triangle() = default;
@@ -146,15 +216,27 @@ public:
 
 	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
 
-	bool inside(const Eigen::Vector3d &intersection) const;
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	/**
+	 * uniform over the area of the triangle
+	 */
+	Vec3 sampleDirection(const Point3 &origin) const override;
+
+	float directionPdf(const Point3 &origin, const Vec3 &direction) const override;
+
+	bool inside(const Vec3 &intersection) const;
 
 private:
-	Eigen::Vector3d Q, u, v;
-	Eigen::Vector3d normal;
-	Eigen::Vector3d w;
-	float D;
+	Vec3 Q, u, v;
+	Vec3 normal;
+	Vec3 w;
+	Real D;
+	Real area;
 
-	std::shared_ptr<IMaterial> mat;
+	uint32_t material_id;
 	AABB box;
 };
 
@@ -164,9 +246,9 @@ inline std::shared_ptr<HittableList> box(const Point3 &a, const Point3 &b, std::
 	auto min = Point3{std::fmin(a.x(), b.x()), std::fmin(a.y(), b.y()), std::fmin(a.z(), b.z())};
 	auto max = Point3{std::fmax(a.x(), b.x()), std::fmax(a.y(), b.y()), std::fmax(a.z(), b.z())};
 
-	auto dx = Eigen::Vector3d{max.x() - min.x(), 0, 0};
-	auto dy = Eigen::Vector3d{0, max.y() - min.y(), 0};
-	auto dz = Eigen::Vector3d{0, 0, max.z() - min.z()};
+	auto dx = Vec3{max.x() - min.x(), 0, 0};
+	auto dy = Vec3{0, max.y() - min.y(), 0};
+	auto dz = Vec3{0, 0, max.z() - min.z()};
 
 	sides->add(make_shared<Quad>(Point3{min.x(), min.y(), max.z()}, dx, dy,
 								 mat)); // front
@@ -184,32 +266,61 @@ inline std::shared_ptr<HittableList> box(const Point3 &a, const Point3 &b, std::
 	return sides;
 }
 
-class Translate : public IHittable {
+/**
+ * an object placed in the world by an affine transform. the forward, inverse and normal matrices are
+ * computed once, a hit costs one 3x4 multiply for the ray and one for the record.
+ * with two transforms the object moves from the first at time 0 to the second at time 1, translation
+ * and scale are interpolated linearly and rotation along the shortest arc
+ */
+class Transform : public IHittable {
 public:
-	Translate(std::shared_ptr<IHittable> obj, const Eigen::Vector3d &displacement);
+	/**
+	 * @param object_to_world must be invertible
+	 */
+	Transform(std::shared_ptr<IHittable> obj, const Affine3 &object_to_world);
+
+	Transform(std::shared_ptr<IHittable> obj, const Affine3 &start, const Affine3 &end);
 
 	AABB boundingBox() const override;
 
 	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
 
 private:
-	std::shared_ptr<IHittable> object;
-	Eigen::Vector3d offset;
-	AABB bbox;
-};
+	struct Matrices {
+		Affine3 object_to_world;
+		Affine3 world_to_object;
+		Mat3 normal_matrix;
 
-class Rotation : public IHittable {
-public:
-	Rotation(std::shared_ptr<IHittable> obj, float psi, float theta, float phi, Point3 about_pt);
+		explicit Matrices(const Affine3 &object_to_world);
+	};
 
-	AABB boundingBox() const override;
+	Matrices at(Real time) const;
 
-	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+	bool hitWith(const Matrices &m, const Ray &r, Interval interval, HitRecord &record) const;
 
-private:
 	std::shared_ptr<IHittable> object;
-	Eigen::Matrix4d rotation_matrix, inverse_rotation_matrix;
+	// the only matrices of a transform that does not move
+	Matrices matrices;
+	bool moving;
+	// parts of both transforms for the interpolation, object_to_world = translation * rotation * scale
+	Vec3 translation[2];
+	Quat rotation[2];
+	Mat3 scale[2];
 	AABB bbox;
 };
 
+class Translate : public Transform {
+public:
+	Translate(std::shared_ptr<IHittable> obj, const Vec3 &displacement);
+};
+
+/**
+ * rays are rotated by the euler angles about about_pt before they meet the object, so the object
+ * appears rotated by the inverse
+ */
+class Rotation : public Transform {
+public:
+	Rotation(std::shared_ptr<IHittable> obj, float psi, float theta, float phi, Point3 about_pt);
+};
+
 #endif // ONEWEEKEND_GRAPHICOBJECTS_H
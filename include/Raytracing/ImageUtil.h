@@ -8,7 +8,6 @@
 #ifndef ONEWEEKEND_IMAGEUTIL_H
 #define ONEWEEKEND_IMAGEUTIL_H
 
-#include "KawaiiMQ/kawaiiMQ.h"
 #include "MathUtil.h"
 #include "spdlog/spdlog.h"
 #include "stb_image.h"
@@ -18,7 +17,9 @@
 #include <sys/stat.h>
 #include <tuple>
 #include <vector>
-using Color = Eigen::Vector3d;
+using Color = Vec3;
+
+class Framebuffer;
 
 class Image {
   public:
@@ -48,18 +49,13 @@ const std::string grayscale = " .:-=+*#%@";
 
 std::string getGreyScaleCharacter(float r, float g, float b);
 
-std::string makePPM(int width, int height,
-                    const std::vector<std::vector<Color>> &img,
-                    const std::string &name,
+std::string makePPM(const Framebuffer &img, const std::string &name,
                     const std::string &path = IMG_OUTPUT_DIR);
 
-std::string makeGrayscaleTxt(int width, int height,
-                             const std::vector<std::vector<Color>> &img,
-                             const std::string &name,
+std::string makeGrayscaleTxt(const Framebuffer &img, const std::string &name,
                              const std::string &path = IMG_OUTPUT_DIR);
 
-std::string makeGrayscaleString(int width, int height,
-                                std::vector<std::vector<Color>> img);
+std::string makeGrayscaleString(const Framebuffer &img);
 
 std::string mkdir(const std::string &path, const std::string &name);
 
@@ -70,13 +66,12 @@ int clamp(int x, int low, int high);
 
 float gammaCorrect(float c);
 
-struct ImageChunk : public KawaiiMQ::MessageData {
+struct ImageChunk {
     int startx;
     int starty;
     int chunk_idx;
     int width;
     int height;
-    std::vector<std::vector<Color>> partial;
 };
 
 #endif // ONEWEEKEND_IMAGEUTIL_H
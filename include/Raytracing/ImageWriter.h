@@ -0,0 +1,143 @@
+/**
+ * @file ImageWriter.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Image encoders and a background writer streaming rows while the render runs
+ */
+
+#ifndef RAYTRACING_IMAGEWRITER_H
+#define RAYTRACING_IMAGEWRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Framebuffer.h"
+#include "ImageUtil.h"
+
+class IImageWriter {
+public:
+	virtual ~IImageWriter() = default;
+
+	/**
+	 * open the output file
+	 * @return false if the file cannot be written
+	 */
+	virtual bool begin(const std::string &filepath, int width, int height) = 0;
+
+	/**
+	 * encode rows [begin_row, end_row) of the framebuffer, rows may arrive in any order
+	 */
+	virtual void writeRows(const Framebuffer &img, int begin_row, int end_row) = 0;
+
+	/**
+	 * flush everything to disk, called once after every row has been written
+	 */
+	virtual bool finish() = 0;
+};
+
+/**
+ * binary P6 ppm, every row has a fixed offset so finished rows are written straight to their place
+ */
+class PPMWriter : public IImageWriter {
+public:
+	bool begin(const std::string &filepath, int width, int height) override;
+
+	void writeRows(const Framebuffer &img, int begin_row, int end_row) override;
+
+	bool finish() override;
+
+private:
+	std::ofstream fout;
+	std::streamoff header_size = 0;
+	int img_width = 0;
+	std::vector<uint8_t> row_buffer;
+};
+
+/**
+ * 8 bit png through stb_image_write. png rows are deflated as one stream, so rows are converted as
+ * they arrive but the file is encoded when the image is complete
+ */
+class PNGWriter : public IImageWriter {
+public:
+	bool begin(const std::string &filepath, int width, int height) override;
+
+	void writeRows(const Framebuffer &img, int begin_row, int end_row) override;
+
+	bool finish() override;
+
+private:
+	std::string filepath;
+	int img_width = 0;
+	int img_height = 0;
+	std::vector<uint8_t> pixels;
+};
+
+/**
+ * portable float map, linear 32 bit RGB without gamma or clamping for HDR output
+ */
+class PFMWriter : public IImageWriter {
+public:
+	bool begin(const std::string &filepath, int width, int height) override;
+
+	void writeRows(const Framebuffer &img, int begin_row, int end_row) override;
+
+	bool finish() override;
+
+private:
+	std::ofstream fout;
+	std::streamoff header_size = 0;
+	int img_width = 0;
+	int img_height = 0;
+};
+
+/**
+ * pick an encoder from the file extension: .png, .pfm, anything else is written as ppm
+ */
+std::unique_ptr<IImageWriter> makeImageWriter(const std::string &name);
+
+/**
+ * runs an encoder on its own thread. render workers report finished chunks, and every row whose
+ * pixels are all done is handed to the encoder while the rest of the image is still rendering
+ */
+class AsyncImageWriter {
+public:
+	AsyncImageWriter(std::unique_ptr<IImageWriter> writer, const std::string &filepath, const Framebuffer &img);
+
+	~AsyncImageWriter();
+
+	AsyncImageWriter(const AsyncImageWriter &other) = delete;
+
+	AsyncImageWriter &operator=(const AsyncImageWriter &other) = delete;
+
+	/**
+	 * called by a render worker once every pixel of the chunk is in the framebuffer
+	 */
+	void chunkDone(const ImageChunk &chunk);
+
+	/**
+	 * encode whatever is left and wait for the encoder thread
+	 * @return false if the image could not be written
+	 */
+	bool finish();
+
+private:
+	void run();
+
+	std::unique_ptr<IImageWriter> writer;
+	const Framebuffer &img;
+	bool ok;
+	bool finished = false;
+	std::vector<int> pixels_left;
+	std::deque<std::pair<int, int>> ready_rows;
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::thread encoder;
+};
+
+#endif // RAYTRACING_IMAGEWRITER_H
@@ -0,0 +1,85 @@
+/**
+ * @file InstanceBVH.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Top level hierarchy over transformed instances of shared geometry
+ */
+
+#ifndef RAYTRACING_INSTANCEBVH_H
+#define RAYTRACING_INSTANCEBVH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BVH.h"
+#include "Eigen/Geometry"
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+#include "RayPacket.h"
+
+/**
+ * two level acceleration structure. geometry is added once and keeps whatever hierarchy it has of its
+ * own (a BVHNode, a TriangleMesh, a SpherePool), that is the bottom level. instances refer to a piece
+ * of geometry with a 3x4 affine transform and optionally their own material, and the top level
+ * hierarchy is built over the world bounds of the instances only. moving instances means calling
+ * setTransform and build again, the geometry is never touched
+ */
+class InstanceBVH : public IHittable {
+public:
+	InstanceBVH() = default;
+
+	/**
+	 * @return id of the geometry for addInstance
+	 */
+	uint32_t addGeometry(std::shared_ptr<IHittable> geometry);
+
+	/**
+	 * place geometry in the world
+	 * @param transform object to world transform, must be invertible
+	 * @param mat replaces the materials of the geometry for this instance, nullptr keeps them
+	 * @return id of the instance for setTransform
+	 */
+	uint32_t addInstance(uint32_t geometry, const Affine3 &transform,
+						 const std::shared_ptr<IMaterial> &mat = nullptr);
+
+	void setTransform(uint32_t instance, const Affine3 &transform);
+
+	/**
+	 * build the top level hierarchy, call it before rendering and after instances move
+	 */
+	void build();
+
+	size_t instanceCount() const;
+
+	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	AABB boundingBox() const override;
+
+private:
+	struct Instance {
+		Affine3 object_to_world;
+		Affine3 world_to_object;
+		uint32_t geometry;
+		// 0 keeps the materials of the geometry
+		uint32_t material_id;
+	};
+
+	AABB worldBounds(const Instance &instance) const;
+
+	bool hitInstance(const Instance &instance, const Ray &r, Interval interval, HitRecord &record) const;
+
+	bool hitLeaf(const LinearBVHNode &node, const Ray &r, Interval &interval, HitRecord &record) const;
+
+	bool traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const;
+
+	std::vector<std::shared_ptr<IHittable>> geometries;
+	std::vector<Instance> instances;
+	// instance_order[i] is the instance the leaves refer to as i
+	std::vector<uint32_t> instance_order;
+	std::vector<LinearBVHNode> nodes;
+	AABB bbox;
+};
+
+#endif // RAYTRACING_INSTANCEBVH_H
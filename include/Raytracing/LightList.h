@@ -0,0 +1,54 @@
+/**
+ * @file LightList.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Emissive primitives of a scene, sampled for direct lighting
+ */
+
+#ifndef RAYTRACING_LIGHTLIST_H
+#define RAYTRACING_LIGHTLIST_H
+
+#include <vector>
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+
+/**
+ * every emissive primitive the world hands out through IHittable::collectLights. a direction is
+ * sampled by picking one light uniformly and then a point on it, so the density of a direction is the
+ * mean of the densities of all lights. the primitives are borrowed from the world
+ */
+class LightList {
+public:
+	LightList() = default;
+
+	explicit LightList(const IHittable &world);
+
+	bool empty() const;
+
+	size_t size() const;
+
+	/**
+	 * @return direction from origin towards a random point on a random light, not normalized
+	 */
+	Vec3 sample(const Point3 &origin) const;
+
+	/**
+	 * solid angle density of sample() returning direction
+	 */
+	float pdf(const Point3 &origin, const Vec3 &direction) const;
+
+private:
+	std::vector<const IHittable *> lights;
+};
+
+/**
+ * multiple importance sampling weight of a sample drawn with density pdf, when other_pdf is the
+ * density the other strategy would have drawn it with
+ */
+inline float powerHeuristic(float pdf, float other_pdf) {
+	float a = pdf * pdf;
+	float b = other_pdf * other_pdf;
+	return a + b > 0 ? a / (a + b) : 0;
+}
+
+#endif // RAYTRACING_LIGHTLIST_H
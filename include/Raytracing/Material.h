@@ -7,20 +7,32 @@
 
 #ifndef ONEWEEKEND_MATERIAL_H
 #define ONEWEEKEND_MATERIAL_H
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "MathUtil.h"
 #include "GraphicObjects.h"
-#include "KawaiiMQ/kawaiiMQ.h"
 #include "Texture.h"
 
 class IMaterial {
 public:
 	virtual ~IMaterial() = default;
 
-	virtual bool scatter(const Ray &r_in, const HitRecord &record, Eigen::Vector3d &attenuation,
+	virtual bool scatter(const Ray &r_in, const HitRecord &record, Vec3 &attenuation,
 						 Ray &scattered) const = 0;
 	
 	virtual Color emitted(float u, float v, const Point3& p) const;
+
+	/**
+	 * solid angle density of scatter() sending the ray into direction, chosen so that the light reflected
+	 * towards r_in is attenuation * scatteringPdf * incoming light. 0 for materials that only scatter into
+	 * a single direction, light sampling skips those
+	 */
+	virtual float scatteringPdf(const Ray &r_in, const HitRecord &record, const Vec3 &direction) const;
+
+	virtual bool isEmissive() const;
 };
 
 class Lambertian : public IMaterial {
@@ -29,10 +41,14 @@ public:
 
 	Lambertian(std::shared_ptr<ITexture> tex);
 
-	bool scatter(const Ray &r_in, const HitRecord &record, Eigen::Vector3d &attenuation,
+	bool scatter(const Ray &r_in, const HitRecord &record, Vec3 &attenuation,
 				 Ray &scattered) const override;
 
+	float scatteringPdf(const Ray &r_in, const HitRecord &record, const Vec3 &direction) const override;
+
 private:
+	friend class MaterialRegistry;
+
 	std::shared_ptr<ITexture> albedo;
 
 };
@@ -43,10 +59,12 @@ public:
 
 	Metal(const Color& abledo, float fuzz);
 
-	bool scatter(const Ray &r_in, const HitRecord &record, Eigen::Vector3d &attenuation,
+	bool scatter(const Ray &r_in, const HitRecord &record, Vec3 &attenuation,
 				 Ray &scattered) const override;
 
 private:
+	friend class MaterialRegistry;
+
 	std::shared_ptr<ITexture> albedo;
 	float fuzz;
 };
@@ -57,9 +75,11 @@ public:
 
 	Dielectric(float idx, const Color& albedo);
 
-	bool scatter(const Ray &r_in, const HitRecord &record, Eigen::Vector3d &attenuation,
+	bool scatter(const Ray &r_in, const HitRecord &record, Vec3 &attenuation,
 				 Ray &scattered) const override;
 private:
+	friend class MaterialRegistry;
+
 	float ir;
 	std::shared_ptr<ITexture> albedo;
 	static float reflectance(float cosine, float refr_idx);
@@ -71,13 +91,127 @@ public:
 
 	DiffuseLight(Color c);
 
-	bool scatter(const Ray &r_in, const HitRecord &record, Eigen::Vector3d &attenuation,
+	bool scatter(const Ray &r_in, const HitRecord &record, Vec3 &attenuation,
 				 Ray &scattered) const override;
 	
 	Color emitted(float u, float v, const Point3& p) const override;
 
+	bool isEmissive() const override;
+
 private:
+	friend class MaterialRegistry;
+
 	std::shared_ptr<ITexture> emit;
 };
 
+/**
+ * the built in materials flattened into one tagged record, so shading switches on the type instead of
+ * calling through a vtable. any other IMaterial is MATERIAL_CUSTOM and still goes through its virtual
+ * functions
+ */
+enum MaterialType : uint8_t {
+	MATERIAL_NONE,
+	MATERIAL_LAMBERTIAN,
+	MATERIAL_METAL,
+	MATERIAL_DIELECTRIC,
+	MATERIAL_DIFFUSE_LIGHT,
+	MATERIAL_CUSTOM,
+};
+
+struct MaterialRecord {
+	MaterialType type;
+	// albedo, or emission for a light, as an id in the texture table
+	uint32_t texture;
+	// fuzz of a metal, index of refraction of a dielectric
+	float param;
+	const IMaterial *custom;
+};
+
+/**
+ * textures flattened the same way. a checker refers to its two textures by id. image and noise
+ * textures keep their data in the texture object and are called without going through the vtable
+ */
+enum TextureType : uint8_t {
+	TEXTURE_SOLID,
+	TEXTURE_CHECKER,
+	TEXTURE_IMAGE,
+	TEXTURE_NOISE,
+	TEXTURE_TERRAIN,
+	TEXTURE_CUSTOM,
+};
+
+struct TextureRecord {
+	TextureType type;
+	float inv_scale;
+	uint32_t even;
+	uint32_t odd;
+	Color color;
+	const ITexture *texture;
+};
+
+/**
+ * owns the materials of every scene and hands out compact ids for them, so a hit record only carries
+ * an integer instead of a reference counted pointer. id 0 is no material. materials stay alive until
+ * clear(), which the scene functions call once their scene is rendered; registration happens while
+ * scenes are built and must not overlap a render, lookups take no lock.
+ * every material is also compiled into a MaterialRecord and its textures into TextureRecords, both in
+ * flat arrays indexed by id. renderers shade through the static functions below, which dispatch on
+ * the record type
+ */
+class MaterialRegistry {
+public:
+	static MaterialRegistry &instance() {
+		// defined here so the lookups below inline down to a few loads
+		static MaterialRegistry registry;
+		return registry;
+	}
+
+	/**
+	 * @return id of the material, the same material always gets the same id
+	 */
+	uint32_t add(const std::shared_ptr<IMaterial> &material);
+
+	static const IMaterial *get(uint32_t id) { return instance().materials[id]; }
+
+	static const MaterialRecord &record(uint32_t id) { return instance().records[id]; }
+
+	static const TextureRecord &texture(uint32_t id) { return instance().textures[id]; }
+
+	size_t size() const;
+
+	/**
+	 * release every material and texture and start over with only id 0. ids handed out before are
+	 * invalid afterwards, so nothing built before may be rendered again
+	 */
+	void clear();
+
+	static Color emitted(uint32_t id, float u, float v, const Point3 &p);
+
+	static bool scatter(uint32_t id, const Ray &r_in, const HitRecord &record, Vec3 &attenuation, Ray &scattered);
+
+	static float scatteringPdf(uint32_t id, const Ray &r_in, const HitRecord &record, const Vec3 &direction);
+
+	static bool isEmissive(uint32_t id);
+
+	static Color textureValue(uint32_t id, float u, float v, const Point3 &p);
+
+private:
+	MaterialRegistry();
+
+	MaterialRecord compile(const std::shared_ptr<IMaterial> &material);
+
+	/**
+	 * @return id of the texture in the texture table, called with the lock held
+	 */
+	uint32_t addTexture(const std::shared_ptr<ITexture> &texture);
+
+	std::mutex mutex;
+	std::vector<const IMaterial *> materials;
+	std::vector<std::shared_ptr<IMaterial>> owners;
+	std::unordered_map<const IMaterial *, uint32_t> ids;
+	std::vector<MaterialRecord> records;
+	std::vector<TextureRecord> textures;
+	std::unordered_map<const ITexture *, uint32_t> texture_ids;
+};
+
 #endif // ONEWEEKEND_MATERIAL_H
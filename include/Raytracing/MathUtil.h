@@ -9,50 +9,82 @@
 #define ONEWEEKEND_MATHUTIL_H
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
-#include <random>
+#include <vector>
 #include "Eigen/Core"
 #include "Eigen/Dense"
 #include "Eigen/Geometry"
 #include "GlobUtil.hpp"
 #include "spdlog/fmt/bundled/core.h"
 
-using Point3 = Eigen::Vector3d;
-
-class Ray {
-private:
-	Point3 position;
-	Eigen::Vector3d direction;
-	double tm;
+using Point3 = Vec3;
 
+/**
+ * ray with its reciprocal direction and direction signs computed once at construction, so every box
+ * test along its way only multiplies. members are returned by reference
+ * @tparam T scalar precision, the tracer uses Ray = RayT<Real>
+ */
+template<typename T>
+class RayT {
 public:
-	Ray(Eigen::Vector3d pos, Eigen::Vector3d dir, double time);
-	Ray(Eigen::Vector3d pos, Eigen::Vector3d dir);
-	Ray() = default;
+	using Vec = typename Precision<T>::Vec3;
+
+	RayT(const Vec &pos, const Vec &dir, T time) : position(pos), direction(dir), tm(time) {
+		for (int i = 0; i < 3; i++) {
+			inv_direction[i] = T(1) / direction[i];
+			negative[i] = inv_direction[i] < 0;
+		}
+	}
+
+	RayT(const Vec &pos, const Vec &dir) : RayT(pos, dir, T(0)) {}
 
-	Eigen::Vector3d pos() const;
-	Eigen::Vector3d dir() const;
-	double time() const;
+	RayT() = default;
 
-	Point3 at(double t) const;
+	const Vec &pos() const { return position; }
+
+	const Vec &dir() const { return direction; }
+
+	/**
+	 * component wise 1 / dir(), infinite for axis parallel directions
+	 */
+	const Vec &invDir() const { return inv_direction; }
+
+	/**
+	 * @return 1 if the direction points towards -axis, 0 otherwise
+	 */
+	int sign(int axis) const { return negative[axis]; }
+
+	T time() const { return tm; }
+
+	Vec at(T t) const { return position + direction * t; }
+
+private:
+	Vec position;
+	Vec direction;
+	Vec inv_direction;
+	T tm = 0;
+	uint8_t negative[3] = {};
 };
 
+using Ray = RayT<Real>;
+
 class Interval {
 public:
-	double min, max;
+	Real min, max;
 	Interval();
 
-	Interval(float min, float max);
+	Interval(Real min, Real max);
 
 	Interval(const Interval &first, const Interval &second);
 
-	bool within(float x) const;
+	bool within(Real x) const;
 
-	bool surround(float x) const;
+	bool surround(Real x) const;
 
-	float clamp(float x) const;
+	Real clamp(Real x) const;
 
-	Interval expand(float delta);
+	Interval expand(Real delta);
 
 	static const Interval empty, universe;
 };
@@ -88,6 +120,13 @@ public:
 
 	float octaveNoise(const Point3 &p, float frequency, int octave_count, float presistence) const;
 
+	/**
+	 * unnormalized sum of the octaves first_octave to octave_count - 1, eight octaves at a time, one per
+	 * lane of a Float8. with AVX2 the lattice hashing is gathered too, otherwise it stays scalar per lane.
+	 * the same as summing rawNoise over the octaves
+	 */
+	float octaveSum(const Point3 &p, float frequency, int first_octave, int octave_count, float persistence) const;
+
 private:
 	static constexpr int perm[] = {
 			151, 160, 137, 91,	90,	 15,  131, 13,	201, 95,  96,  53,	194, 233, 7,   225, 140, 36,  103, 30,	69,
@@ -116,30 +155,138 @@ private:
 			176, 115, 121, 50,	45,	 127, 4,   150, 254, 138, 236, 205, 93,	 222, 114, 67,	29,	 24,  72,  243, 141,
 			128, 195, 78,  66,	215, 61,  156, 180};
 
+	// gradient of each hash & 15, the twelve cube edge directions with four of them repeated
+	static constexpr float gradients[16][3] = {
+			{1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0}, {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+			{0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1}, {1, 1, 0}, {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}};
+
 	float fade(float x) const;
 
 	float lerp(float begin, float end, float weight) const;
 
-	float gradientDotProd(int hash, const Eigen::Vector3d &pt) const;
+	float gradientDotProd(int hash, const Vec3 &pt) const;
+};
+
+/**
+ * octave noise with fixed parameters, as NoiseTexture and TerrainTexture use it. bake() samples the
+ * octaves coarse enough for a grid of the given resolution over a box, at least eight grid cells per
+ * lattice cell, and lookups inside the box interpolate those trilinearly and evaluate only the finer
+ * octaves. outside the box, or without bake(), every octave is evaluated
+ */
+class OctaveNoise {
+public:
+	OctaveNoise(float frequency, int octave_count, float persistence);
+
+	/**
+	 * @param resolution grid cells along the longest axis of bounds
+	 */
+	void bake(const AABB &bounds, int resolution);
+
+	/**
+	 * @return number of octaves taken from the baked grid, 0 before bake()
+	 */
+	int bakedOctaves() const;
+
+	/**
+	 * noise in [-1, 1], the same as Perlin::octaveNoise up to the interpolation of the baked octaves
+	 */
+	float value(const Point3 &p) const;
+
+private:
+	float baked(const Point3 &p) const;
+
+	Perlin noise;
+	float frequency;
+	int octave_count;
+	float persistence;
+	// sum of the amplitudes of all octaves
+	float max_value;
+
+	int baked_octaves = 0;
+	AABB bounds;
+	int cells[3];
+	float inv_cell_size;
+	// (cells[0] + 1) * (cells[1] + 1) * (cells[2] + 1) samples, x fastest
+	std::vector<float> grid;
+};
+
+/**
+ * PCG32 generator (O'Neill, pcg-random.org), 16 bytes of state and a few cycles per number
+ */
+class Pcg32 {
+public:
+	Pcg32();
+
+	Pcg32(uint64_t init_state, uint64_t stream);
+
+	void seed(uint64_t init_state, uint64_t stream);
+
+	uint32_t nextUInt();
+
+	/**
+	 * @return uniformly distributed float in [0, 1)
+	 */
+	float nextFloat();
+
+private:
+	uint64_t state;
+	uint64_t inc;
 };
 
-inline float randomFloat() {
-	static std::uniform_real_distribution<float> distribution(0.0, 1.0);
-	static std::mt19937 generator;
-	return distribution(generator);
+inline uint32_t Pcg32::nextUInt() {
+	uint64_t old_state = state;
+	state = old_state * 6364136223846793005ULL + inc;
+	auto xorshifted = static_cast<uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+	auto rot = static_cast<uint32_t>(old_state >> 59u);
+	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
 }
 
-inline double randomFloat(double min, double max) { return min + (max - min) * randomFloat(); }
+inline float Pcg32::nextFloat() { return static_cast<float>(nextUInt() >> 8) * 0x1p-24f; }
+
+/**
+ * splitmix64 finalizer, spreads structured keys like pixel indices over the whole seed space
+ */
+inline uint64_t mixBits(uint64_t v) {
+	v ^= v >> 30;
+	v *= 0xbf58476d1ce4e5b9ULL;
+	v ^= v >> 27;
+	v *= 0x94d049bb133111ebULL;
+	v ^= v >> 31;
+	return v;
+}
+
+/**
+ * generator owned by the calling thread, every random function below draws from it
+ */
+inline Pcg32 &threadRng() {
+	thread_local Pcg32 rng;
+	return rng;
+}
+
+/**
+ * reseed the calling thread's generator for one sample. the sequence only depends on the arguments,
+ * so renders are reproducible regardless of thread count or chunk scheduling
+ * @param frame frame index
+ * @param pixel linear pixel index
+ * @param sample sample index within the pixel
+ */
+inline void seedSampleStream(uint32_t frame, uint32_t pixel, uint32_t sample) {
+	threadRng().seed(mixBits((static_cast<uint64_t>(frame) << 32) | pixel), sample);
+}
+
+inline float randomFloat() { return threadRng().nextFloat(); }
+
+inline Real randomFloat(Real min, Real max) { return min + (max - min) * randomFloat(); }
 
 inline int randomInt(int min, int max) { return static_cast<int>(randomFloat(min, max + 1)); }
 
-inline Eigen::Vector3d randomVec3() { return Eigen::Vector3d(randomFloat(), randomFloat(), randomFloat()); }
+inline Vec3 randomVec3() { return Vec3(randomFloat(), randomFloat(), randomFloat()); }
 
-inline Eigen::Vector3d randomVec3(float min, float max) {
-	return Eigen::Vector3d(randomFloat(min, max), randomFloat(min, max), randomFloat(min, max));
+inline Vec3 randomVec3(float min, float max) {
+	return Vec3(randomFloat(min, max), randomFloat(min, max), randomFloat(min, max));
 }
 
-inline Eigen::Vector3d randomVec3InUnitSphere() {
+inline Vec3 randomVec3InUnitSphere() {
 	while (true) {
 		auto p = randomVec3(-1, 1);
 		if (p.norm() >= 1)
@@ -148,18 +295,18 @@ inline Eigen::Vector3d randomVec3InUnitSphere() {
 	}
 }
 
-inline Eigen::Vector3d randomUnitVec3() { return randomVec3InUnitSphere().normalized(); }
+inline Vec3 randomUnitVec3() { return randomVec3InUnitSphere().normalized(); }
 
-inline Eigen::Vector3d randomVec3InUnitDisk() {
+inline Vec3 randomVec3InUnitDisk() {
 	while (true) {
-		auto p = Eigen::Vector3d{randomFloat(-1, 1), randomFloat(-1, 1), 0};
+		auto p = Vec3{randomFloat(-1, 1), randomFloat(-1, 1), 0};
 		if (p.norm() >= 1)
 			continue;
 		return p;
 	}
 }
 
-inline Eigen::Vector3d randomUnitVec3InHemiSphere(const Eigen::Vector3d &normal) {
+inline Vec3 randomUnitVec3InHemiSphere(const Vec3 &normal) {
 	auto in_unit_sphere = randomVec3InUnitSphere();
 	if (in_unit_sphere.dot(normal) > 0.0)
 		return in_unit_sphere;
@@ -167,41 +314,35 @@ inline Eigen::Vector3d randomUnitVec3InHemiSphere(const Eigen::Vector3d &normal)
 		return -in_unit_sphere;
 }
 
-inline Eigen::Vector3d reflect(const Eigen::Vector3d &v, const Eigen::Vector3d &n) { return v - 2 * v.dot(n) * n; }
+inline Vec3 reflect(const Vec3 &v, const Vec3 &n) { return v - 2 * v.dot(n) * n; }
 
-inline Eigen::Vector3d refract(const Eigen::Vector3d &uv, const Eigen::Vector3d &n, float etai_over_etat) {
+inline Vec3 refract(const Vec3 &uv, const Vec3 &n, float etai_over_etat) {
 	auto cos_theta = std::fmin(-uv.dot(n), 1.0);
-	Eigen::Vector3d r_out_perp = etai_over_etat * (uv + cos_theta * n);
-	Eigen::Vector3d r_out_parallel = -std::sqrt(std::fabs(1.0 - r_out_perp.norm())) * n;
+	Vec3 r_out_perp = etai_over_etat * (uv + cos_theta * n);
+	Vec3 r_out_parallel = -std::sqrt(std::fabs(1.0 - r_out_perp.norm())) * n;
 	return r_out_perp + r_out_parallel;
 }
 
-inline bool verySmall(const Eigen::Vector3d &v) {
+inline bool verySmall(const Vec3 &v) {
 	return (std::abs(v[0]) < EPS) && (std::abs(v[1]) < EPS) && (std::abs(v[2]) < EPS);
 }
 
-inline std::string makeColor(const Eigen::Vector3d &v) {
-	auto r = static_cast<int>(255.999 * v[0]);
-	auto g = static_cast<int>(255.999 * v[1]);
-	auto b = static_cast<int>(255.999 * v[2]);
-	return fmt::format("{} {} {}\n", r, g, b);
-}
-
-inline Eigen::Matrix4d makeEulerRotationMatrixAboutPt(const Point3 &pt, double psi, double theta, double phi) {
-	Eigen::AngleAxisd yaw(psi, Eigen::Vector3d::UnitZ());
-	Eigen::AngleAxisd pitch(theta, Eigen::Vector3d::UnitY());
-	Eigen::AngleAxisd roll(phi, Eigen::Vector3d::UnitX());
+inline Mat4 makeEulerRotationMatrixAboutPt(const Point3 &pt, Real psi, Real theta, Real phi) {
+	AngleAxis yaw(psi, Vec3::UnitZ());
+	AngleAxis pitch(theta, Vec3::UnitY());
+	AngleAxis roll(phi, Vec3::UnitX());
 
-	Eigen::Quaterniond q = yaw * pitch * roll;
-	auto translation = Eigen::Translation<double, 3>(pt.x(), pt.y(), pt.z());
-	Eigen::Affine3d affine = Eigen::Affine3d::Identity() * translation * q.toRotationMatrix() * translation.inverse();
+	Quat q = yaw * pitch * roll;
+	auto translation = Translation3(pt.x(), pt.y(), pt.z());
+	// Translation * Matrix3d would treat the columns as points, the quaternion composes as a rotation
+	Eigen::Transform<Real, 3, Eigen::Affine> affine = translation * q * translation.inverse();
 	return affine.matrix();
 }
 
-inline Eigen::Vector3d deHomo(const Eigen::Vector4d &p) {
-	return Eigen::Vector3d(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+inline Vec3 deHomo(const Vec4 &p) {
+	return Vec3(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
 }
 
-inline Eigen::Vector4d makeHomo(const Eigen::Vector3d &p) { return Eigen::Vector4d(p[0], p[1], p[2], 1); }
+inline Vec4 makeHomo(const Vec3 &p) { return Vec4(p[0], p[1], p[2], 1); }
 
 #endif // ONEWEEKEND_MATHUTIL_H
@@ -0,0 +1,32 @@
+/**
+ * @file MeshLoader.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief OBJ and PLY import backed by a memory mapped binary cache
+ */
+
+#ifndef RAYTRACING_MESHLOADER_H
+#define RAYTRACING_MESHLOADER_H
+
+#include <memory>
+#include <string>
+#include "Material.h"
+#include "TriangleMesh.h"
+
+/**
+ * load a Wavefront OBJ or a PLY (ascii or binary little endian) file as one mesh.
+ * the first load parses the file, builds the hierarchy and writes vertex buffers, triangles and nodes
+ * to filepath + ".hkmesh". later loads map that cache and hand its buffers straight to the mesh, so
+ * nothing is parsed or rebuilt. the cache is rewritten when the source file changes size or mtime
+ * @param filepath .obj or .ply file
+ * @param mat material of the whole mesh
+ * @return nullptr if the file cannot be read or parsed
+ */
+std::shared_ptr<TriangleMesh> loadMesh(const std::string &filepath, std::shared_ptr<IMaterial> mat);
+
+/**
+ * path of the cache loadMesh keeps next to filepath
+ */
+std::string meshCachePath(const std::string &filepath);
+
+#endif // RAYTRACING_MESHLOADER_H
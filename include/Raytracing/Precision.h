@@ -0,0 +1,62 @@
+/**
+ * @file Precision.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Scalar precision of the render core and the vector types built on it
+ */
+
+#ifndef RAYTRACING_PRECISION_H
+#define RAYTRACING_PRECISION_H
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+
+/**
+ * precision policy, the vector, matrix and transform types of one scalar type. geometry, shading and
+ * accumulation use Precision<Real>, kernels that are benchmarked in both precisions are templated on
+ * the scalar and take their types from here
+ */
+template<typename T>
+struct Precision {
+	using Scalar = T;
+	using Vec2 = Eigen::Matrix<T, 2, 1>;
+	using Vec3 = Eigen::Matrix<T, 3, 1>;
+	using Vec4 = Eigen::Matrix<T, 4, 1>;
+	using Mat3 = Eigen::Matrix<T, 3, 3>;
+	using Mat4 = Eigen::Matrix<T, 4, 4>;
+	using Affine3 = Eigen::Transform<T, 3, Eigen::AffineCompact>;
+	using Quat = Eigen::Quaternion<T>;
+	using AngleAxis = Eigen::AngleAxis<T>;
+	using Translation3 = Eigen::Translation<T, 3>;
+};
+
+/**
+ * RAYTRACING_SINGLE_PRECISION compiles the whole tracer in float, the default is double
+ */
+#if defined(RAYTRACING_SINGLE_PRECISION)
+using Real = float;
+#else
+using Real = double;
+#endif
+
+using Vec2 = Precision<Real>::Vec2;
+using Vec3 = Precision<Real>::Vec3;
+using Vec4 = Precision<Real>::Vec4;
+using Mat3 = Precision<Real>::Mat3;
+using Mat4 = Precision<Real>::Mat4;
+using Affine3 = Precision<Real>::Affine3;
+using Quat = Precision<Real>::Quat;
+using AngleAxis = Precision<Real>::AngleAxis;
+using Translation3 = Precision<Real>::Translation3;
+
+/**
+ * 16 byte aligned float lanes, a point or direction padded with w so one SSE register holds it
+ */
+using Float4 = Eigen::Vector4f;
+
+template<typename Derived>
+inline Float4 toFloat4(const Eigen::MatrixBase<Derived> &v, float w = 0) {
+	return Float4(static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]), w);
+}
+
+#endif // RAYTRACING_PRECISION_H
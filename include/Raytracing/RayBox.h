@@ -0,0 +1,194 @@
+/**
+ * @file RayBox.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Ray against axis aligned box kernels, one box scalar or SSE, two boxes AVX, four and eight boxes SoA
+ */
+
+#ifndef RAYTRACING_RAYBOX_H
+#define RAYTRACING_RAYBOX_H
+
+#include <cstdint>
+#include <limits>
+#include "MathUtil.h"
+#include "Simd.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * a ray as the box kernels want it: float origin and reciprocal direction padded to four lanes so they
+ * load into one SSE register, and the direction sign per axis as an index and as a lane mask. the
+ * padding lane has a NaN reciprocal, which makes it drop out of every slab reduction. built once per
+ * traversal
+ */
+struct alignas(16) SlabRay {
+	float origin[4];
+	float inv_dir[4];
+	// all bits set for a negative direction
+	uint32_t negative[4];
+	uint32_t sign[3];
+
+	explicit SlabRay(const Ray &r) {
+		for (int i = 0; i < 3; i++) {
+			origin[i] = static_cast<float>(r.pos()[i]);
+			inv_dir[i] = static_cast<float>(r.invDir()[i]);
+			sign[i] = r.sign(i);
+			negative[i] = sign[i] ? ~0u : 0u;
+		}
+		origin[3] = 0;
+		inv_dir[3] = std::numeric_limits<float>::quiet_NaN();
+		negative[3] = 0;
+	}
+};
+
+/**
+ * every kernel below gives the same answer bit for bit. the sign of the direction picks which bound is
+ * the entry and which the exit of each slab, a NaN slab distance (a ray lying in the plane of a face)
+ * never narrows the interval, and the box is hit when the entry is not after the exit. the packet test
+ * of LinearBVHNode follows the same rules
+ */
+
+/**
+ * one box, branchless scalar
+ * @param bounds min x y z followed by max x y z, the layout of LinearBVHNode
+ */
+inline bool rayBoxScalar(const SlabRay &r, const float *bounds, float t_min, float t_max) {
+	for (int i = 0; i < 3; i++) {
+		float near = (bounds[3 * r.sign[i] + i] - r.origin[i]) * r.inv_dir[i];
+		float far = (bounds[3 - 3 * r.sign[i] + i] - r.origin[i]) * r.inv_dir[i];
+		t_min = near > t_min ? near : t_min;
+		t_max = far < t_max ? far : t_max;
+	}
+	return t_min <= t_max;
+}
+
+#if defined(__SSE2__)
+namespace raybox_detail {
+	/**
+	 * entry distances of the slabs in the low three lanes of near, exit distances in far
+	 */
+	inline void slabs(const SlabRay &r, __m128 lo, __m128 hi, __m128 &near, __m128 &far) {
+		auto origin = _mm_load_ps(r.origin);
+		auto inv_dir = _mm_load_ps(r.inv_dir);
+		auto negative = _mm_load_ps(reinterpret_cast<const float *>(r.negative));
+		auto entry = _mm_or_ps(_mm_and_ps(negative, hi), _mm_andnot_ps(negative, lo));
+		auto exit = _mm_or_ps(_mm_and_ps(negative, lo), _mm_andnot_ps(negative, hi));
+		near = _mm_mul_ps(_mm_sub_ps(entry, origin), inv_dir);
+		far = _mm_mul_ps(_mm_sub_ps(exit, origin), inv_dir);
+	}
+} // namespace raybox_detail
+#endif
+
+/**
+ * one box, the three slabs in one SSE register. falls back to rayBoxScalar without SSE
+ * @param bounds min x y z followed by max x y z, readable for 7 floats
+ */
+inline bool rayBoxSse(const SlabRay &r, const float *bounds, float t_min, float t_max) {
+#if defined(__SSE2__)
+	__m128 near, far;
+	raybox_detail::slabs(r, _mm_loadu_ps(bounds), _mm_loadu_ps(bounds + 3), near, far);
+	// max and min return their second operand for NaN, so NaN slabs and the padding lane fall back to
+	// the ray interval
+	near = _mm_max_ps(near, _mm_set1_ps(t_min));
+	far = _mm_min_ps(far, _mm_set1_ps(t_max));
+	near = _mm_max_ps(near, _mm_shuffle_ps(near, near, _MM_SHUFFLE(1, 0, 3, 2)));
+	near = _mm_max_ps(near, _mm_shuffle_ps(near, near, _MM_SHUFFLE(2, 3, 0, 1)));
+	far = _mm_min_ps(far, _mm_shuffle_ps(far, far, _MM_SHUFFLE(1, 0, 3, 2)));
+	far = _mm_min_ps(far, _mm_shuffle_ps(far, far, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_comile_ss(near, far);
+#else
+	return rayBoxScalar(r, bounds, t_min, t_max);
+#endif
+}
+
+/**
+ * two boxes at once, one per 128 bit half of an AVX register, like the two children of a binary node.
+ * falls back to rayBoxSse per box without AVX
+ * @return bit i set if box i is hit
+ */
+inline uint32_t rayBox2(const SlabRay &r, const float *bounds0, const float *bounds1, float t_min, float t_max) {
+#if defined(__AVX__)
+	__m128 near0, far0, near1, far1;
+	raybox_detail::slabs(r, _mm_loadu_ps(bounds0), _mm_loadu_ps(bounds0 + 3), near0, far0);
+	raybox_detail::slabs(r, _mm_loadu_ps(bounds1), _mm_loadu_ps(bounds1 + 3), near1, far1);
+	auto near = _mm256_max_ps(_mm256_set_m128(near1, near0), _mm256_set1_ps(t_min));
+	auto far = _mm256_min_ps(_mm256_set_m128(far1, far0), _mm256_set1_ps(t_max));
+	// reduce within each half, the two boxes never mix
+	near = _mm256_max_ps(near, _mm256_permute_ps(near, _MM_SHUFFLE(1, 0, 3, 2)));
+	near = _mm256_max_ps(near, _mm256_permute_ps(near, _MM_SHUFFLE(2, 3, 0, 1)));
+	far = _mm256_min_ps(far, _mm256_permute_ps(far, _MM_SHUFFLE(1, 0, 3, 2)));
+	far = _mm256_min_ps(far, _mm256_permute_ps(far, _MM_SHUFFLE(2, 3, 0, 1)));
+	auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(near, far, _CMP_LE_OQ)));
+	return (mask & 1u) | ((mask >> 3) & 2u);
+#else
+	return static_cast<uint32_t>(rayBoxSse(r, bounds0, t_min, t_max)) |
+		   static_cast<uint32_t>(rayBoxSse(r, bounds1, t_min, t_max)) << 1;
+#endif
+}
+
+/**
+ * four boxes stored structure of arrays, bounds_min[axis][box], the node layout of a 4 wide BVH
+ * @param near entry distance of every box that is hit
+ * @return bit i set if box i is hit
+ */
+inline uint32_t rayBox4(const SlabRay &r, const float (*bounds_min)[4], const float (*bounds_max)[4], float t_min,
+						float t_max, float near[4]) {
+#if defined(__SSE2__)
+	auto t_near = _mm_set1_ps(t_min);
+	auto t_far = _mm_set1_ps(t_max);
+	for (int i = 0; i < 3; i++) {
+		auto o = _mm_set1_ps(r.origin[i]);
+		auto inv = _mm_set1_ps(r.inv_dir[i]);
+		// with the sign known per ray the entry and exit bounds are picked without a min/max
+		auto entry = _mm_load_ps(r.sign[i] ? bounds_max[i] : bounds_min[i]);
+		auto exit = _mm_load_ps(r.sign[i] ? bounds_min[i] : bounds_max[i]);
+		t_near = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(entry, o), inv), t_near);
+		t_far = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(exit, o), inv), t_far);
+	}
+	_mm_storeu_ps(near, t_near);
+	return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(t_near, t_far)));
+#else
+	uint32_t mask = 0;
+	for (int box = 0; box < 4; box++) {
+		float t_near = t_min, t_far = t_max;
+		for (int i = 0; i < 3; i++) {
+			float entry = ((r.sign[i] ? bounds_max : bounds_min)[i][box] - r.origin[i]) * r.inv_dir[i];
+			float exit = ((r.sign[i] ? bounds_min : bounds_max)[i][box] - r.origin[i]) * r.inv_dir[i];
+			t_near = entry > t_near ? entry : t_near;
+			t_far = exit < t_far ? exit : t_far;
+		}
+		near[box] = t_near;
+		mask |= t_near <= t_far ? 1u << box : 0u;
+	}
+	return mask;
+#endif
+}
+
+/**
+ * eight boxes stored structure of arrays, the node layout of an 8 wide BVH. one AVX register per
+ * slab, two SSE registers or plain loops on smaller targets
+ * @param near entry distance of every box that is hit
+ * @return bit i set if box i is hit
+ */
+inline uint32_t rayBox8(const SlabRay &r, const float (*bounds_min)[8], const float (*bounds_max)[8], float t_min,
+						float t_max, float near[8]) {
+	auto t_near = Float8::broadcast(t_min);
+	auto t_far = Float8::broadcast(t_max);
+	for (int i = 0; i < 3; i++) {
+		auto o = Float8::broadcast(r.origin[i]);
+		auto inv = Float8::broadcast(r.inv_dir[i]);
+		auto entry = Float8::load(r.sign[i] ? bounds_max[i] : bounds_min[i]);
+		auto exit = Float8::load(r.sign[i] ? bounds_min[i] : bounds_max[i]);
+		t_near = max((entry - o) * inv, t_near);
+		t_far = min((exit - o) * inv, t_far);
+	}
+	alignas(32) float out[8];
+	t_near.store(out);
+	for (int i = 0; i < 8; i++)
+		near[i] = out[i];
+	return (t_near <= t_far).bits();
+}
+
+#endif // RAYTRACING_RAYBOX_H
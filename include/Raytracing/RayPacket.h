@@ -0,0 +1,46 @@
+/**
+ * @file RayPacket.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief A bundle of coherent rays traced together
+ */
+
+#ifndef RAYTRACING_RAYPACKET_H
+#define RAYTRACING_RAYPACKET_H
+
+#include <bit>
+#include <cstdint>
+#include "MathUtil.h"
+#include "Simd.h"
+
+/**
+ * rays of one packet stored lane by lane in float, next to the original double precision rays.
+ * the float copies are only used to cull boxes and primitives, every hit is confirmed by the scalar
+ * intersection code on the original ray so packets and single rays produce identical records.
+ */
+struct alignas(32) RayPacket {
+	static constexpr int size = Float8::width;
+
+	float ox[size], oy[size], oz[size];
+	float dx[size], dy[size], dz[size];
+	float inv_x[size], inv_y[size], inv_z[size];
+	// closest hit found so far for every lane
+	float t_max[size];
+	Ray rays[size];
+	// lanes holding a ray
+	uint32_t active = 0;
+
+	void set(int lane, const Ray &ray, float t_max = INF);
+};
+
+/**
+ * call func(lane) for every set bit of the lane mask
+ */
+template<typename F>
+inline void forEachLane(uint32_t lanes, F &&func) {
+	for (; lanes != 0; lanes &= lanes - 1) {
+		func(std::countr_zero(lanes));
+	}
+}
+
+#endif // RAYTRACING_RAYPACKET_H
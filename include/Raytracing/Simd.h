@@ -0,0 +1,216 @@
+/**
+ * @file Simd.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Eight lane float vector for packet tracing, AVX, SSE or plain loops depending on the target
+ */
+
+#ifndef RAYTRACING_SIMD_H
+#define RAYTRACING_SIMD_H
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX__)
+#define RAYTRACING_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define RAYTRACING_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+/**
+ * per lane comparison result, bits() packs it into the low 8 bits of an integer
+ */
+class Mask8 {
+public:
+#if defined(RAYTRACING_SIMD_AVX)
+	__m256 v;
+
+	uint32_t bits() const { return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+
+	Mask8 operator&(const Mask8 &o) const { return {_mm256_and_ps(v, o.v)}; }
+
+	Mask8 operator|(const Mask8 &o) const { return {_mm256_or_ps(v, o.v)}; }
+#elif defined(RAYTRACING_SIMD_SSE)
+	__m128 lo, hi;
+
+	uint32_t bits() const {
+		return static_cast<uint32_t>(_mm_movemask_ps(lo) | (_mm_movemask_ps(hi) << 4));
+	}
+
+	Mask8 operator&(const Mask8 &o) const { return {_mm_and_ps(lo, o.lo), _mm_and_ps(hi, o.hi)}; }
+
+	Mask8 operator|(const Mask8 &o) const { return {_mm_or_ps(lo, o.lo), _mm_or_ps(hi, o.hi)}; }
+#else
+	uint32_t m;
+
+	uint32_t bits() const { return m; }
+
+	Mask8 operator&(const Mask8 &o) const { return {m & o.m}; }
+
+	Mask8 operator|(const Mask8 &o) const { return {m | o.m}; }
+#endif
+};
+
+/**
+ * min and max follow the SSE convention, min(a, b) is a < b ? a : b, so a NaN in a yields b.
+ * callers rely on this to reproduce the scalar slab test exactly. select(m, a, b) is m ? a : b per lane
+ */
+class Float8 {
+public:
+	static constexpr int width = 8;
+
+#if defined(RAYTRACING_SIMD_AVX)
+	__m256 v;
+
+	static Float8 load(const float *p) { return {_mm256_load_ps(p)}; }
+
+	static Float8 broadcast(float x) { return {_mm256_set1_ps(x)}; }
+
+	void store(float *p) const { _mm256_store_ps(p, v); }
+
+	Float8 operator+(const Float8 &o) const { return {_mm256_add_ps(v, o.v)}; }
+
+	Float8 operator-(const Float8 &o) const { return {_mm256_sub_ps(v, o.v)}; }
+
+	Float8 operator*(const Float8 &o) const { return {_mm256_mul_ps(v, o.v)}; }
+
+	Float8 operator/(const Float8 &o) const { return {_mm256_div_ps(v, o.v)}; }
+
+	Mask8 operator<(const Float8 &o) const { return {_mm256_cmp_ps(v, o.v, _CMP_LT_OQ)}; }
+
+	Mask8 operator<=(const Float8 &o) const { return {_mm256_cmp_ps(v, o.v, _CMP_LE_OQ)}; }
+
+	Mask8 operator>(const Float8 &o) const { return {_mm256_cmp_ps(v, o.v, _CMP_GT_OQ)}; }
+
+	Mask8 operator>=(const Float8 &o) const { return {_mm256_cmp_ps(v, o.v, _CMP_GE_OQ)}; }
+
+	friend Float8 min(const Float8 &a, const Float8 &b) { return {_mm256_min_ps(a.v, b.v)}; }
+
+	friend Float8 max(const Float8 &a, const Float8 &b) { return {_mm256_max_ps(a.v, b.v)}; }
+
+	friend Float8 sqrt(const Float8 &a) { return {_mm256_sqrt_ps(a.v)}; }
+
+	friend Float8 abs(const Float8 &a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+
+	friend Float8 select(const Mask8 &m, const Float8 &a, const Float8 &b) { return {_mm256_blendv_ps(b.v, a.v, m.v)}; }
+#elif defined(RAYTRACING_SIMD_SSE)
+	__m128 lo, hi;
+
+	static Float8 load(const float *p) { return {_mm_load_ps(p), _mm_load_ps(p + 4)}; }
+
+	static Float8 broadcast(float x) { return {_mm_set1_ps(x), _mm_set1_ps(x)}; }
+
+	void store(float *p) const {
+		_mm_store_ps(p, lo);
+		_mm_store_ps(p + 4, hi);
+	}
+
+	Float8 operator+(const Float8 &o) const { return {_mm_add_ps(lo, o.lo), _mm_add_ps(hi, o.hi)}; }
+
+	Float8 operator-(const Float8 &o) const { return {_mm_sub_ps(lo, o.lo), _mm_sub_ps(hi, o.hi)}; }
+
+	Float8 operator*(const Float8 &o) const { return {_mm_mul_ps(lo, o.lo), _mm_mul_ps(hi, o.hi)}; }
+
+	Float8 operator/(const Float8 &o) const { return {_mm_div_ps(lo, o.lo), _mm_div_ps(hi, o.hi)}; }
+
+	Mask8 operator<(const Float8 &o) const { return {_mm_cmplt_ps(lo, o.lo), _mm_cmplt_ps(hi, o.hi)}; }
+
+	Mask8 operator<=(const Float8 &o) const { return {_mm_cmple_ps(lo, o.lo), _mm_cmple_ps(hi, o.hi)}; }
+
+	Mask8 operator>(const Float8 &o) const { return {_mm_cmpgt_ps(lo, o.lo), _mm_cmpgt_ps(hi, o.hi)}; }
+
+	Mask8 operator>=(const Float8 &o) const { return {_mm_cmpge_ps(lo, o.lo), _mm_cmpge_ps(hi, o.hi)}; }
+
+	friend Float8 min(const Float8 &a, const Float8 &b) { return {_mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi)}; }
+
+	friend Float8 max(const Float8 &a, const Float8 &b) { return {_mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi)}; }
+
+	friend Float8 sqrt(const Float8 &a) { return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)}; }
+
+	friend Float8 abs(const Float8 &a) {
+		auto sign = _mm_set1_ps(-0.0f);
+		return {_mm_andnot_ps(sign, a.lo), _mm_andnot_ps(sign, a.hi)};
+	}
+
+	friend Float8 select(const Mask8 &m, const Float8 &a, const Float8 &b) {
+		return {_mm_or_ps(_mm_and_ps(m.lo, a.lo), _mm_andnot_ps(m.lo, b.lo)),
+				_mm_or_ps(_mm_and_ps(m.hi, a.hi), _mm_andnot_ps(m.hi, b.hi))};
+	}
+#else
+	float v[width];
+
+	static Float8 load(const float *p) {
+		Float8 r;
+		for (int i = 0; i < width; i++)
+			r.v[i] = p[i];
+		return r;
+	}
+
+	static Float8 broadcast(float x) {
+		Float8 r;
+		for (float &lane: r.v)
+			lane = x;
+		return r;
+	}
+
+	void store(float *p) const {
+		for (int i = 0; i < width; i++)
+			p[i] = v[i];
+	}
+
+	template<typename F>
+	Float8 map(const Float8 &o, F f) const {
+		Float8 r;
+		for (int i = 0; i < width; i++)
+			r.v[i] = f(v[i], o.v[i]);
+		return r;
+	}
+
+	template<typename F>
+	Mask8 compare(const Float8 &o, F f) const {
+		Mask8 r{0};
+		for (int i = 0; i < width; i++)
+			r.m |= f(v[i], o.v[i]) ? 1u << i : 0u;
+		return r;
+	}
+
+	Float8 operator+(const Float8 &o) const { return map(o, [](float a, float b) { return a + b; }); }
+
+	Float8 operator-(const Float8 &o) const { return map(o, [](float a, float b) { return a - b; }); }
+
+	Float8 operator*(const Float8 &o) const { return map(o, [](float a, float b) { return a * b; }); }
+
+	Float8 operator/(const Float8 &o) const { return map(o, [](float a, float b) { return a / b; }); }
+
+	Mask8 operator<(const Float8 &o) const { return compare(o, [](float a, float b) { return a < b; }); }
+
+	Mask8 operator<=(const Float8 &o) const { return compare(o, [](float a, float b) { return a <= b; }); }
+
+	Mask8 operator>(const Float8 &o) const { return compare(o, [](float a, float b) { return a > b; }); }
+
+	Mask8 operator>=(const Float8 &o) const { return compare(o, [](float a, float b) { return a >= b; }); }
+
+	friend Float8 min(const Float8 &a, const Float8 &b) {
+		return a.map(b, [](float x, float y) { return x < y ? x : y; });
+	}
+
+	friend Float8 max(const Float8 &a, const Float8 &b) {
+		return a.map(b, [](float x, float y) { return x > y ? x : y; });
+	}
+
+	friend Float8 sqrt(const Float8 &a) { return a.map(a, [](float x, float) { return std::sqrt(x); }); }
+
+	friend Float8 abs(const Float8 &a) { return a.map(a, [](float x, float) { return std::fabs(x); }); }
+
+	friend Float8 select(const Mask8 &m, const Float8 &a, const Float8 &b) {
+		Float8 r;
+		for (int i = 0; i < width; i++)
+			r.v[i] = (m.m >> i) & 1u ? a.v[i] : b.v[i];
+		return r;
+	}
+#endif
+};
+
+#endif // RAYTRACING_SIMD_H
@@ -0,0 +1,109 @@
+/**
+ * @file SpherePool.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Many spheres in one primitive, stored as arrays and tested eight at a time
+ */
+
+#ifndef RAYTRACING_SPHEREPOOL_H
+#define RAYTRACING_SPHEREPOOL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BVH.h"
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+#include "RayPacket.h"
+
+/**
+ * replaces scenes full of individual Sphere objects. the pool keeps its own hierarchy whose leaves
+ * are blocks of up to eight spheres laid out as structure of arrays, so a ray is tested against a
+ * whole leaf with one float vector pass. spheres that pass that test are confirmed with
+ * Sphere::intersect, which makes the records exactly the ones separate Sphere objects produce.
+ * the pool is an ordinary IHittable and can sit inside a BVHNode next to other primitives
+ */
+class SpherePool : public IHittable {
+public:
+	SpherePool() = default;
+
+	void add(const Point3 &center, Real radius, const std::shared_ptr<IMaterial> &mat);
+
+	/**
+	 * sphere moving from init_center at time 0 to final_center at time 1
+	 */
+	void add(const Point3 &init_center, const Point3 &final_center, Real radius,
+			 const std::shared_ptr<IMaterial> &mat);
+
+	/**
+	 * build the hierarchy over everything added so far, call it before rendering
+	 */
+	void build();
+
+	size_t size() const;
+
+	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	AABB boundingBox() const override;
+
+	/**
+	 * every static emissive sphere of the pool, as the Sphere it stands for
+	 */
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	static constexpr int block_size = Float8::width;
+
+private:
+	struct alignas(32) SphereBlock {
+		float x[block_size];
+		float y[block_size];
+		float z[block_size];
+		float motion_x[block_size];
+		float motion_y[block_size];
+		float motion_z[block_size];
+		float radius[block_size];
+		// largest coordinate magnitude the sphere reaches, scales the rounding error of the float test
+		float magnitude[block_size];
+		bool moving;
+	};
+
+	/**
+	 * the ray in float, computed once per traversal
+	 */
+	struct FloatRay {
+		float origin[3];
+		float dir[3];
+		float time;
+		float inv_a;
+		float inv_length;
+		float magnitude;
+
+		explicit FloatRay(const Ray &r);
+	};
+
+	/**
+	 * spheres of a block the ray may hit inside interval, a superset of the real hits
+	 */
+	static uint32_t candidates(const SphereBlock &block, const FloatRay &ray, Interval interval);
+
+	bool hitBlock(uint32_t block_idx, uint32_t count, const Ray &r, const FloatRay &ray, Interval &interval,
+				  HitRecord &record) const;
+
+	bool traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const;
+
+	std::vector<Point3> centers;
+	std::vector<Vec3> motions;
+	std::vector<Real> radii;
+	std::vector<uint32_t> material_ids;
+	std::vector<SphereBlock> blocks;
+	// slot i of the blocks holds sphere slot_sphere[i]
+	std::vector<uint32_t> slot_sphere;
+	std::vector<LinearBVHNode> nodes;
+	// a Sphere for each static emissive sphere, only ever sampled by LightList, never traced
+	std::vector<std::shared_ptr<Sphere>> lights;
+	AABB bbox;
+};
+
+#endif // RAYTRACING_SPHEREPOOL_H
@@ -10,6 +10,7 @@
 
 #include "ImageUtil.h"
 #include "MathUtil.h"
+#include "TextureCache.h"
 class ITexture {
 public:
 	virtual ~ITexture() = default;
@@ -26,6 +27,8 @@ public:
 	Color value(float u, float v, const Point3 &p) const override;
 
 private:
+	friend class MaterialRegistry;
+
 	Color color_val;
 };
 
@@ -37,20 +40,48 @@ public:
 
 	Color value(float u, float v, const Point3 &p) const override;
 
+	/**
+	 * whether u, v falls on an even square, shared with the flattened checker of MaterialRegistry
+	 */
+	static bool isEven(float inv_scale, float u, float v) {
+		auto u_int = static_cast<int>(u * 50 * inv_scale);
+		auto v_int = static_cast<int>(v * 50 * inv_scale);
+		return (u_int + v_int) % 2 == 0;
+	}
+
 private:
+	friend class MaterialRegistry;
+
 	float inv_scale;
 	std::shared_ptr<ITexture> even;
 	std::shared_ptr<ITexture> odd;
 };
 
+/**
+ * an image paged through TextureCache, the decoded pixels are not kept by the texture
+ */
 class ImageTexture : public ITexture {
 public:
-	ImageTexture(const std::string &image, const std::string &parent = IMG_INPUT_DIR);
-
+	/**
+	 * @param srgb decode the image with the sRGB curve. off by default, dividing the bytes by 255 keeps the
+	 * brightness the scenes were set up with
+	 */
+	ImageTexture(const std::string &image, const std::string &parent = IMG_INPUT_DIR,
+				 TextureFilter filter = TEXTURE_FILTER_BILINEAR, bool srgb = false);
+
+	/**
+	 * hits carry no footprint, so trilinear filtering reads the finest level here
+	 */
 	Color value(float u, float v, const Point3 &p) const override;
 
+	/**
+	 * @param width filter width in uv units, only used by trilinear filtering
+	 */
+	Color filtered(float u, float v, float width) const;
+
 private:
-	Image img;
+	uint32_t texture_id;
+	TextureFilter filter;
 };
 
 class NoiseTexture : public ITexture {
@@ -59,11 +90,13 @@ public:
 
 	Color value(float u, float v, const Point3 &p) const override;
 
+	/**
+	 * see OctaveNoise::bake, for a texture that only ever gets looked up inside bounds
+	 */
+	void bake(const AABB &bounds, int resolution);
+
 private:
-	Perlin noise;
-	float frequency;
-	int octave_count;
-	float persistence;
+	OctaveNoise noise;
 };
 
 class TerrainTexture : public ITexture {
@@ -72,11 +105,13 @@ public:
 
 	Color value(float u, float v, const Point3 &p) const override;
 
+	/**
+	 * see OctaveNoise::bake, for a texture that only ever gets looked up inside bounds
+	 */
+	void bake(const AABB &bounds, int resolution);
+
 private:
-	Perlin noise;
-	float frequency;
-	int octave_count;
-	float persistence;
+	OctaveNoise noise;
 };
 
 #endif // RAYTRACING_TEXTURE_H
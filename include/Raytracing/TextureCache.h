@@ -0,0 +1,141 @@
+/**
+ * @file TextureCache.h
+ * @author ayano
+ * @date 10/18/26
+ * @brief Tiled mip pyramids of image textures, paged in by a bounded LRU tile cache
+ */
+
+#ifndef RAYTRACING_TEXTURECACHE_H
+#define RAYTRACING_TEXTURECACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "MathUtil.h"
+
+using Color = Vec3;
+
+/**
+ * 8 * 8 linear RGB texels, row major inside the tile. a bilinear footprint almost always falls inside
+ * one tile, so a lookup touches one 768 byte block instead of two scanlines of the image
+ */
+struct TextureTile {
+	static constexpr int size = 8;
+
+	float texels[size * size * 3];
+};
+
+enum TextureFilter : uint8_t {
+	TEXTURE_FILTER_NEAREST,
+	TEXTURE_FILTER_BILINEAR,
+	// bilinear on the two mip levels around the filter width, blended
+	TEXTURE_FILTER_TRILINEAR,
+};
+
+/**
+ * every image texture of the process. add() decodes an 8 bit RGB image to linear float, builds its mip
+ * pyramid with a 2 * 2 box filter and writes it tile by tile to an anonymous temporary file, the
+ * decoded image is not kept. lookups page tiles back in on demand and keep at most budget bytes of
+ * them, least recently used first out, so the resident size does not grow with the textures of the
+ * scene. the cache is split into shards with their own lock and LRU list, and every thread keeps the 256
+ * tiles it read last on top, which is where most lookups land. those are outside the budget
+ */
+class TextureCache {
+public:
+	/**
+	 * lookups served by the few tiles every thread keeps never reach the shards and are not counted
+	 */
+	struct Stats {
+		uint64_t hits;
+		uint64_t misses;
+		size_t resident_bytes;
+	};
+
+	static TextureCache &instance();
+
+	~TextureCache();
+
+	/**
+	 * @param rgb width * height pixels, 3 bytes each, row major from the top
+	 * @param srgb decode the bytes with the sRGB curve instead of dividing by 255
+	 * @return id of the texture
+	 */
+	uint32_t add(const unsigned char *rgb, int width, int height, bool srgb = false);
+
+	/**
+	 * shrink or grow the tile budget, evicting right away if it shrinks
+	 */
+	void setBudget(size_t bytes);
+
+	size_t getBudget() const;
+
+	/**
+	 * drop every resident tile, the ones every thread keeps included, and reset the counters, the
+	 * textures stay
+	 */
+	void clear();
+
+	Stats stats() const;
+
+	int levels(uint32_t id) const;
+
+	/**
+	 * u and v in [0, 1] with v = 0 at the bottom of the image, clamped at the edges
+	 */
+	Color nearest(uint32_t id, int level, float u, float v) const;
+
+	Color bilinear(uint32_t id, int level, float u, float v) const;
+
+	/**
+	 * @param width filter width in uv units, picks the pair of levels whose texels are about that size
+	 */
+	Color trilinear(uint32_t id, float u, float v, float width) const;
+
+private:
+	struct Level {
+		int width;
+		int height;
+		int tiles_x;
+		// index of the first tile of the level in the file of the texture
+		uint32_t first_tile;
+	};
+
+	struct Texture {
+		std::vector<Level> levels;
+		std::FILE *file;
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::list<std::pair<uint64_t, std::shared_ptr<const TextureTile>>> lru;
+		std::unordered_map<uint64_t, decltype(lru)::iterator> tiles;
+		size_t capacity;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+	};
+
+	static constexpr int shard_count = 16;
+
+	TextureCache();
+
+	/**
+	 * texel x, y of a level, both already clamped
+	 */
+	Color texel(uint32_t id, const Level &level, int x, int y) const;
+
+	std::shared_ptr<const TextureTile> tile(uint32_t id, uint32_t index) const;
+
+	std::shared_ptr<const TextureTile> load(const Texture &texture, uint32_t index) const;
+
+	std::mutex add_mutex;
+	// like the material table, filled while the scene is built and read without a lock while rendering
+	std::vector<std::unique_ptr<Texture>> textures;
+	mutable Shard shards[shard_count];
+	size_t budget;
+};
+
+#endif // RAYTRACING_TEXTURECACHE_H
@@ -0,0 +1,64 @@
+/**
+ * @file TileScheduler.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Lock-free work stealing scheduler handing out image tiles to render threads
+ */
+
+#ifndef RAYTRACING_TILESCHEDULER_H
+#define RAYTRACING_TILESCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ImageUtil.h"
+
+/**
+ * tiles are laid out along a hilbert curve so consecutive tiles are spatial neighbours, then every
+ * worker owns one contiguous run of that curve. a worker pops tiles from the front of its own run
+ * and, once it runs dry, steals the back half of another worker's remaining run.
+ * each run is a packed [begin, end) pair inside one atomic word, so popping and stealing are
+ * both a single compare-and-swap and no lock is ever taken.
+ */
+class TileScheduler {
+public:
+	TileScheduler(int width, int height, int tile_dimension, int worker_count);
+
+	/**
+	 * fetch the next tile for a worker
+	 * @param worker index of the calling worker, in [0, worker_count)
+	 * @param chunk receives the tile
+	 * @return false once every tile has been handed out
+	 */
+	bool next(int worker, ImageChunk &chunk);
+
+	int tileCount() const;
+
+	int workerCount() const;
+
+	uint64_t stealCount() const;
+
+	/**
+	 * position of a tile on a hilbert curve filling a square grid of side n, n must be a power of two
+	 */
+	static uint32_t hilbertIndex(uint32_t n, uint32_t x, uint32_t y);
+
+private:
+	struct alignas(64) WorkerRange {
+		std::atomic<uint64_t> range;
+	};
+
+	static uint64_t pack(uint32_t begin, uint32_t end);
+
+	bool pop(int worker, ImageChunk &chunk);
+
+	bool steal(int worker, ImageChunk &chunk);
+
+	std::vector<ImageChunk> tiles;
+	std::unique_ptr<WorkerRange[]> ranges;
+	int worker_count;
+	std::atomic<uint64_t> steals = 0;
+};
+
+#endif // RAYTRACING_TILESCHEDULER_H
@@ -0,0 +1,141 @@
+/**
+ * @file TriangleMesh.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Indexed triangle mesh with shared vertex buffers and its own hierarchy
+ */
+
+#ifndef RAYTRACING_TRIANGLEMESH_H
+#define RAYTRACING_TRIANGLEMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "BVH.h"
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+#include "RayPacket.h"
+
+/**
+ * a triangle is three indices into the vertex buffers, twelve bytes
+ */
+struct MeshTriangle {
+	uint32_t v[3];
+};
+
+static_assert(sizeof(MeshTriangle) == 12, "MeshTriangle should stay three indices");
+
+/**
+ * everything a mesh intersects against, the triangles already in the leaf order of the hierarchy.
+ * the buffers may live in the mesh itself or in memory it only borrows, such as a mapped cache file
+ */
+struct MeshView {
+	std::span<const Eigen::Vector3f> positions;
+	// empty for flat shading
+	std::span<const Eigen::Vector3f> normals;
+	// empty to use the barycentric coordinates
+	std::span<const Eigen::Vector2f> uvs;
+	std::span<const MeshTriangle> triangles;
+	std::span<const LinearBVHNode> nodes;
+	AABB bounds;
+};
+
+/**
+ * many triangles sharing one material. vertices are stored once in float buffers and triangles
+ * refer to them by index, the mesh keeps a flattened hierarchy over its triangles whose leaves index
+ * the triangle array directly. triangles are intersected with the watertight test of Woop et al.,
+ * rays through a shared edge or vertex never slip between the two triangles meeting there
+ */
+class TriangleMesh : public IHittable {
+public:
+	/**
+	 * @param positions vertex positions
+	 * @param indices three vertex indices per triangle, counter clockwise seen from the front
+	 * @param mat material of the whole mesh
+	 * @param normals per vertex shading normals, empty for flat shading
+	 * @param uvs per vertex texture coordinates, empty to use the barycentric coordinates
+	 */
+	TriangleMesh(std::vector<Eigen::Vector3f> positions, const std::vector<uint32_t> &indices,
+				 std::shared_ptr<IMaterial> mat, std::vector<Eigen::Vector3f> normals = {},
+				 std::vector<Eigen::Vector2f> uvs = {});
+
+	/**
+	 * mesh over prebuilt buffers, nothing is copied or rebuilt
+	 * @param storage keeps the memory behind view alive as long as the mesh
+	 */
+	TriangleMesh(const MeshView &view, std::shared_ptr<const void> storage, std::shared_ptr<IMaterial> mat);
+
+	const MeshView &view() const;
+
+	size_t triangleCount() const;
+
+	size_t vertexCount() const;
+
+	/**
+	 * bytes of the vertex buffers, the triangles and the hierarchy
+	 */
+	size_t memoryUsage() const;
+
+	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+
+	uint32_t hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const override;
+
+	AABB boundingBox() const override;
+
+	/**
+	 * an emissive mesh is one light, however many triangles it has
+	 */
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	/**
+	 * uniform over the area of the mesh, the triangle is picked in proportion to its area
+	 */
+	Vec3 sampleDirection(const Point3 &origin) const override;
+
+	/**
+	 * sums the density of every point of the mesh along direction, a point hidden behind another part of
+	 * the mesh is sampled as well. costs one traversal per crossing, not one test per triangle
+	 */
+	float directionPdf(const Point3 &origin, const Vec3 &direction) const override;
+
+private:
+	/**
+	 * the ray moved to the origin and sheared so it points down +z, computed once per traversal. the
+	 * watertight test stays in double whatever Real is, it has no error bounds to make it hold in float
+	 */
+	struct ShearedRay {
+		Eigen::Vector3d origin;
+		int kx, ky, kz;
+		double sx, sy, sz;
+
+		explicit ShearedRay(const Ray &r);
+	};
+
+	bool hitTriangle(uint32_t triangle, const Ray &r, const ShearedRay &ray, Interval &interval,
+					 HitRecord &record) const;
+
+	bool hitLeaf(const LinearBVHNode &node, const Ray &r, const ShearedRay &ray, Interval &interval,
+				 HitRecord &record) const;
+
+	bool traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const;
+
+	/**
+	 * closest triangle the ray hits inside interval, its index in triangle
+	 */
+	bool hitIndex(const Ray &r, Interval interval, HitRecord &record, uint32_t &triangle) const;
+
+	/**
+	 * fill area_cdf if the material emits, called once the view is set
+	 */
+	void makeLightDistribution();
+
+	MeshView mesh;
+	std::shared_ptr<const void> storage;
+	uint32_t material_id;
+	// running sum of the triangle areas, empty unless the mesh emits
+	std::vector<Real> area_cdf;
+};
+
+#endif // RAYTRACING_TRIANGLEMESH_H
@@ -0,0 +1,75 @@
+/**
+ * @file Wavefront.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief Breadth first path tracing, one bounce of a whole batch of paths at a time
+ */
+
+#ifndef RAYTRACING_WAVEFRONT_H
+#define RAYTRACING_WAVEFRONT_H
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "Framebuffer.h"
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+
+class Camera;
+
+/**
+ * instead of following one sample to the end before starting the next, every bounce runs as separate
+ * stages over a batch of paths: intersect all of them, bin the hits by material, shade each bin in one
+ * loop, then compact the surviving paths into the next wave. every path carries its own random state,
+ * so a pixel sees the same random decisions as with Camera's recursive integrator.
+ * one instance per worker thread, the buffers are reused from tile to tile.
+ */
+class WavefrontIntegrator {
+public:
+	explicit WavefrontIntegrator(size_t batch_size = 16384);
+
+	/**
+	 * add samples [first_sample, first_sample + samples) of every pixel of the tile
+	 */
+	void renderTile(Camera &camera, const IHittable &world, FramebufferTile &tile, int first_sample, int samples);
+
+private:
+	struct PathState {
+		Ray ray;
+		Color throughput;
+		Pcg32 rng;
+		// pixel index inside the tile
+		uint32_t pixel;
+	};
+
+	struct HitBin {
+		// MaterialType of the material, so every bin runs a single case of the shading switch
+		uint32_t type;
+		uint32_t material_id;
+		uint32_t path;
+
+		bool operator<(const HitBin &other) const {
+			return std::tie(type, material_id, path) < std::tie(other.type, other.material_id, other.path);
+		}
+	};
+
+	void generate(Camera &camera, const ImageChunk &chunk, int first_sample, size_t first, size_t count);
+
+	void intersect(const IHittable &world, const Color &background);
+
+	void sortByMaterial();
+
+	/**
+	 * @param bounce bounces the paths of the batch have taken so far
+	 */
+	void shade(int bounce, int roulette_min_depth);
+
+	size_t batch_size;
+	std::vector<PathState> paths;
+	std::vector<PathState> survivors;
+	std::vector<HitRecord> records;
+	std::vector<HitBin> hit_bins;
+	std::vector<Color> sums;
+};
+
+#endif // RAYTRACING_WAVEFRONT_H
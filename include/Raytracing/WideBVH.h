@@ -0,0 +1,83 @@
+/**
+ * @file WideBVH.h
+ * @author ayano
+ * @date 10/17/26
+ * @brief 4 and 8 wide hierarchies collapsed from the binary BVH
+ */
+
+#ifndef RAYTRACING_WIDEBVH_H
+#define RAYTRACING_WIDEBVH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BVH.h"
+#include "GraphicObjects.h"
+#include "MathUtil.h"
+#include "RayBox.h"
+
+/**
+ * node of a wide hierarchy. child bounds are stored structure of arrays so one rayBox4 / rayBox8 call
+ * tests all of them. a child is either another node or a leaf, a range of primitives. unused slots
+ * have inverted bounds and are never hit
+ */
+template<int Width>
+struct alignas(32) WideBVHNode {
+	float bounds_min[3][Width];
+	float bounds_max[3][Width];
+	// node index for interior children, offset into the primitives for leaves
+	uint32_t child[Width];
+	// 0 for interior children
+	uint16_t primitive_count[Width];
+	/**
+	 * front to back child order for each of the 8 direction octants, child k of the order sits in bits
+	 * 4k to 4k + 3. the octant index has bit i set when the direction is negative along axis i
+	 */
+	uint32_t order[8];
+};
+
+/**
+ * opt in alternative to BVHNode. the binary SAH hierarchy is built first and then collapsed, every
+ * wide node takes the place of up to Width - 1 binary nodes, opening the child with the largest
+ * surface area first. fewer, larger nodes mean fewer visits and dependent loads per ray. packets are
+ * traced one ray at a time
+ * @tparam Width 4 or 8 children per node
+ */
+template<int Width>
+class WideBVH : public IHittable {
+	static_assert(Width == 4 || Width == 8, "WideBVH has kernels for 4 and 8 children");
+
+public:
+	WideBVH() = default;
+
+	explicit WideBVH(const HittableList &list);
+
+	WideBVH(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end);
+
+	bool hit(const Ray &r, Interval interval, HitRecord &record) const override;
+
+	AABB boundingBox() const override;
+
+	void collectLights(std::vector<const IHittable *> &lights) const override;
+
+	const std::vector<WideBVHNode<Width>> &getNodes() const;
+
+private:
+	/**
+	 * collapse the binary subtree below the interior node binary_index into a new wide node
+	 * @return index of the wide node
+	 */
+	uint32_t collapse(const std::vector<LinearBVHNode> &binary, uint32_t binary_index);
+
+	std::vector<WideBVHNode<Width>> nodes;
+	std::vector<std::shared_ptr<IHittable>> primitives;
+	AABB bbox;
+};
+
+using BVH4 = WideBVH<4>;
+using BVH8 = WideBVH<8>;
+
+extern template class WideBVH<4>;
+extern template class WideBVH<8>;
+
+#endif // RAYTRACING_WIDEBVH_H
@@ -8,6 +8,52 @@
 #ifndef RAYTRACING_SCENES_H
 #define RAYTRACING_SCENES_H
 
+#include <string>
+#include <utility>
+#include <vector>
+#include "Camera.h"
+#include "GraphicObjects.h"
+
+/**
+ * a still scene as rendered by its scene function. world is left without its top level BVH so the
+ * build can be timed apart from the rest of the setup
+ */
+struct Scene {
+	std::string file;
+	HittableList world;
+	Camera camera;
+	// whether the scene function puts world into a BVHNode before rendering it
+	bool bvh;
+};
+
+/**
+ * wrap world into its BVH if the scene asks for one
+ */
+void buildSceneBVH(Scene &scene);
+
+Scene makeRandomSpheres();
+
+Scene makeTwoSpheres();
+
+Scene makeHuajiSphere();
+
+Scene makePerlinSpheres();
+
+Scene makeTerrain();
+
+Scene makeQuads();
+
+Scene makeTriangles();
+
+Scene makeCornellBox();
+
+Scene makeCornellBoxWithObjects();
+
+/**
+ * every still scene by name, the camera tests render many frames and are left out
+ */
+const std::vector<std::pair<std::string, Scene (*)()>> &sceneSuite();
+
 void randomSpheres();
 
 void twoSpheres();
@@ -0,0 +1,117 @@
+/**
+ * @file BVH.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "BVH.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "BVHBuilder.h"
+
+void LinearBVHNode::setBounds(const AABB &box) {
+	// round outwards so the float box never shrinks below the double one
+	bounds_min[0] = std::nextafter(static_cast<float>(box.x.min), -INF);
+	bounds_min[1] = std::nextafter(static_cast<float>(box.y.min), -INF);
+	bounds_min[2] = std::nextafter(static_cast<float>(box.z.min), -INF);
+	bounds_max[0] = std::nextafter(static_cast<float>(box.x.max), INF);
+	bounds_max[1] = std::nextafter(static_cast<float>(box.y.max), INF);
+	bounds_max[2] = std::nextafter(static_cast<float>(box.z.max), INF);
+}
+
+uint32_t LinearBVHNode::hitPacket(const RayPacket &packet, float t_min, uint32_t lanes) const {
+	const float *origin[3] = {packet.ox, packet.oy, packet.oz};
+	const float *inv_dir[3] = {packet.inv_x, packet.inv_y, packet.inv_z};
+	auto near = Float8::broadcast(t_min);
+	auto far = Float8::load(packet.t_max);
+	auto zero = Float8::broadcast(0);
+	for (int i = 0; i < 3; i++) {
+		auto o = Float8::load(origin[i]);
+		auto inv = Float8::load(inv_dir[i]);
+		auto lo = Float8::broadcast(bounds_min[i]);
+		auto hi = Float8::broadcast(bounds_max[i]);
+		// entry and exit picked by the sign of each lane like the scalar kernels, NaN distances never
+		// narrow the interval since max and min return their second operand for them
+		auto negative = inv < zero;
+		near = max((select(negative, hi, lo) - o) * inv, near);
+		far = min((select(negative, lo, hi) - o) * inv, far);
+	}
+	return (near <= far).bits() & lanes;
+}
+
+BVHNode::BVHNode(const HittableList &list) : BVHNode(list.objects, 0, list.objects.size()) {}
+
+BVHNode::BVHNode(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end) {
+	if (start == end) {
+		bbox = AABB(empty, empty, empty);
+		return;
+	}
+	std::vector<AABB> bounds;
+	bounds.reserve(end - start);
+	bbox = objects[start]->boundingBox();
+	for (size_t i = start; i < end; i++) {
+		bounds.emplace_back(objects[i]->boundingBox());
+		bbox = AABB(bbox, bounds.back());
+	}
+	auto result = buildBVH(bounds);
+	nodes = std::move(result.nodes);
+	primitives.reserve(end - start);
+	for (auto idx: result.primitive_order) {
+		primitives.emplace_back(objects[start + idx]);
+	}
+}
+
+bool BVHNode::hit(const Ray &r, Interval interval, HitRecord &record) const {
+	if (nodes.empty()) {
+		return false;
+	}
+	return traverse(0, r, interval, record);
+}
+
+bool BVHNode::traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const {
+	return traverseLinearBVH(nodes.data(), root, r, interval, [&](const LinearBVHNode &node, Interval &range) {
+		bool hit_anything = false;
+		for (uint32_t i = 0; i < node.primitive_count; i++) {
+			if (primitives[node.primitive_offset + i]->hit(r, range, record)) {
+				hit_anything = true;
+				range.max = record.t;
+			}
+		}
+		return hit_anything;
+	});
+}
+
+uint32_t BVHNode::hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const {
+	if (nodes.empty()) {
+		return 0;
+	}
+	return traverseLinearBVHPacket(
+			nodes.data(), packet, lanes, t_min,
+			[&](uint32_t node, int lane) {
+				if (!traverse(node, packet.rays[lane], Interval(t_min, packet.t_max[lane]), records[lane]))
+					return false;
+				packet.t_max[lane] = records[lane].t;
+				return true;
+			},
+			[&](const LinearBVHNode &node, uint32_t node_lanes) {
+				uint32_t hits = 0;
+				for (uint32_t i = 0; i < node.primitive_count; i++) {
+					hits |= primitives[node.primitive_offset + i]->hitPacket(packet, node_lanes, t_min, records);
+				}
+				return hits;
+			});
+}
+
+AABB BVHNode::boundingBox() const { return bbox; }
+
+void BVHNode::collectLights(std::vector<const IHittable *> &lights) const {
+	for (const auto &primitive: primitives) {
+		primitive->collectLights(lights);
+	}
+}
+
+const std::vector<LinearBVHNode> &BVHNode::getNodes() const { return nodes; }
+
+const std::vector<std::shared_ptr<IHittable>> &BVHNode::getPrimitives() const { return primitives; }
@@ -0,0 +1,281 @@
+/**
+ * @file BVHBuilder.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "BVHBuilder.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace {
+	struct BuildBounds {
+		float min[3] = {INF, INF, INF};
+		float max[3] = {-INF, -INF, -INF};
+
+		void grow(const BuildBounds &other) {
+			for (int i = 0; i < 3; i++) {
+				min[i] = std::min(min[i], other.min[i]);
+				max[i] = std::max(max[i], other.max[i]);
+			}
+		}
+
+		void grow(const float p[3]) {
+			for (int i = 0; i < 3; i++) {
+				min[i] = std::min(min[i], p[i]);
+				max[i] = std::max(max[i], p[i]);
+			}
+		}
+
+		float surfaceArea() const {
+			float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+			if (dx < 0 || dy < 0 || dz < 0)
+				return 0;
+			return 2 * (dx * dy + dy * dz + dz * dx);
+		}
+	};
+
+	struct BuildNode {
+		BuildBounds bounds;
+		std::unique_ptr<BuildNode> children[2];
+		uint32_t first = 0;
+		uint32_t count = 0;
+		uint8_t axis = 0;
+	};
+
+	class SAHBuilder {
+	public:
+		SAHBuilder(const std::vector<AABB> &primitive_bounds, const BVHBuildOptions &options) : options(options) {
+			auto n = primitive_bounds.size();
+			bounds.resize(n);
+			centroids.resize(n * 3);
+			indices.resize(n);
+			for (size_t i = 0; i < n; i++) {
+				const auto &box = primitive_bounds[i];
+				// round outwards so the float box never shrinks below the double one
+				bounds[i].min[0] = std::nextafter(static_cast<float>(box.x.min), -INF);
+				bounds[i].min[1] = std::nextafter(static_cast<float>(box.y.min), -INF);
+				bounds[i].min[2] = std::nextafter(static_cast<float>(box.z.min), -INF);
+				bounds[i].max[0] = std::nextafter(static_cast<float>(box.x.max), INF);
+				bounds[i].max[1] = std::nextafter(static_cast<float>(box.y.max), INF);
+				bounds[i].max[2] = std::nextafter(static_cast<float>(box.z.max), INF);
+				for (int a = 0; a < 3; a++) {
+					// unbounded primitives still need a centroid binning can handle, nan would index out of the bins
+					auto centroid = 0.5f * (bounds[i].min[a] + bounds[i].max[a]);
+					centroids[i * 3 + a] =
+							std::isnan(centroid) ? 0.0f : std::clamp(centroid, -max_centroid, max_centroid);
+				}
+				indices[i] = static_cast<uint32_t>(i);
+			}
+			auto hardware = std::thread::hardware_concurrency();
+			task_budget = hardware == 0 ? 12 : static_cast<int>(hardware);
+		}
+
+		BVHBuildResult build() {
+			BVHBuildResult result;
+			if (indices.empty())
+				return result;
+			auto root = buildRange(0, static_cast<uint32_t>(indices.size()), 0);
+			result.nodes.reserve(node_count.load());
+			flatten(*root, result.nodes);
+			result.primitive_order = std::move(indices);
+			return result;
+		}
+
+	private:
+		// past this depth only object median splits are made so the traversal stack can never overflow
+		static constexpr int median_split_depth = BVHNode::max_depth / 2;
+		static constexpr int max_bin_count = 64;
+		// keeps the width of the centroid bounds finite
+		static constexpr float max_centroid = 1e30f;
+
+		std::unique_ptr<BuildNode> buildRange(uint32_t start, uint32_t end, int depth) {
+			node_count.fetch_add(1, std::memory_order_relaxed);
+			auto node = std::make_unique<BuildNode>();
+			BuildBounds centroid_bounds;
+			for (uint32_t i = start; i < end; i++) {
+				node->bounds.grow(bounds[indices[i]]);
+				centroid_bounds.grow(&centroids[indices[i] * 3]);
+			}
+			auto count = end - start;
+
+			auto makeLeaf = [&]() {
+				node->first = start;
+				node->count = count;
+				return std::move(node);
+			};
+
+			if (count == 1) {
+				return makeLeaf();
+			}
+
+			int axis = 0;
+			for (int a = 1; a < 3; a++) {
+				if (centroid_bounds.max[a] - centroid_bounds.min[a] >
+					centroid_bounds.max[axis] - centroid_bounds.min[axis]) {
+					axis = a;
+				}
+			}
+
+			uint32_t mid;
+			if (centroid_bounds.max[axis] <= centroid_bounds.min[axis]) {
+				// every centroid coincides, binning cannot separate them
+				if (count <= static_cast<uint32_t>(options.max_leaf_size))
+					return makeLeaf();
+				mid = start + count / 2;
+			} else if (depth >= median_split_depth) {
+				if (count <= static_cast<uint32_t>(options.max_leaf_size))
+					return makeLeaf();
+				mid = medianSplit(start, end, axis);
+			} else {
+				float leaf_cost = options.intersection_cost * static_cast<float>(count);
+				int split_bin;
+				float split_cost = bestBinSplit(start, end, node->bounds, centroid_bounds, axis, split_bin);
+				if (count <= static_cast<uint32_t>(options.max_leaf_size) && leaf_cost <= split_cost) {
+					return makeLeaf();
+				}
+				float lo = centroid_bounds.min[axis];
+				float scale = static_cast<float>(binCount()) / (centroid_bounds.max[axis] - lo);
+				auto it = std::partition(indices.begin() + start, indices.begin() + end, [&](uint32_t idx) {
+					return binIndex(centroids[idx * 3 + axis], lo, scale) <= split_bin;
+				});
+				mid = static_cast<uint32_t>(it - indices.begin());
+				if (mid == start || mid == end) {
+					mid = medianSplit(start, end, axis);
+				}
+			}
+
+			node->axis = static_cast<uint8_t>(axis);
+			bool spawn = std::min(mid - start, end - mid) >= options.parallel_threshold && tryAcquireTask();
+			if (spawn) {
+				auto left = std::async(std::launch::async, [this, start, mid, depth] {
+					auto subtree = buildRange(start, mid, depth + 1);
+					releaseTask();
+					return subtree;
+				});
+				node->children[1] = buildRange(mid, end, depth + 1);
+				node->children[0] = left.get();
+			} else {
+				node->children[0] = buildRange(start, mid, depth + 1);
+				node->children[1] = buildRange(mid, end, depth + 1);
+			}
+			return node;
+		}
+
+		int binCount() const { return std::clamp(options.bin_count, 2, max_bin_count); }
+
+		int binIndex(float centroid, float lo, float scale) const {
+			return std::min(binCount() - 1, static_cast<int>((centroid - lo) * scale));
+		}
+
+		/**
+		 * bin the centroids of the range along the axis and sweep the bins for the cheapest split
+		 * @return cost of the best split, split_bin receives the last bin on the left side
+		 */
+		float bestBinSplit(uint32_t start, uint32_t end, const BuildBounds &node_bounds,
+						   const BuildBounds &centroid_bounds, int axis, int &split_bin) const {
+			struct Bin {
+				BuildBounds bounds;
+				uint32_t count = 0;
+			};
+			auto bin_count = binCount();
+			Bin bins[max_bin_count];
+			float lo = centroid_bounds.min[axis];
+			float scale = static_cast<float>(bin_count) / (centroid_bounds.max[axis] - lo);
+			for (uint32_t i = start; i < end; i++) {
+				auto idx = indices[i];
+				auto &bin = bins[binIndex(centroids[idx * 3 + axis], lo, scale)];
+				bin.count++;
+				bin.bounds.grow(bounds[idx]);
+			}
+
+			float right_area[max_bin_count];
+			uint32_t right_count[max_bin_count];
+			BuildBounds accumulated;
+			uint32_t accumulated_count = 0;
+			for (int i = bin_count - 1; i > 0; i--) {
+				accumulated.grow(bins[i].bounds);
+				accumulated_count += bins[i].count;
+				right_area[i] = accumulated.surfaceArea();
+				right_count[i] = accumulated_count;
+			}
+
+			float best_cost = INF;
+			split_bin = 0;
+			accumulated = BuildBounds();
+			accumulated_count = 0;
+			float inv_area = 1.0f / std::max(node_bounds.surfaceArea(), 1e-20f);
+			for (int i = 0; i < bin_count - 1; i++) {
+				accumulated.grow(bins[i].bounds);
+				accumulated_count += bins[i].count;
+				if (accumulated_count == 0 || right_count[i + 1] == 0)
+					continue;
+				float cost = options.traversal_cost +
+							 options.intersection_cost * inv_area *
+									 (accumulated.surfaceArea() * static_cast<float>(accumulated_count) +
+									  right_area[i + 1] * static_cast<float>(right_count[i + 1]));
+				if (cost < best_cost) {
+					best_cost = cost;
+					split_bin = i;
+				}
+			}
+			return best_cost;
+		}
+
+		uint32_t medianSplit(uint32_t start, uint32_t end, int axis) {
+			auto mid = start + (end - start) / 2;
+			std::nth_element(indices.begin() + start, indices.begin() + mid, indices.begin() + end,
+							 [&](uint32_t a, uint32_t b) { return centroids[a * 3 + axis] < centroids[b * 3 + axis]; });
+			return mid;
+		}
+
+		bool tryAcquireTask() {
+			auto live = live_tasks.load(std::memory_order_relaxed);
+			while (live < task_budget) {
+				if (live_tasks.compare_exchange_weak(live, live + 1, std::memory_order_relaxed))
+					return true;
+			}
+			return false;
+		}
+
+		void releaseTask() { live_tasks.fetch_sub(1, std::memory_order_relaxed); }
+
+		static uint32_t flatten(const BuildNode &node, std::vector<LinearBVHNode> &out) {
+			auto idx = static_cast<uint32_t>(out.size());
+			out.emplace_back();
+			for (int i = 0; i < 3; i++) {
+				out[idx].bounds_min[i] = node.bounds.min[i];
+				out[idx].bounds_max[i] = node.bounds.max[i];
+			}
+			if (node.children[0] == nullptr) {
+				out[idx].primitive_offset = node.first;
+				out[idx].primitive_count = static_cast<uint16_t>(node.count);
+				return idx;
+			}
+			flatten(*node.children[0], out);
+			auto second = flatten(*node.children[1], out);
+			out[idx].second_child_offset = second;
+			out[idx].primitive_count = 0;
+			out[idx].axis = node.axis;
+			return idx;
+		}
+
+		const BVHBuildOptions &options;
+		std::vector<BuildBounds> bounds;
+		std::vector<float> centroids;
+		std::vector<uint32_t> indices;
+		std::atomic<size_t> node_count = 0;
+		std::atomic<int> live_tasks = 0;
+		int task_budget;
+	};
+} // namespace
+
+BVHBuildResult buildBVH(const std::vector<AABB> &primitive_bounds, const BVHBuildOptions &options) {
+	SAHBuilder builder(primitive_bounds, options);
+	return builder.build();
+}
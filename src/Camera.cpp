@@ -6,161 +6,512 @@
  */
 
 #include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
+#include "Checkpoint.h"
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "ImageUtil.h"
 #include "Material.h"
 
+thread_local Camera::PathStats Camera::worker_path_stats;
+
 std::string Camera::Render(const IHittable &world, const std::string &name, const std::string &path) {
-	auto now = std::chrono::system_clock::now();
+	if (progressive_pass_samples > 0) {
+		return renderProgressive(world, name, path);
+	}
+	Framebuffer image(width, height, FB_SAMPLE_COUNT);
+	spdlog::info("rendering started!");
+#ifndef ASCII_ART
+	// rows are encoded in the background as soon as every chunk covering them is done
+	std::string filepath = mkdir(path, name);
+	AsyncImageWriter writer(makeImageWriter(name), filepath, image);
+	renderPass(world, image, 0, sample_count, &writer);
+#else
+	renderPass(world, image, 0, sample_count, nullptr);
+#endif
+	if (adaptive_threshold > 0 && integrator != INTEGRATOR_WAVEFRONT) {
+		uint64_t samples = 0;
+		int pixels = 0, converged = 0;
+		float worst = 0;
+		for (const auto &stats: tile_stats) {
+			samples += stats.samples;
+			pixels += stats.pixels;
+			converged += stats.converged;
+			worst = std::max(worst, stats.max_error);
+		}
+		spdlog::info("adaptive sampling: {:.1f} samples per pixel ({:.1f}% of the fixed budget), {}/{} pixels "
+					 "converged, worst error {:.4f}",
+					 static_cast<double>(samples) / pixels,
+					 100.0 * static_cast<double>(samples) / (static_cast<double>(pixels) * sample_count), converged,
+					 pixels, worst);
+	}
+#ifndef ASCII_ART
+	if (!writer.finish()) {
+		spdlog::error("failed to write {}", filepath);
+	}
+	std::cout << filepath << std::endl;
+	return filepath;
+#else
+	return makeGrayscaleTxt(image, name);
+#endif
+}
+
+void Camera::renderTo(const IHittable &world, Framebuffer &image) {
+	renderPass(world, image, 0, sample_count, nullptr);
+}
+
+std::string Camera::renderProgressive(const IHittable &world, const std::string &name, const std::string &path) {
+	Framebuffer image(width, height, FB_SAMPLE_COUNT);
+	std::unique_ptr<Checkpoint> checkpoint;
+	int done = 0;
+	if (!checkpoint_path.empty()) {
+		checkpoint = std::make_unique<Checkpoint>(checkpoint_path, width, height, frame,
+												  renderFingerprint(world, name));
+		done = static_cast<int>(checkpoint->restore(image));
+		if (done > 0) {
+			spdlog::info("resuming from checkpoint {} at {} samples per pixel", checkpoint_path, done);
+		}
+	}
+	if (adaptive_threshold > 0) {
+		spdlog::warn("adaptive sampling is not available for progressive renders, every pass samples every pixel");
+	}
+	spdlog::info("progressive rendering started, {} samples per pass", progressive_pass_samples);
+#ifndef ASCII_ART
+	std::string filepath = mkdir(path, name);
+#endif
+	auto writeImage = [&] {
+#ifndef ASCII_ART
+		auto writer = makeImageWriter(name);
+		bool written = writer->begin(filepath, width, height);
+		if (written) {
+			writer->writeRows(image, 0, height);
+			written = writer->finish();
+		}
+		if (!written) {
+			spdlog::error("failed to write {}", filepath);
+		}
+#endif
+	};
+	if (done >= sample_count) {
+		// the checkpoint already holds the whole budget, the restored image is the final one
+		spdlog::info("checkpoint {} already has {}/{} samples per pixel, nothing to render", checkpoint_path, done,
+					 sample_count);
+		writeImage();
+	}
+	auto last_checkpoint = std::chrono::steady_clock::now();
+	while (done < sample_count) {
+		int samples = std::min(progressive_pass_samples, sample_count - done);
+		renderPass(world, image, done, samples, nullptr);
+		done += samples;
+		spdlog::info("pass finished, {}/{} samples per pixel", done, sample_count);
+		// the preview is rewritten after every pass, the last one is the final image
+		writeImage();
+		auto now = std::chrono::steady_clock::now();
+		if (checkpoint != nullptr &&
+			(done == sample_count ||
+			 std::chrono::duration<float>(now - last_checkpoint).count() >= checkpoint_interval)) {
+			if (checkpoint->save(image, static_cast<uint32_t>(done))) {
+				spdlog::info("checkpoint {} saved at {} samples per pixel", checkpoint_path, done);
+			}
+			last_checkpoint = now;
+		}
+	}
+#ifndef ASCII_ART
+	std::cout << filepath << std::endl;
+	return filepath;
+#else
+	return makeGrayscaleTxt(image, name);
+#endif
+}
+
+void Camera::renderPass(const IHittable &world, Framebuffer &image, int first_sample, int samples,
+						AsyncImageWriter *writer) {
 	int worker_cnt;
 	if (render_thread_count == 0) {
 		worker_cnt = std::thread::hardware_concurrency() == 0 ? 12 : std::thread::hardware_concurrency();
 	} else {
 		worker_cnt = render_thread_count;
 	}
-	std::vector<std::vector<Color>> image;
-	image.resize(height);
-	for (auto &i: image) {
-		i.resize(width);
-	}
-	int part = partition();
-	auto m = KawaiiMQ::MessageQueueManager::Instance();
-	auto result_queue = KawaiiMQ::makeQueue("result");
-	auto result_topic = KawaiiMQ::Topic("renderResult");
-	m->relate(result_topic, result_queue);
+	TileScheduler scheduler(width, height, chunk_dimension, worker_cnt);
+	tile_stats.assign(scheduler.tileCount(), TileStats{});
+	path_stats.assign(worker_cnt, PathStats{});
+	lights = light_sampling ? LightList(world) : LightList();
 	auto th = std::vector<std::thread>();
-	spdlog::info("rendering started!");
-	spdlog::info("using {} threads to render {} blocks", worker_cnt, part);
+	spdlog::info("using {} threads to render {} blocks, {} lights sampled", worker_cnt, scheduler.tileCount(),
+				 lights.size());
 	auto begin = std::chrono::system_clock::now();
 	for (int i = 0; i < worker_cnt; i++) {
-		th.emplace_back(&Camera::RenderWorker, this, std::ref(world));
+		th.emplace_back(&Camera::RenderWorker, this, std::ref(world), std::ref(scheduler), i, std::ref(image), writer,
+						first_sample, samples);
 	}
 	for (auto &i: th) {
 		i.join();
 	}
 	auto end = std::chrono::system_clock::now();
 	auto time_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
-	spdlog::info("render completed! taken {}s", static_cast<float>(time_elapsed.count()) / 1000.0);
-	auto consumer = KawaiiMQ::Consumer("resultConsumer");
-	consumer.subscribe(result_topic);
-	while (!result_queue->empty()) {
-		auto chunk = KawaiiMQ::getMessage<ImageChunk>(consumer.fetchSingleTopic(result_topic)[0]);
-		for (int i = chunk.starty; i < chunk.starty + chunk.height; i++) {
-			for (int j = chunk.startx; j < chunk.startx + chunk.width; j++) {
-				image[i][j] = chunk.partial[i - chunk.starty][j - chunk.startx];
-			}
-		}
-	}
-	m->unrelate(result_topic, result_queue);
-#ifndef ASCII_ART
-	return makePPM(width, height, image, name, path);
-#else
-	return makeGrayscaleTxt(width, height, image, name);
-#endif
+	pass_seconds = std::chrono::duration<double>(end - begin).count();
+	spdlog::info("render completed! taken {}s, {} blocks stolen", static_cast<float>(time_elapsed.count()) / 1000.0,
+				 scheduler.stealCount());
 }
 
-void Camera::RenderWorker(const IHittable &world) {
+void Camera::RenderWorker(const IHittable &world, TileScheduler &scheduler, int worker_idx, Framebuffer &image,
+						  AsyncImageWriter *writer, int first_sample, int samples) {
 	std::stringstream ss;
 	ss << std::this_thread::get_id();
-	auto m = KawaiiMQ::MessageQueueManager::Instance();
-	auto result_topic = KawaiiMQ::Topic("renderResult");
-	auto result_producer = KawaiiMQ::Producer("producer");
-	result_producer.subscribe(result_topic);
-	auto task_topic = KawaiiMQ::Topic("renderTask");
-	auto task_fetcher = KawaiiMQ::Consumer({task_topic});
-	auto task_queue = m->getAllRelatedQueue(task_topic)[0];
-	auto chunk_message = std::shared_ptr<KawaiiMQ::MessageData>();
 	spdlog::info("thread {} started", ss.str());
-	while (task_queue->tryWait(chunk_message)) {
-		auto chunk = KawaiiMQ::getMessage<ImageChunk>(chunk_message);
+	WavefrontIntegrator wavefront;
+	// adaptive sampling decides the sample counts itself, so it only runs on whole renders
+	const bool adaptive = adaptive_threshold > 0 && first_sample == 0 && samples == sample_count;
+	worker_path_stats = PathStats{};
+	ImageChunk chunk;
+	while (scheduler.next(worker_idx, chunk)) {
 		spdlog::info("chunk {} (start from ({}, {}), dimension {} * {}) "
 					 "started by thread {}",
 					 chunk.chunk_idx, chunk.startx, chunk.starty, chunk.width, chunk.height, ss.str());
 
-		for (int i = chunk.starty; i < chunk.starty + chunk.height; i++) {
-			auto hori = std::vector<Color>();
-			hori.reserve(chunk.width);
-			for (int j = chunk.startx; j < chunk.startx + chunk.width; j++) {
-				Color pixel_color = Color{0, 0, 0};
-				for (int k = 0; k < sample_count; ++k) {
-					auto ray = getRay(j, i);
-					pixel_color += rayColor(ray, world, render_depth);
+		auto tile = image.tile(chunk);
+		if (integrator == INTEGRATOR_WAVEFRONT) {
+			wavefront.renderTile(*this, world, tile, first_sample, samples);
+		} else if (adaptive) {
+			const auto &stats = tile_stats[chunk.chunk_idx] = traceAdaptiveTile(world, tile);
+			spdlog::debug("chunk {}: {:.1f} samples per pixel, {}/{} pixels converged, max error {:.4f}",
+						  chunk.chunk_idx, static_cast<double>(stats.samples) / stats.pixels, stats.converged,
+						  stats.pixels, stats.max_error);
+		} else if (packet_tracing && render_depth > 0) {
+			tracePacketTile(world, tile, first_sample, samples);
+		} else {
+			for (int i = 0; i < chunk.height; i++) {
+				for (int j = 0; j < chunk.width; j++) {
+					Color pixel_color = Color{0, 0, 0};
+					auto pixel_idx = static_cast<uint32_t>((chunk.starty + i) * width + chunk.startx + j);
+					for (int k = first_sample; k < first_sample + samples; ++k) {
+						seedSampleStream(frame, pixel_idx, k);
+						auto ray = getRay(chunk.startx + j, chunk.starty + i);
+						pixel_color += rayColor(ray, world, render_depth);
+					}
+					tile.accumulateColor(j, i, pixel_color, samples);
+				}
+			}
+		}
+		if (writer != nullptr) {
+			writer->chunkDone(chunk);
+		}
+	}
+	path_stats[worker_idx] = worker_path_stats;
+}
+
+void Camera::tracePacketTile(const IHittable &world, FramebufferTile &tile, int first_sample, int samples) {
+	// 4x2 pixel blocks keep the rays of a packet close together in both directions
+	constexpr int packet_width = 4;
+	constexpr int packet_height = RayPacket::size / packet_width;
+	const auto &chunk = tile.chunk();
+	PixelSample pixel_samples[RayPacket::size];
+	Color colors[RayPacket::size];
+	Color sums[RayPacket::size];
+	for (int by = 0; by < chunk.height; by += packet_height) {
+		for (int bx = 0; bx < chunk.width; bx += packet_width) {
+			int count = 0;
+			for (int lane = 0; lane < RayPacket::size; lane++) {
+				int x = bx + lane % packet_width;
+				int y = by + lane / packet_width;
+				if (x < chunk.width && y < chunk.height) {
+					pixel_samples[count++] = PixelSample{chunk.startx + x, chunk.starty + y, 0};
+				}
+			}
+			for (int i = 0; i < count; i++) {
+				sums[i] = Color{0, 0, 0};
+			}
+			for (int k = first_sample; k < first_sample + samples; ++k) {
+				for (int i = 0; i < count; i++) {
+					pixel_samples[i].sample = k;
 				}
-				pixel_color /= sample_count;
-				pixel_color =
-						Color{gammaCorrect(pixel_color[0]), gammaCorrect(pixel_color[1]), gammaCorrect(pixel_color[2])};
-				hori.emplace_back(pixel_color);
+				traceSamples(world, pixel_samples, count, colors);
+				for (int i = 0; i < count; i++) {
+					sums[i] += colors[i];
+				}
+			}
+			for (int i = 0; i < count; i++) {
+				tile.accumulateColor(pixel_samples[i].x - chunk.startx, pixel_samples[i].y - chunk.starty, sums[i],
+									 samples);
 			}
-			chunk.partial.emplace_back(hori);
 		}
-		auto message = KawaiiMQ::makeMessage(chunk);
-		result_producer.broadcastMessage(message);
 	}
-	task_fetcher.unsubscribe(task_topic);
-	result_producer.unsubscribe(result_topic);
+}
 
-	m->unrelate(task_topic, task_queue);
+void Camera::traceSamples(const IHittable &world, const PixelSample *samples, int count, Color *colors) {
+	if (!packet_tracing || render_depth <= 0) {
+		for (int i = 0; i < count; i++) {
+			seedSampleStream(frame, static_cast<uint32_t>(samples[i].y * width + samples[i].x), samples[i].sample);
+			colors[i] = rayColor(getRay(samples[i].x, samples[i].y), world, render_depth);
+		}
+		return;
+	}
+	RayPacket packet{};
+	HitRecord records[RayPacket::size];
+	Pcg32 lane_rng[RayPacket::size];
+	for (int lane = 0; lane < count; lane++) {
+		const auto &s = samples[lane];
+		seedSampleStream(frame, static_cast<uint32_t>(s.y * width + s.x), s.sample);
+		packet.set(lane, getRay(s.x, s.y));
+		// every pixel keeps its own random stream for the bounces
+		lane_rng[lane] = threadRng();
+	}
+	auto hits = world.hitPacket(packet, packet.active, EPS, records);
+	forEachLane(packet.active, [&](int lane) {
+		threadRng() = lane_rng[lane];
+		if (hits & (1u << lane)) {
+			colors[lane] = shade(packet.rays[lane], records[lane], world, render_depth);
+		} else {
+			colors[lane] = background;
+			worker_path_stats.paths++;
+			worker_path_stats.rays++;
+		}
+	});
 }
 
-int Camera::partition() const {
-	auto manager = KawaiiMQ::MessageQueueManager::Instance();
-	auto queue = KawaiiMQ::makeQueue("renderTaskQueue");
-	auto topic = KawaiiMQ::Topic("renderTask");
-	manager->relate(topic, queue);
-	KawaiiMQ::Producer prod("chunkPusher");
-	prod.subscribe(topic);
-	int upperleft_x = 0;
-	int upperleft_y = 0;
-	int idx = 0;
-	while (upperleft_y < height) {
-		while (upperleft_x < width) {
-			ImageChunk chunk;
-			chunk.chunk_idx = idx;
-			++idx;
-			chunk.startx = upperleft_x;
-			chunk.starty = upperleft_y;
-			if (upperleft_x + chunk_dimension > width) {
-				chunk.width = width % chunk_dimension;
-			} else {
-				chunk.width = chunk_dimension;
+TileStats Camera::traceAdaptiveTile(const IHittable &world, FramebufferTile &tile) {
+	struct PixelState {
+		Color sum = Color{0, 0, 0};
+		double mean = 0;
+		double m2 = 0;
+	};
+	// a handful of samples of one pixel is often all zero in dim scenes, so convergence is decided
+	// for blocks of pixels from their pooled variance and every pixel of a block stops together
+	struct Block {
+		int x, y, width, height;
+		uint32_t n = 0;
+		double error = INF;
+	};
+	const auto &chunk = tile.chunk();
+	const int pixels = chunk.width * chunk.height;
+	const auto max_samples = static_cast<uint32_t>(sample_count * adaptive_max_factor);
+	std::vector<PixelState> state(pixels);
+	std::vector<Block> blocks;
+	for (int y = 0; y < chunk.height; y += adaptive_block) {
+		for (int x = 0; x < chunk.width; x += adaptive_block) {
+			blocks.push_back(Block{x, y, std::min(adaptive_block, chunk.width - x),
+								   std::min(adaptive_block, chunk.height - y)});
+		}
+	}
+	std::vector<Block *> active;
+	for (auto &block: blocks) {
+		active.push_back(&block);
+	}
+	// samples the tile would take without adaptive sampling, converged blocks hand theirs to noisy ones
+	int64_t budget = static_cast<int64_t>(pixels) * sample_count;
+	int round = std::min(adaptive_min_samples, sample_count);
+	PixelSample samples[RayPacket::size];
+	Color colors[RayPacket::size];
+	int indices[RayPacket::size];
+	auto cost = [&](int per_pixel) {
+		int64_t total = 0;
+		for (const auto *block: active) {
+			total += static_cast<int64_t>(block->width) * block->height * per_pixel;
+		}
+		return total;
+	};
+	while (!active.empty() && budget > 0) {
+		if (cost(round) > budget) {
+			// not enough left for everyone, the noisiest blocks go first
+			std::sort(active.begin(), active.end(), [](const Block *a, const Block *b) { return a->error > b->error; });
+			round = static_cast<int>(std::max<int64_t>(1, budget / cost(1)));
+			while (active.size() > 1 && cost(round) > budget) {
+				active.pop_back();
 			}
-			if (upperleft_y + chunk_dimension > height) {
-				chunk.height = height % chunk_dimension;
-			} else {
-				chunk.height = chunk_dimension;
+		}
+		for (auto *block: active) {
+			for (int k = 0; k < round; k++) {
+				int count = 0;
+				auto flush = [&] {
+					traceSamples(world, samples, count, colors);
+					for (int i = 0; i < count; i++) {
+						// welford update of the luminance mean and variance
+						auto &p = state[indices[i]];
+						double lum = 0.2126 * colors[i][0] + 0.7152 * colors[i][1] + 0.0722 * colors[i][2];
+						p.sum += colors[i];
+						double delta = lum - p.mean;
+						p.mean += delta / (block->n + 1);
+						p.m2 += delta * (lum - p.mean);
+					}
+					count = 0;
+				};
+				// 4x2 groups like tracePacketTile, so a packet stays coherent
+				for (int by = block->y; by < block->y + block->height; by += 2) {
+					for (int bx = block->x; bx < block->x + block->width; bx += 4) {
+						for (int lane = 0; lane < RayPacket::size; lane++) {
+							int x = bx + lane % 4, y = by + lane / 4;
+							if (x >= block->x + block->width || y >= block->y + block->height)
+								continue;
+							indices[count] = y * chunk.width + x;
+							samples[count++] = PixelSample{chunk.startx + x, chunk.starty + y, block->n};
+						}
+						flush();
+					}
+				}
+				block->n++;
 			}
-			auto message = KawaiiMQ::makeMessage(chunk);
-			prod.broadcastMessage(message);
-			upperleft_x += chunk_dimension;
+			budget -= static_cast<int64_t>(block->width) * block->height * round;
 		}
-		upperleft_x = 0;
-		upperleft_y += chunk_dimension;
+		std::erase_if(active, [&](Block *block) {
+			if (block->n >= 2) {
+				// rms of the standard errors of the pixel means, relative to the brightness of the block and
+				// floored for dark blocks. a per pixel error, about sqrt(count) times that of the block mean
+				double variance = 0, mean = 0;
+				for (int y = block->y; y < block->y + block->height; y++) {
+					for (int x = block->x; x < block->x + block->width; x++) {
+						const auto &p = state[y * chunk.width + x];
+						variance += p.m2 / (block->n - 1) / block->n;
+						mean += p.mean;
+					}
+				}
+				int count = block->width * block->height;
+				block->error = std::sqrt(variance / count) / (mean / count + adaptive_dark_floor);
+			}
+			return block->error < adaptive_threshold || block->n >= max_samples;
+		});
+		round = adaptive_batch;
 	}
-	prod.unsubscribe(topic);
-	return idx;
+	TileStats stats{chunk.chunk_idx, pixels, 0, 0, 0};
+	for (const auto &block: blocks) {
+		for (int y = block.y; y < block.y + block.height; y++) {
+			for (int x = block.x; x < block.x + block.width; x++) {
+				tile.setColor(x, y, state[y * chunk.width + x].sum / std::max<uint32_t>(block.n, 1));
+				tile.setSampleCount(x, y, block.n);
+			}
+		}
+		stats.samples += static_cast<uint64_t>(block.width) * block.height * block.n;
+		stats.converged += block.error < adaptive_threshold ? block.width * block.height : 0;
+		stats.max_error = std::max(stats.max_error, static_cast<float>(block.error));
+	}
+	return stats;
 }
 
-void Camera::setRotation(const Eigen::Vector3d &rot) {
+void Camera::setRotation(const Vec3 &rot) {
 	rotation_ypr = rot;
 	updateVectors();
 }
 
-Eigen::Vector3d Camera::getRotation() const { return rotation_ypr; }
+Vec3 Camera::getRotation() const { return rotation_ypr; }
 
 Color Camera::getBackground() const { return background; }
 
 void Camera::setBackground(const Color &background) { this->background = background; }
 
-Camera::Camera(int width, float aspect_ratio, float fov, Point3 position, Eigen::Vector3d target, float dof_angle) :
+int Camera::getFrame() const { return frame; }
+
+void Camera::setFrame(int frame) { this->frame = frame; }
+
+bool Camera::getLightSampling() const { return light_sampling; }
+
+void Camera::setLightSampling(bool enabled) { light_sampling = enabled; }
+
+int Camera::getRouletteMinDepth() const { return roulette_min_depth; }
+
+void Camera::setRouletteMinDepth(int depth) { roulette_min_depth = std::max(depth, 1); }
+
+double Camera::getAveragePathLength() const {
+	PathStats total;
+	for (const auto &stats: path_stats) {
+		total.paths += stats.paths;
+		total.rays += stats.rays;
+	}
+	return total.paths == 0 ? 0 : static_cast<double>(total.rays) / static_cast<double>(total.paths);
+}
+
+RenderStats Camera::getRenderStats() const {
+	RenderStats result;
+	for (const auto &stats: path_stats) {
+		result.primary_rays += stats.paths;
+		result.secondary_rays += stats.rays - stats.paths;
+		result.shadow_rays += stats.shadow_rays;
+	}
+	result.seconds = pass_seconds;
+	return result;
+}
+
+bool Camera::getPacketTracing() const { return packet_tracing; }
+
+void Camera::setPacketTracing(bool enabled) { packet_tracing = enabled; }
+
+RenderIntegrator Camera::getIntegrator() const { return integrator; }
+
+void Camera::setIntegrator(RenderIntegrator integrator) { this->integrator = integrator; }
+
+float Camera::getAdaptiveThreshold() const { return adaptive_threshold; }
+
+void Camera::setAdaptiveThreshold(float threshold) { adaptive_threshold = threshold; }
+
+int Camera::getAdaptiveMinSamples() const { return adaptive_min_samples; }
+
+void Camera::setAdaptiveMinSamples(int samples) { adaptive_min_samples = std::max(samples, 2); }
+
+const std::vector<TileStats> &Camera::getTileStats() const { return tile_stats; }
+
+int Camera::getProgressivePassSamples() const { return progressive_pass_samples; }
+
+void Camera::setProgressivePassSamples(int samples) { progressive_pass_samples = std::max(samples, 0); }
+
+const std::string &Camera::getCheckpointPath() const { return checkpoint_path; }
+
+void Camera::setCheckpointPath(const std::string &path) { checkpoint_path = path; }
+
+const std::string &Camera::getCheckpointKey() const { return checkpoint_key; }
+
+void Camera::setCheckpointKey(const std::string &key) { checkpoint_key = key; }
+
+uint64_t Camera::renderFingerprint(const IHittable &world, const std::string &name) const {
+	// FNV-1a over the raw bytes, it only has to tell renders apart
+	uint64_t hash = 0xcbf29ce484222325ull;
+	auto mix = [&](const void *data, size_t size) {
+		auto bytes = static_cast<const unsigned char *>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+		}
+	};
+	auto mixValue = [&](const auto &value) { mix(&value, sizeof(value)); };
+	auto mixVec = [&](const Vec3 &vec) { mix(vec.data(), sizeof(Real) * 3); };
+	mixValue(render_depth);
+	mixValue(light_sampling);
+	mixValue(integrator);
+	mixValue(roulette_min_depth);
+	mixValue(fov);
+	mixValue(dof_angle);
+	mixValue(shutter_speed);
+	mixVec(position);
+	mixVec(target);
+	mixVec(UP);
+	mixVec(pixel_00);
+	mixVec(pix_delta_x);
+	mixVec(pix_delta_y);
+	mixVec(background);
+	auto bounds = world.boundingBox();
+	for (const auto &axis: {bounds.x, bounds.y, bounds.z}) {
+		mixValue(axis.min);
+		mixValue(axis.max);
+	}
+	mixValue(LightList(world).size());
+	mix(name.data(), name.size());
+	// the separator keeps name "ab", key "c" apart from name "a", key "bc"
+	mixValue('\0');
+	mix(checkpoint_key.data(), checkpoint_key.size());
+	return hash;
+}
+
+float Camera::getCheckpointInterval() const { return checkpoint_interval; }
+
+void Camera::setCheckpointInterval(float seconds) { checkpoint_interval = seconds; }
+
+Camera::Camera(int width, float aspect_ratio, float fov, Point3 position, Vec3 target, float dof_angle) :
 	width(width), aspect_ratio(aspect_ratio), fov(fov), target(std::move(target)), position(std::move(position)),
 	height(static_cast<int>(width / aspect_ratio)), dof_angle(dof_angle) {
 	render_thread_count = std::thread::hardware_concurrency() == 0 ? 12 : std::thread::hardware_concurrency();
-	auto q = Eigen::Quaterniond::FromTwoVectors(Eigen::Vector3d{0, 0, -1}, (target - position));
+	auto q = Quat::FromTwoVectors(Vec3{0, 0, -1}, (target - position));
 	rotation_matrix = q.toRotationMatrix();
 	auto angle = rotation_matrix.canonicalEulerAngles(2, 1, 0);
-	rotation_ypr = Eigen::Vector3d{angle(0, 0), angle(1, 0), angle(2, 0)};
+	rotation_ypr = Vec3{angle(0, 0), angle(1, 0), angle(2, 0)};
 	updateVectors();
 }
 
@@ -170,7 +521,7 @@ void Camera::updateVectors() {
 	focal_len = (position - target).norm();
 	viewport_height = 2 * h * focal_len;
 	viewport_width = viewport_height * (static_cast<float>(width) / height);
-	w = rotation_matrix * Eigen::Vector3d::UnitZ();
+	w = rotation_matrix * Vec3::UnitZ();
 	auto this_UP = UP;
 	// flip vertically
 	if (rotation_ypr[0] > PI / 2 && rotation_ypr[0] < 3 * PI / 2)
@@ -202,13 +553,13 @@ float Camera::getFocalLen() const { return focal_len; }
 
 const Point3 &Camera::getPosition() const { return position; }
 
-const Eigen::Vector3d &Camera::getHoriVec() const { return hori_vec; }
+const Vec3 &Camera::getHoriVec() const { return hori_vec; }
 
-const Eigen::Vector3d &Camera::getVertVec() const { return vert_vec; }
+const Vec3 &Camera::getVertVec() const { return vert_vec; }
 
-const Eigen::Vector3d &Camera::getPixDeltaX() const { return pix_delta_x; }
+const Vec3 &Camera::getPixDeltaX() const { return pix_delta_x; }
 
-const Eigen::Vector3d &Camera::getPixDeltaY() const { return pix_delta_y; }
+const Vec3 &Camera::getPixDeltaY() const { return pix_delta_y; }
 
 const Point3 &Camera::getViewportUl() const { return viewport_ul; }
 
@@ -236,7 +587,7 @@ void Camera::setPosition(const Point3 &position) {
 
 void Camera::setSampleCount(int sample_count) { Camera::sample_count = sample_count; }
 
-Eigen::Vector3d Camera::dofDiskSample() const {
+Vec3 Camera::dofDiskSample() const {
 	auto p = randomVec3InUnitDisk();
 	return position + (p[0] * dof_disk_h) + (p[1] * dof_disk_v);
 }
@@ -247,19 +598,88 @@ Color Camera::rayColor(const Ray &ray, const IHittable &object, int depth) {
 		return Color{0, 0, 0};
 
 	if (object.hit(ray, Interval(EPS, INF), record)) {
+		return shade(ray, record, object, depth);
+	}
+	worker_path_stats.paths++;
+	worker_path_stats.rays++;
+	return background;
+}
+
+Color Camera::shade(const Ray &ray, const HitRecord &record, const IHittable &object, int depth) {
+	Color radiance{0, 0, 0};
+	Color throughput{1, 1, 1};
+	Ray current = ray;
+	HitRecord hit = record;
+	// density the last bounce picked current with when it also sampled the lights, 0 when it did not
+	float scatter_pdf = 0;
+	int bounce = 0;
+	for (;; bounce++) {
+		Color emission = MaterialRegistry::emitted(hit.material_id, hit.u, hit.v, hit.p);
+		if (scatter_pdf > 0 && !emission.isZero()) {
+			// the last bounce could also have found this light by sampling it
+			emission *= powerHeuristic(scatter_pdf, lights.pdf(current.pos(), current.dir()));
+		}
+		radiance += throughput.cwiseProduct(emission);
 		Ray scattered;
 		Color attenuation;
-		Color emission = record.material->emitted(record.u, record.v, record.p);
-		if (record.material->scatter(ray, record, attenuation, scattered)) {
-			return attenuation.cwiseProduct(rayColor(scattered, object, depth - 1)) + emission;
+		if (!MaterialRegistry::scatter(hit.material_id, current, hit, attenuation, scattered)) {
+			break;
+		}
+		// the light sample stands in for the scattered ray finding the light, so it is only taken when
+		// that ray still gets traced
+		const bool last = bounce + 1 >= depth;
+		scatter_pdf = 0;
+		if (!last && !lights.empty()) {
+			scatter_pdf = MaterialRegistry::scatteringPdf(hit.material_id, current, hit, scattered.dir());
+			if (scatter_pdf > 0) {
+				radiance += throughput.cwiseProduct(sampleLights(current, hit, object, attenuation));
+			}
+		}
+		if (last) {
+			break;
+		}
+		throughput = throughput.cwiseProduct(attenuation);
+		if (bounce + 1 >= roulette_min_depth) {
+			auto survival = std::min<Real>(throughput.maxCoeff(), 1);
+			if (randomFloat() >= survival) {
+				break;
+			}
+			throughput /= survival;
+		}
+		current = scattered;
+		if (!object.hit(current, Interval(EPS, INF), hit)) {
+			radiance += throughput.cwiseProduct(background);
+			bounce++;
+			break;
 		}
-		return emission;
 	}
-	return background;
+	worker_path_stats.paths++;
+	worker_path_stats.rays += bounce + 1;
+	return radiance;
+}
+
+Color Camera::sampleLights(const Ray &ray, const HitRecord &record, const IHittable &object,
+						   const Color &attenuation) {
+	Vec3 direction = lights.sample(record.p);
+	float light_pdf = lights.pdf(record.p, direction);
+	float bsdf_pdf = MaterialRegistry::scatteringPdf(record.material_id, ray, record, direction);
+	if (light_pdf <= 0 || bsdf_pdf <= 0) {
+		return Color{0, 0, 0};
+	}
+	// the shadow ray takes whatever it hits first, a light in front of the sampled one still counts
+	Ray shadow(record.p, direction, ray.time());
+	HitRecord light_record;
+	worker_path_stats.shadow_rays++;
+	if (!object.hit(shadow, Interval(EPS, INF), light_record)) {
+		return Color{0, 0, 0};
+	}
+	Color emission =
+			MaterialRegistry::emitted(light_record.material_id, light_record.u, light_record.v, light_record.p);
+	return attenuation.cwiseProduct(emission) * (bsdf_pdf * powerHeuristic(light_pdf, bsdf_pdf) / light_pdf);
 }
 
 int Camera::getSampleCount() const { return sample_count; }
-Eigen::Vector3d Camera::randomDisplacement() const {
+Vec3 Camera::randomDisplacement() const {
 	auto delta_x = pix_delta_x * (randomFloat() - 0.5);
 	auto delta_y = pix_delta_y * (randomFloat() - 0.5);
 	return delta_x + delta_y;
@@ -283,9 +703,9 @@ void Camera::setTarget(const Point3 &target) {
 	Camera::target = target;
 	auto dir_vec = position - target;
 	rotation_matrix =
-			Eigen::Quaternion<double>::FromTwoVectors(Eigen::Vector3d::UnitZ(), position - target).toRotationMatrix();
+			Quat::FromTwoVectors(Vec3::UnitZ(), position - target).toRotationMatrix();
 	auto angle = rotation_matrix.canonicalEulerAngles(2, 1, 0);
-	rotation_ypr = Eigen::Vector3d{angle(0, 0), angle(1, 0), angle(2, 0)};
+	rotation_ypr = Vec3{angle(0, 0), angle(1, 0), angle(2, 0)};
 	updateVectors();
 }
 float Camera::getDofAngle() const { return dof_angle; }
@@ -299,9 +719,9 @@ void Camera::setFocalLen(float focalLen) {
 }
 
 Ray Camera::getRay(int x, int y) {
-	auto pixel_vec = pixel_00 + pix_delta_x * x + pix_delta_y * y + randomDisplacement();
+	Point3 pixel_vec = pixel_00 + pix_delta_x * x + pix_delta_y * y + randomDisplacement();
 	auto origin = dof_angle <= 0 ? position : dofDiskSample();
-	auto direction = pixel_vec - origin;
+	Vec3 direction = pixel_vec - origin;
 	auto time = randomFloat(0, shutter_speed);
 	return Ray(origin, direction, time);
 }
@@ -0,0 +1,133 @@
+/**
+ * @file Checkpoint.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "Checkpoint.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "spdlog/spdlog.h"
+
+namespace {
+	constexpr char checkpoint_magic[8] = {'H', 'K', 'T', 'R', 'C', 'K', 'P', 'T'};
+	constexpr uint32_t checkpoint_version = 2;
+	// slots start on page boundaries so each one can be synced on its own
+	constexpr size_t page_size = 4096;
+
+	size_t alignPage(size_t size) { return (size + page_size - 1) / page_size * page_size; }
+} // namespace
+
+Checkpoint::Checkpoint(const std::string &filepath, int width, int height, int frame, uint64_t fingerprint) :
+	filepath(filepath), img_width(width), img_height(height) {
+	auto pixels = static_cast<size_t>(width) * height;
+	slot_size = alignPage(pixels * 3 * sizeof(float) + pixels * sizeof(uint32_t));
+	file_size = page_size + 2 * slot_size;
+	fd = ::open(filepath.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd == -1) {
+		spdlog::error("cannot open checkpoint {}: {}", filepath, std::strerror(errno));
+		return;
+	}
+	struct stat st{};
+	bool had_data = fstat(fd, &st) == 0 && st.st_size != 0;
+	bool reuse = had_data && static_cast<size_t>(st.st_size) == file_size;
+	if (!reuse && ftruncate(fd, static_cast<off_t>(file_size)) == -1) {
+		spdlog::error("cannot resize checkpoint {}: {}", filepath, std::strerror(errno));
+		::close(fd);
+		fd = -1;
+		return;
+	}
+	void *memory = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (memory == MAP_FAILED) {
+		spdlog::error("cannot map checkpoint {}: {}", filepath, std::strerror(errno));
+		::close(fd);
+		fd = -1;
+		return;
+	}
+	mapping = static_cast<std::byte *>(memory);
+	auto header = reinterpret_cast<Header *>(mapping);
+	reuse = reuse && std::memcmp(header->magic, checkpoint_magic, sizeof(checkpoint_magic)) == 0 &&
+			header->version == checkpoint_version && header->width == width && header->height == height &&
+			header->frame == frame && header->fingerprint == fingerprint && header->current < 2;
+	if (!reuse) {
+		if (had_data) {
+			spdlog::warn("checkpoint {} belongs to another render, starting over", filepath);
+		}
+		std::memset(header, 0, sizeof(Header));
+		std::memcpy(header->magic, checkpoint_magic, sizeof(checkpoint_magic));
+		header->version = checkpoint_version;
+		header->width = width;
+		header->height = height;
+		header->frame = frame;
+		header->fingerprint = fingerprint;
+		msync(mapping, page_size, MS_SYNC);
+	}
+}
+
+Checkpoint::~Checkpoint() {
+	if (mapping != nullptr) {
+		munmap(mapping, file_size);
+	}
+	if (fd != -1) {
+		::close(fd);
+	}
+}
+
+bool Checkpoint::isOpen() const { return mapping != nullptr; }
+
+uint32_t Checkpoint::samplesDone() const {
+	if (!isOpen())
+		return 0;
+	auto header = reinterpret_cast<const Header *>(mapping);
+	return header->samples_done[header->current];
+}
+
+uint32_t Checkpoint::restore(Framebuffer &img) const {
+	auto samples = samplesDone();
+	if (samples == 0)
+		return 0;
+	auto current = reinterpret_cast<const Header *>(mapping)->current;
+	const auto row = static_cast<size_t>(img_width);
+	for (int y = 0; y < img_height; y++) {
+		std::memcpy(img.colorRow(y), slotColor(current) + y * row * 3, row * 3 * sizeof(float));
+		std::memcpy(img.sampleCountRow(y), slotSampleCount(current) + y * row, row * sizeof(uint32_t));
+	}
+	return samples;
+}
+
+bool Checkpoint::save(const Framebuffer &img, uint32_t samples_done) {
+	if (!isOpen())
+		return false;
+	auto header = reinterpret_cast<Header *>(mapping);
+	auto slot = 1 - header->current;
+	const auto row = static_cast<size_t>(img_width);
+	for (int y = 0; y < img_height; y++) {
+		std::memcpy(slotColor(slot) + y * row * 3, img.colorRow(y), row * 3 * sizeof(float));
+		std::memcpy(slotSampleCount(slot) + y * row, img.sampleCountRow(y), row * sizeof(uint32_t));
+	}
+	// the slot has to be on disk before the header points at it
+	if (msync(mapping + page_size + slot * slot_size, slot_size, MS_SYNC) == -1) {
+		spdlog::error("cannot sync checkpoint {}: {}", filepath, std::strerror(errno));
+		return false;
+	}
+	header->samples_done[slot] = samples_done;
+	header->current = slot;
+	if (msync(mapping, page_size, MS_SYNC) == -1) {
+		spdlog::error("cannot sync checkpoint {}: {}", filepath, std::strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+float *Checkpoint::slotColor(uint32_t slot) const {
+	return reinterpret_cast<float *>(mapping + page_size + slot * slot_size);
+}
+
+uint32_t *Checkpoint::slotSampleCount(uint32_t slot) const {
+	return reinterpret_cast<uint32_t *>(mapping + page_size + slot * slot_size +
+										static_cast<size_t>(img_width) * img_height * 3 * sizeof(float));
+}
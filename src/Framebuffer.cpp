@@ -0,0 +1,128 @@
+/**
+ * @file Framebuffer.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "Framebuffer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+	constexpr size_t alignment = 64;
+
+	size_t alignUp(size_t size) { return (size + alignment - 1) / alignment * alignment; }
+} // namespace
+
+Framebuffer::Framebuffer(int width, int height, uint32_t channels) :
+	img_width(width), img_height(height), channels(channels) {
+	auto pixels = static_cast<size_t>(width) * height;
+	size_t offset = 0;
+	auto reserve = [&](size_t bytes) {
+		auto start = offset;
+		offset += alignUp(bytes);
+		return start;
+	};
+	color_offset = reserve(pixels * 3 * sizeof(float));
+	if (channels & FB_ALPHA)
+		alpha_offset = reserve(pixels * sizeof(float));
+	if (channels & FB_DEPTH)
+		depth_offset = reserve(pixels * sizeof(float));
+	if (channels & FB_NORMAL)
+		normal_offset = reserve(pixels * 3 * sizeof(float));
+	if (channels & FB_SAMPLE_COUNT)
+		sample_count_offset = reserve(pixels * sizeof(uint32_t));
+	byte_size = std::max(offset, alignment);
+	auto memory = static_cast<std::byte *>(std::aligned_alloc(alignment, byte_size));
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	storage.reset(memory);
+	clear();
+}
+
+void Framebuffer::AlignedFree::operator()(std::byte *p) const { std::free(p); }
+
+int Framebuffer::width() const { return img_width; }
+
+int Framebuffer::height() const { return img_height; }
+
+bool Framebuffer::hasChannel(FramebufferChannel channel) const { return (channels & channel) != 0; }
+
+void Framebuffer::clear() { std::memset(storage.get(), 0, byte_size); }
+
+Color Framebuffer::getColor(int x, int y) const {
+	auto p = colorRow(y) + 3 * x;
+	return Color{p[0], p[1], p[2]};
+}
+
+void Framebuffer::setColor(int x, int y, const Color &c) {
+	auto p = colorRow(y) + 3 * x;
+	p[0] = static_cast<float>(c[0]);
+	p[1] = static_cast<float>(c[1]);
+	p[2] = static_cast<float>(c[2]);
+}
+
+float *Framebuffer::colorRow(int y) { return plane<float>(color_offset, y, 3); }
+
+const float *Framebuffer::colorRow(int y) const { return plane<float>(color_offset, y, 3); }
+
+float *Framebuffer::alphaRow(int y) { return hasChannel(FB_ALPHA) ? plane<float>(alpha_offset, y, 1) : nullptr; }
+
+float *Framebuffer::depthRow(int y) { return hasChannel(FB_DEPTH) ? plane<float>(depth_offset, y, 1) : nullptr; }
+
+float *Framebuffer::normalRow(int y) { return hasChannel(FB_NORMAL) ? plane<float>(normal_offset, y, 3) : nullptr; }
+
+uint32_t *Framebuffer::sampleCountRow(int y) {
+	return hasChannel(FB_SAMPLE_COUNT) ? plane<uint32_t>(sample_count_offset, y, 1) : nullptr;
+}
+
+const uint32_t *Framebuffer::sampleCountRow(int y) const {
+	return hasChannel(FB_SAMPLE_COUNT) ? plane<uint32_t>(sample_count_offset, y, 1) : nullptr;
+}
+
+FramebufferTile Framebuffer::tile(const ImageChunk &chunk) { return FramebufferTile(*this, chunk); }
+
+FramebufferTile::FramebufferTile(Framebuffer &target, const ImageChunk &chunk) : target(target), region(chunk) {}
+
+const ImageChunk &FramebufferTile::chunk() const { return region; }
+
+void FramebufferTile::setColor(int x, int y, const Color &c) {
+	target.setColor(region.startx + x, region.starty + y, c);
+}
+
+Color FramebufferTile::getColor(int x, int y) const { return target.getColor(region.startx + x, region.starty + y); }
+
+void FramebufferTile::setSampleCount(int x, int y, uint32_t count) {
+	if (auto row = target.sampleCountRow(region.starty + y))
+		row[region.startx + x] = count;
+}
+
+uint32_t FramebufferTile::getSampleCount(int x, int y) const {
+	auto row = target.sampleCountRow(region.starty + y);
+	return row == nullptr ? 0 : row[region.startx + x];
+}
+
+void FramebufferTile::accumulateColor(int x, int y, const Color &sum, uint32_t samples) {
+	auto previous = getSampleCount(x, y);
+	auto total = previous + samples;
+	setColor(x, y, (getColor(x, y) * static_cast<double>(previous) + sum) / static_cast<double>(total));
+	setSampleCount(x, y, total);
+}
+
+void FramebufferTile::setDepth(int x, int y, float depth) {
+	if (auto row = target.depthRow(region.starty + y))
+		row[region.startx + x] = depth;
+}
+
+void FramebufferTile::setNormal(int x, int y, const Vec3 &normal) {
+	if (auto row = target.normalRow(region.starty + y)) {
+		auto p = row + 3 * (region.startx + x);
+		p[0] = static_cast<float>(normal[0]);
+		p[1] = static_cast<float>(normal[1]);
+		p[2] = static_cast<float>(normal[2]);
+	}
+}
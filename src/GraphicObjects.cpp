@@ -11,56 +11,214 @@
 #include "MathUtil.h"
 #include <memory>
 
-Sphere::Sphere(float radius, Eigen::Vector3d position,
+namespace {
+/**
+ * a packet against the plane normal . x = D in float, for the flat
+ * primitives. a and b are the coordinates of the hits along a_axis and
+ * b_axis measured from Q, each with a bound on its rounding error. in_range
+ * holds the lanes whose t may fall inside (t_min, t_max), grazing the nearly
+ * parallel lanes, which are left to the exact test
+ */
+struct PlanePacketHit {
+    Float8 a, b;
+    Float8 a_slack, b_slack;
+    Mask8 in_range;
+    Mask8 grazing;
+};
+
+PlanePacketHit planePacket(const RayPacket &packet, float t_min,
+                           const Vec3 &normal, Real D, const Vec3 &Q,
+                           const Vec3 &a_axis, const Vec3 &b_axis) {
+    auto dx = Float8::load(packet.dx);
+    auto dy = Float8::load(packet.dy);
+    auto dz = Float8::load(packet.dz);
+    auto ox = Float8::load(packet.ox);
+    auto oy = Float8::load(packet.oy);
+    auto oz = Float8::load(packet.oz);
+    auto nx = Float8::broadcast(normal.x());
+    auto ny = Float8::broadcast(normal.y());
+    auto nz = Float8::broadcast(normal.z());
+    auto denom = nx * dx + ny * dy + nz * dz;
+    auto t = (Float8::broadcast(D) - (nx * ox + ny * oy + nz * oz)) / denom;
+    auto px = ox + t * dx - Float8::broadcast(Q.x());
+    auto py = oy + t * dy - Float8::broadcast(Q.y());
+    auto pz = oz + t * dz - Float8::broadcast(Q.z());
+    auto a = px * Float8::broadcast(a_axis.x()) +
+             py * Float8::broadcast(a_axis.y()) +
+             pz * Float8::broadcast(a_axis.z());
+    auto b = px * Float8::broadcast(b_axis.x()) +
+             py * Float8::broadcast(b_axis.y()) +
+             pz * Float8::broadcast(b_axis.z());
+    // rounding the origin to float moves t by about |o| * eps / |n . d|, a
+    // ray leaving the surface it starts on depends on that near t_min
+    auto o_magnitude = abs(ox) + abs(oy) + abs(oz);
+    auto t_slack =
+        (o_magnitude + Float8::broadcast(std::fabs(D))) *
+            Float8::broadcast(1e-5f) / abs(denom) +
+        abs(t) * Float8::broadcast(1e-4f);
+    auto p_slack =
+        t_slack * (abs(dx) + abs(dy) + abs(dz)) +
+        (o_magnitude + Float8::broadcast(Q.lpNorm<1>())) *
+            Float8::broadcast(1e-5f);
+    auto a_slack = Float8::broadcast(1e-4f) +
+                   p_slack * Float8::broadcast(a_axis.lpNorm<1>());
+    auto b_slack = Float8::broadcast(1e-4f) +
+                   p_slack * Float8::broadcast(b_axis.lpNorm<1>());
+    auto in_range = (t + t_slack > Float8::broadcast(t_min)) &
+                    (t - t_slack < Float8::load(packet.t_max));
+    auto grazing = abs(denom) < Float8::broadcast(1e-6f);
+    return {a, b, a_slack, b_slack, in_range, grazing};
+}
+} // namespace
+
+Sphere::Sphere(Real radius, Vec3 position,
                std::shared_ptr<IMaterial> mat)
-    : radius(radius), position(std::move(position)), material(std::move(mat)) {
-    auto rvec = Eigen::Vector3d{radius, radius, radius};
+    : radius(radius), position(std::move(position)),
+      material_id(MaterialRegistry::instance().add(mat)) {
+    auto rvec = Vec3{radius, radius, radius};
     bbox = AABB(this->position - rvec, this->position + rvec);
 }
 
 bool Sphere::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    auto sphere_center = getPosition(r.time());
-    std::shared_ptr<Eigen::Vector3d> oc =
-        std::make_shared<Eigen::Vector3d>(r.pos() - sphere_center);
-    auto a = r.dir().squaredNorm();
-    auto h = oc->dot(r.dir());
-    auto c = oc->squaredNorm() - radius * radius;
-
-    auto discriminant = h * h - a * c;
-    if (discriminant < 0)
-        return false;
-    auto discri_sqrt = std::sqrt(discriminant);
+    return intersect(r, getPosition(r.time()), radius, material_id, interval,
+                     record);
+}
 
-    auto root = (-h - discri_sqrt) / a;
-    if (!interval.surround(root)) {
-        root = (-h + discri_sqrt) / a;
-        if (!interval.surround(root)) {
-            return false;
-        }
+bool Sphere::intersect(const Ray &r, const Point3 &center, Real radius,
+                       uint32_t material_id, Interval interval,
+                       HitRecord &record) {
+    Real root;
+    if (!sphereRoot<Real>(r, center, radius, interval.min, interval.max,
+                          root)) {
+        return false;
     }
     record.t = root;
     record.p = r.at(record.t);
-    auto out_normal = (record.p - sphere_center) / radius;
+    auto out_normal = (record.p - center) / radius;
     record.setFaceNormal(r, out_normal);
     getSphereUV(out_normal, record.u, record.v);
-    record.material = material;
+    record.material_id = material_id;
     return true;
 }
 
-void Sphere::getSphereUV(const Point3 &p, float &u, float &v) {
-    float theta = std::acos(-p[1]);
-    float phi = std::atan2(-p[2], p[0]) + PI;
+uint32_t Sphere::hitPacket(RayPacket &packet, uint32_t lanes, float t_min,
+                           HitRecord *records) const {
+    if (is_moving) {
+        return IHittable::hitPacket(packet, lanes, t_min, records);
+    }
+    // the float test only culls, lanes that survive are confirmed by hit()
+    auto zero = Float8::broadcast(0);
+    auto ox = Float8::load(packet.ox);
+    auto oy = Float8::load(packet.oy);
+    auto oz = Float8::load(packet.oz);
+    auto dx = Float8::load(packet.dx);
+    auto dy = Float8::load(packet.dy);
+    auto dz = Float8::load(packet.dz);
+    auto ocx = ox - Float8::broadcast(position.x());
+    auto ocy = oy - Float8::broadcast(position.y());
+    auto ocz = oz - Float8::broadcast(position.z());
+    auto a = dx * dx + dy * dy + dz * dz;
+    auto h = ocx * dx + ocy * dy + ocz * dz;
+    auto oc2 = ocx * ocx + ocy * ocy + ocz * ocz;
+    auto r2 = Float8::broadcast(radius * radius);
+    auto discriminant = h * h - a * (oc2 - r2);
+    auto tolerance = (h * h + a * (oc2 + r2)) * Float8::broadcast(1e-5f);
+    auto discri_sqrt = sqrt(max(discriminant, zero));
+    auto near = (zero - h - discri_sqrt) / a;
+    auto far = (discri_sqrt - h) / a;
+    // rounding the origin to float shifts t by about |o| * eps / |d|, and a
+    // nearly tangent ray turns the discriminant error into a root error
+    auto magnitude = abs(ox) + abs(oy) + abs(oz) +
+                     Float8::broadcast(position.lpNorm<1>() + radius);
+    auto slack = magnitude * Float8::broadcast(1e-5f) / sqrt(a) +
+                 sqrt(tolerance) / a + abs(far) * Float8::broadcast(1e-4f);
+    auto candidates = (discriminant + tolerance >= zero) &
+                      (far + slack > Float8::broadcast(t_min)) &
+                      (near - slack < Float8::load(packet.t_max));
+    return IHittable::hitPacket(packet, lanes & candidates.bits(), t_min,
+                                records);
+}
+
+void Sphere::collectLights(std::vector<const IHittable *> &lights) const {
+    if (!is_moving && MaterialRegistry::isEmissive(material_id)) {
+        lights.push_back(this);
+    }
+}
+
+Vec3 Sphere::sampleDirection(const Point3 &origin) const {
+    Vec3 to_center = position - origin;
+    auto center_distance2 = to_center.squaredNorm();
+    if (center_distance2 <= radius * radius) {
+        // from inside every direction hits the sphere, the cone widens to
+        // the whole sphere of directions
+        return randomUnitVec3();
+    }
+    // 1 - cos_max without the cancellation of 1 - sqrt(1 - r^2 / d^2), which
+    // rounds to 0 in float for a small or distant sphere
+    auto sin2_max = radius * radius / center_distance2;
+    auto one_minus_cos = sin2_max / (1 + std::sqrt(1 - sin2_max));
+    auto one_minus_cos_theta = randomFloat() * one_minus_cos;
+    auto cos_theta = 1 - one_minus_cos_theta;
+    // sin^2 = (1 - cos) * (1 + cos), again without subtracting from 1
+    auto sin_theta =
+        std::sqrt(one_minus_cos_theta * (2 - one_minus_cos_theta));
+    auto phi = 2 * PI * randomFloat();
+    // any basis around the direction to the center will do
+    Vec3 w = to_center.normalized();
+    Vec3 a = std::fabs(w.x()) > 0.9 ? Vec3::UnitY() : Vec3::UnitX();
+    Vec3 v = w.cross(a).normalized();
+    Vec3 u = w.cross(v);
+    return std::cos(phi) * sin_theta * u + std::sin(phi) * sin_theta * v +
+           cos_theta * w;
+}
+
+float Sphere::directionPdf(const Point3 &origin,
+                           const Vec3 &direction) const {
+    HitRecord record;
+    if (!hit(Ray(origin, direction), Interval(EPS, INF), record)) {
+        return 0;
+    }
+    auto center_distance2 = (position - origin).squaredNorm();
+    if (center_distance2 <= radius * radius) {
+        return static_cast<float>(1 / (4 * PI));
+    }
+    auto sin2_max = radius * radius / center_distance2;
+    auto one_minus_cos = sin2_max / (1 + std::sqrt(1 - sin2_max));
+    return static_cast<float>(1 / (2 * PI * one_minus_cos));
+}
+
+void Sphere::getSphereUV(const Point3 &p, Real &u, Real &v) {
+    Real theta = std::acos(-p[1]);
+    Real phi = std::atan2(-p[2], p[0]) + PI;
     u = phi / (2 * PI);
     v = theta / PI;
 }
 
-void HitRecord::setFaceNormal(const Ray &r, const Eigen::Vector3d &normal_out) {
+void HitRecord::setFaceNormal(const Ray &r, const Vec3 &normal_out) {
     front_face = normal_out.dot(r.dir()) < 0;
     normal = front_face ? normal_out : -normal_out;
 }
 
 auto HittableList::end() { return objects.end(); }
 
+void IHittable::collectLights(std::vector<const IHittable *> &lights) const {}
+
+Vec3 IHittable::sampleDirection(const Point3 &origin) const {
+    return Vec3::UnitX();
+}
+
+float IHittable::directionPdf(const Point3 &origin,
+                              const Vec3 &direction) const {
+    return 0;
+}
+
+void HittableList::collectLights(
+    std::vector<const IHittable *> &lights) const {
+    for (const auto &i : objects) {
+        i->collectLights(lights);
+    }
+}
+
 bool HittableList::hit(const Ray &r, Interval interval,
                        HitRecord &record) const {
     HitRecord temp_rec;
@@ -76,6 +234,28 @@ bool HittableList::hit(const Ray &r, Interval interval,
     return if_hit;
 }
 
+uint32_t IHittable::hitPacket(RayPacket &packet, uint32_t lanes, float t_min,
+                              HitRecord *records) const {
+    uint32_t hits = 0;
+    forEachLane(lanes, [&](int lane) {
+        if (hit(packet.rays[lane], Interval(t_min, packet.t_max[lane]),
+                records[lane])) {
+            packet.t_max[lane] = records[lane].t;
+            hits |= 1u << lane;
+        }
+    });
+    return hits;
+}
+
+uint32_t HittableList::hitPacket(RayPacket &packet, uint32_t lanes,
+                                 float t_min, HitRecord *records) const {
+    uint32_t hits = 0;
+    for (const auto &i : objects) {
+        hits |= i->hitPacket(packet, lanes, t_min, records);
+    }
+    return hits;
+}
+
 HittableList::HittableList(const std::shared_ptr<IHittable> &obj) {
     add(obj);
     bbox = obj->boundingBox();
@@ -83,7 +263,9 @@ HittableList::HittableList(const std::shared_ptr<IHittable> &obj) {
 
 void HittableList::add(const std::shared_ptr<IHittable> &obj) {
     objects.push_back(obj);
-    bbox = AABB(bbox, obj->boundingBox());
+    // a default AABB spans everything, so the first object starts the box
+    bbox = objects.size() == 1 ? obj->boundingBox()
+                               : AABB(bbox, obj->boundingBox());
 }
 
 void HittableList::clear() {
@@ -94,103 +276,65 @@ void HittableList::clear() {
 auto HittableList::begin() { return objects.begin(); }
 AABB HittableList::boundingBox() const { return bbox; }
 
-Sphere::Sphere(float radius, const Point3 &init_position,
+Sphere::Sphere(Real radius, const Point3 &init_position,
                const Point3 &final_position, std::shared_ptr<IMaterial> mat)
-    : radius(radius), position(init_position), material(std::move(mat)) {
+    : radius(radius), position(init_position),
+      material_id(MaterialRegistry::instance().add(mat)) {
     direction_vec = final_position - init_position;
-    is_moving = true;
-    auto rvec = Eigen::Vector3d{radius, radius, radius};
+    // a zero displacement is a static sphere, keep it on the fast paths
+    is_moving = !direction_vec.isZero(0);
+    auto rvec = Vec3{radius, radius, radius};
     auto bbox1 = AABB(init_position - rvec, init_position + rvec);
     auto bbox2 = AABB(final_position - rvec, final_position + rvec);
     bbox = AABB(bbox1, bbox2);
 }
 
-Eigen::Vector3d Sphere::getPosition(float time) const {
+Vec3 Sphere::getPosition(Real time) const {
     return is_moving ? position + time * direction_vec : position;
 }
 
 AABB Sphere::boundingBox() const { return bbox; }
 
-bool BVHNode::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    if (!bbox.hit(r, interval)) {
-        return false;
-    }
-    bool hit_left = left->hit(r, interval, record);
-    bool hit_right = right->hit(
-        r, Interval(interval.min, hit_left ? record.t : interval.max), record);
-    return hit_left || hit_right;
-}
-
-AABB BVHNode::boundingBox() const { return bbox; }
+AABB Quad::boundingBox() const { return bbox; }
 
-bool BVHNode::compare(const std::shared_ptr<IHittable> &a,
-                      const std::shared_ptr<IHittable> &b, int axis) {
-    return a->boundingBox().axis(axis).min < b->boundingBox().axis(axis).min;
+void Quad::setBoundingBox() {
+    // both diagonals, a single one misses corners once u or v point backwards
+    bbox = AABB(AABB(Q, Q + u + v), AABB(Q + u, Q + v)).pad();
 }
 
-bool BVHNode::compareX(const std::shared_ptr<IHittable> &a,
-                       const std::shared_ptr<IHittable> &b) {
-    return compare(a, b, 0);
+Quad::Quad(const Vec3 &Q, const Vec3 &u,
+           const Vec3 &v, std::shared_ptr<IMaterial> mat)
+    : Q(Q), u(u), v(v), material_id(MaterialRegistry::instance().add(mat)) {
+    auto n = u.cross(v);
+    normal = n.normalized();
+    D = normal.dot(Q);
+    area = n.norm();
+    w = n / n.dot(n);
+    setBoundingBox();
 }
 
-bool BVHNode::compareY(const std::shared_ptr<IHittable> &a,
-                       const std::shared_ptr<IHittable> &b) {
-    return compare(a, b, 1);
+void Quad::collectLights(std::vector<const IHittable *> &lights) const {
+    if (MaterialRegistry::isEmissive(material_id)) {
+        lights.push_back(this);
+    }
 }
 
-bool BVHNode::compareZ(const std::shared_ptr<IHittable> &a,
-                       const std::shared_ptr<IHittable> &b) {
-    return compare(a, b, 2);
+Vec3 Quad::sampleDirection(const Point3 &origin) const {
+    return Q + randomFloat() * u + randomFloat() * v - origin;
 }
 
-BVHNode::BVHNode(const HittableList &list)
-    : BVHNode(list.objects, 0, list.objects.size()) {}
-
-BVHNode::BVHNode(const std::vector<std::shared_ptr<IHittable>> &objects,
-                 size_t start, size_t end) {
-    auto modifiable_objects = objects;
-    auto axis = randomInt(0, 2);
-    auto comparator = (axis == 0)   ? compareX
-                      : (axis == 1) ? compareY
-                                    : compareZ;
-    auto object_span = end - start;
-
-    if (object_span == 1) {
-        left = right = objects[start];
-    } else if (object_span == 2) {
-        if (comparator(objects[start], objects[start + 1])) {
-            left = objects[start];
-            right = objects[start + 1];
-        } else {
-            left = objects[start + 1];
-            right = objects[start];
-        }
-    } else {
-        std::sort(modifiable_objects.begin() + start,
-                  modifiable_objects.begin() + end, comparator);
-        auto mid = start + object_span / 2;
-        left = std::make_shared<BVHNode>(modifiable_objects, start, mid);
-        right = std::make_shared<BVHNode>(modifiable_objects, mid, end);
+float Quad::directionPdf(const Point3 &origin, const Vec3 &direction) const {
+    HitRecord record;
+    if (!hit(Ray(origin, direction), Interval(EPS, INF), record)) {
+        return 0;
     }
-
-    bbox = AABB(left->boundingBox(), right->boundingBox());
-}
-
-AABB Quad::boundingBox() const { return bbox; }
-
-void Quad::setBoundingBox() { bbox = AABB(Q, Q + u + v).pad(); }
-
-Quad::Quad(const Eigen::Vector3d &Q, const Eigen::Vector3d &u,
-           const Eigen::Vector3d &v, std::shared_ptr<IMaterial> mat)
-    : Q(Q), u(u), v(v), mat(mat) {
-    auto n = u.cross(v);
-    normal = n.normalized();
-    D = normal.dot(Q);
-    w = n / n.dot(n);
-    setBoundingBox();
+    // area density turned into solid angle density, distance^2 / cos
+    auto distance_squared = record.t * record.t * direction.squaredNorm();
+    auto cos = std::fabs(direction.dot(normal)) / direction.norm();
+    return static_cast<float>(distance_squared / (cos * area));
 }
 
-bool Quad::inside(float a, float b, HitRecord &rec) const {
+bool Quad::inside(Real a, Real b, HitRecord &rec) const {
     if (a < 0 || a > 1 || b < 0 || b > 1)
         return false;
     rec.u = a;
@@ -199,7 +343,7 @@ bool Quad::inside(float a, float b, HitRecord &rec) const {
 }
 
 bool Quad::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    float denom = normal.dot(r.dir());
+    Real denom = normal.dot(r.dir());
     if (fabs(denom) < 1e-8) {
         return false;
     }
@@ -216,39 +360,81 @@ bool Quad::hit(const Ray &r, Interval interval, HitRecord &record) const {
     }
     record.t = t;
     record.p = intersection;
-    record.material = mat;
+    record.material_id = material_id;
     record.setFaceNormal(r, normal);
 
     return true;
 }
 
-Triangle::Triangle(const Eigen::Vector3d &Q, const Eigen::Vector3d &u,
-                   const Eigen::Vector3d &v, std::shared_ptr<IMaterial> mat)
-    : Q(Q), u(u), v(v), mat(mat) {
+uint32_t Quad::hitPacket(RayPacket &packet, uint32_t lanes, float t_min,
+                         HitRecord *records) const {
+    // alpha = w . (p x v) = p . (v x w), beta = w . (u x p) = p . (w x u)
+    auto hit = planePacket(packet, t_min, normal, D, Q, v.cross(w), w.cross(u));
+    auto zero = Float8::broadcast(0);
+    auto one = Float8::broadcast(1);
+    auto candidates = hit.in_range & (hit.a + hit.a_slack >= zero) &
+                      (hit.a - hit.a_slack <= one) &
+                      (hit.b + hit.b_slack >= zero) &
+                      (hit.b - hit.b_slack <= one);
+    return IHittable::hitPacket(
+        packet, lanes & (candidates | hit.grazing).bits(), t_min, records);
+}
+
+Triangle::Triangle(const Vec3 &Q, const Vec3 &u,
+                   const Vec3 &v, std::shared_ptr<IMaterial> mat)
+    : Q(Q), u(u), v(v), material_id(MaterialRegistry::instance().add(mat)) {
     auto n = v.cross(u);
     normal = n.normalized();
+    D = normal.dot(Q);
+    area = n.norm() / 2;
     w = n / n.dot(n);
     setBoundingBox();
 }
 
-void Triangle::setBoundingBox() { box = AABB(Q, Q + u + v).pad(); }
+void Triangle::collectLights(std::vector<const IHittable *> &lights) const {
+    if (MaterialRegistry::isEmissive(material_id)) {
+        lights.push_back(this);
+    }
+}
+
+Vec3 Triangle::sampleDirection(const Point3 &origin) const {
+    auto a = randomFloat();
+    auto b = randomFloat();
+    // fold the other half of the parallelogram back onto the triangle
+    if (a + b > 1) {
+        a = 1 - a;
+        b = 1 - b;
+    }
+    return Q + a * u + b * v - origin;
+}
+
+float Triangle::directionPdf(const Point3 &origin,
+                             const Vec3 &direction) const {
+    HitRecord record;
+    if (!hit(Ray(origin, direction), Interval(EPS, INF), record)) {
+        return 0;
+    }
+    auto distance_squared = record.t * record.t * direction.squaredNorm();
+    auto cos = std::fabs(direction.dot(normal)) / direction.norm();
+    return static_cast<float>(distance_squared / (cos * area));
+}
+
+void Triangle::setBoundingBox() {
+    box = AABB(AABB(Q, Q + u), AABB(Q, Q + v)).pad();
+}
 
 AABB Triangle::boundingBox() const { return box; }
 
-bool Triangle::inside(const Eigen::Vector3d &intersection) const {
-    auto side1 = v;
-    auto side2 = u - v;
-    auto side3 = -u;
-    auto dis1 = intersection - Q;
-    auto dis2 = intersection - (Q + side1);
-    auto dis3 = intersection - (Q + side1 + side2);
-    return (side1.cross(dis1).dot(normal) > 0 &&
-            side2.cross(dis2).dot(normal) > 0 &&
-            side3.cross(dis3).dot(normal) > 0);
+bool Triangle::inside(const Vec3 &intersection) const {
+    // with p - Q = a * u + b * v: a = w . (v x p), b = w . (p x u)
+    auto plane_hit_vec = intersection - Q;
+    auto alpha = w.dot(v.cross(plane_hit_vec));
+    auto beta = w.dot(plane_hit_vec.cross(u));
+    return alpha >= 0 && beta >= 0 && alpha + beta <= 1;
 }
 
 bool Triangle::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    float denom = normal.dot(r.dir());
+    Real denom = normal.dot(r.dir());
     if (fabs(denom) < 1e-8) {
         return false;
     }
@@ -260,82 +446,134 @@ bool Triangle::hit(const Ray &r, Interval interval, HitRecord &record) const {
     }
 
     auto intersection = r.at(t);
-    if (!inside(intersection)) {
+    // barycentric coordinates double as the inside test, no edge cross
+    // products needed
+    auto plane_hit_vec = intersection - Q;
+    auto alpha = w.dot(v.cross(plane_hit_vec));
+    auto beta = w.dot(plane_hit_vec.cross(u));
+    if (alpha < 0 || beta < 0 || alpha + beta > 1) {
         return false;
     }
-    auto plane_hit_vec = intersection - Q;
-    auto alpha = w.dot(plane_hit_vec.cross(u));
-    auto beta = w.dot(u.cross(plane_hit_vec));
     record.t = t;
     record.p = intersection;
-    record.material = mat;
+    record.material_id = material_id;
     record.setFaceNormal(r, normal);
     record.u = alpha;
     record.v = beta;
     return true;
 }
 
-Translate::Translate(std::shared_ptr<IHittable> obj,
-                     const Eigen::Vector3d &displacement)
-    : object(obj), offset(displacement) {
-    bbox.x = Interval(bbox.x.min + offset.x(), bbox.x.max + offset.x());
-    bbox.y = Interval(bbox.y.min + offset.y(), bbox.y.max + offset.y());
-    bbox.z = Interval(bbox.z.min + offset.z(), bbox.z.max + offset.z());
+uint32_t Triangle::hitPacket(RayPacket &packet, uint32_t lanes, float t_min,
+                             HitRecord *records) const {
+    // with p - Q = a * u + b * v: a = p . (w x v), b = p . (u x w)
+    auto hit = planePacket(packet, t_min, normal, D, Q, w.cross(v), u.cross(w));
+    auto zero = Float8::broadcast(0);
+    auto candidates =
+        hit.in_range & (hit.a + hit.a_slack >= zero) &
+        (hit.b + hit.b_slack >= zero) &
+        (hit.a + hit.b - hit.a_slack - hit.b_slack <= Float8::broadcast(1));
+    return IHittable::hitPacket(
+        packet, lanes & (candidates | hit.grazing).bits(), t_min, records);
 }
 
-AABB Translate::boundingBox() const { return bbox; }
-
-bool Translate::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    Ray offset_r = Ray(r.pos() - offset, r.dir(), r.time());
+Transform::Matrices::Matrices(const Affine3 &object_to_world)
+    : object_to_world(object_to_world),
+      world_to_object(object_to_world.inverse()),
+      normal_matrix(world_to_object.linear().transpose()) {}
+
+Transform::Transform(std::shared_ptr<IHittable> obj,
+                     const Affine3 &object_to_world)
+    : Transform(std::move(obj), object_to_world, object_to_world) {}
+
+Transform::Transform(std::shared_ptr<IHittable> obj,
+                     const Affine3 &start,
+                     const Affine3 &end)
+    : object(std::move(obj)), matrices(start),
+      moving(!start.isApprox(end, 0)) {
+    const Affine3 *ends[2] = {&start, &end};
+    for (int i = 0; i < 2; i++) {
+        Mat3 rotation_part;
+        ends[i]->computeRotationScaling(&rotation_part, &scale[i]);
+        rotation[i] = Quat(rotation_part);
+        translation[i] = ends[i]->translation();
+    }
 
-    if (!object->hit(offset_r, interval, record)) {
-        return false;
+    // every corner has to be transformed, a rotated box reaches past the
+    // images of its min and max corners
+    auto box = object->boundingBox();
+    Point3 corners[8];
+    for (int corner = 0; corner < 8; corner++) {
+        corners[corner] = Point3{corner & 1 ? box.x.max : box.x.min,
+                                 corner & 2 ? box.y.max : box.y.min,
+                                 corner & 4 ? box.z.max : box.z.min};
+    }
+    constexpr int steps = 32;
+    Real radius = 0;
+    bool first = true;
+    for (int i = 0; i <= (moving ? steps : 0); i++) {
+        auto transform =
+            moving ? at(static_cast<Real>(i) / steps).object_to_world : start;
+        for (const auto &corner : corners) {
+            Point3 world = transform * corner;
+            bbox = first ? AABB(world, world) : AABB(bbox, AABB(world, world));
+            first = false;
+            radius = std::max(radius, (world - transform.translation()).norm());
+        }
+    }
+    if (moving) {
+        // corners sweep arcs between the samples, pad by how far an arc can
+        // bulge out of the chord between two of them
+        auto angle = rotation[0].angularDistance(rotation[1]);
+        auto bulge = radius * (1 - std::cos(angle / (2 * steps)));
+        bbox = AABB(Point3{bbox.x.min - bulge, bbox.y.min - bulge,
+                           bbox.z.min - bulge},
+                    Point3{bbox.x.max + bulge, bbox.y.max + bulge,
+                           bbox.z.max + bulge});
     }
+}
 
-    record.p += offset;
+Transform::Matrices Transform::at(Real time) const {
+    Affine3 transform = Affine3::Identity();
+    transform.linear() =
+        rotation[0].slerp(time, rotation[1]).toRotationMatrix() *
+        ((1 - time) * scale[0] + time * scale[1]);
+    transform.translation() =
+        (1 - time) * translation[0] + time * translation[1];
+    return Matrices(transform);
+}
 
-    return true;
+AABB Transform::boundingBox() const { return bbox; }
+
+bool Transform::hit(const Ray &r, Interval interval, HitRecord &record) const {
+    if (moving) {
+        return hitWith(at(r.time()), r, interval, record);
+    }
+    return hitWith(matrices, r, interval, record);
 }
 
-Rotation::Rotation(std::shared_ptr<IHittable> obj, float psi, float theta,
-                   float phi, Point3 about_pt)
-    : object(obj), rotation_matrix(makeEulerRotationMatrixAboutPt(about_pt, psi,
-                                                                  theta, phi)),
-      inverse_rotation_matrix(
-          makeEulerRotationMatrixAboutPt(about_pt, -psi, -theta, -phi)) {
-    auto bbox_temp = obj->boundingBox();
-    auto min_vec =
-        Eigen::Vector4d{bbox_temp.x.min, bbox_temp.y.min, bbox_temp.z.min, 1};
-    auto max_vec =
-        Eigen::Vector4d{bbox_temp.x.max, bbox_temp.y.max, bbox_temp.z.max, 1};
-    min_vec = rotation_matrix * min_vec;
-    max_vec = rotation_matrix * max_vec;
-    auto new_min_vec = deHomo(min_vec);
-    auto new_max_vec = deHomo(max_vec);
-    bbox.x = Interval(std::min(bbox_temp.x.min, new_min_vec.x()),
-                      std::max(bbox_temp.x.max, new_max_vec.x()));
-    bbox.y = Interval(std::min(bbox_temp.y.min, new_min_vec.y()),
-                      std::max(bbox_temp.y.max, new_max_vec.y()));
-    bbox.z = Interval(std::min(bbox_temp.z.min, new_min_vec.z()),
-                      std::max(bbox_temp.z.max, new_max_vec.z()));
-}
-
-AABB Rotation::boundingBox() const { return bbox; }
-
-bool Rotation::hit(const Ray &r, Interval interval, HitRecord &record) const {
-    auto origin = r.pos();
-    auto dir = r.dir();
-
-    origin = deHomo(rotation_matrix * makeHomo(origin));
-    dir = deHomo(rotation_matrix * makeHomo(dir));
-    Ray rotated(origin, dir, r.time());
-
-    if (!object->hit(rotated, interval, record)) {
+bool Transform::hitWith(const Matrices &m, const Ray &r, Interval interval,
+                        HitRecord &record) const {
+    // the direction keeps its scale, so the hit distance is the same in both
+    // spaces
+    Ray local(m.world_to_object * r.pos(), m.world_to_object.linear() * r.dir(),
+              r.time());
+    if (!object->hit(local, interval, record)) {
         return false;
     }
-    auto inverse_transpose =
-        Eigen::Matrix4d(inverse_rotation_matrix.inverse().transpose());
-    record.normal = deHomo(inverse_transpose * makeHomo(record.normal));
-    record.p = deHomo(inverse_rotation_matrix * makeHomo(record.p));
+    record.p = m.object_to_world * record.p;
+    record.normal = (m.normal_matrix * record.normal).normalized();
     return true;
 }
+
+Translate::Translate(std::shared_ptr<IHittable> obj,
+                     const Vec3 &displacement)
+    : Transform(std::move(obj),
+                Affine3(Translation3(displacement))) {}
+
+Rotation::Rotation(std::shared_ptr<IHittable> obj, float psi, float theta,
+                   float phi, Point3 about_pt)
+    : Transform(std::move(obj),
+                Affine3(Eigen::Transform<Real, 3, Eigen::Affine>(
+                            makeEulerRotationMatrixAboutPt(about_pt, psi,
+                                                           theta, phi))
+                            .inverse())) {}
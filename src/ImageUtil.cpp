@@ -10,6 +10,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_FAILURE_USERMSG
 #include "ImageUtil.h"
+#include "Framebuffer.h"
+#include "ImageWriter.h"
 
 std::string getGreyScaleCharacter(float r, float g, float b) {
 	float sum = r * 255.0 * 0.299 + g * 255.0 * 0.587 + b * 255.0 * 0.114;
@@ -21,28 +23,27 @@ std::string getGreyScaleCharacter(float r, float g, float b) {
 float gammaCorrect(float c) { return std::pow(c, 1.0 / 2.0); }
 
 
-std::string makePPM(int width, int height, const std::vector<std::vector<Color>> &img, const std::string &name,
-					const std::string &path) {
-	auto fout = std::ofstream();
+std::string makePPM(const Framebuffer &img, const std::string &name, const std::string &path) {
 	std::string filepath = mkdir(path, name);
 	std::cout << filepath << std::endl;
 
-	fout.open(filepath);
-	fout << "P3\n" << width << ' ' << height << "\n255\n";
-	for (int i = 0; i < height; i++) {
-		for (int j = 0; j < width; j++) {
-			fout << makeColor(img[i][j]);
-		}
+	PPMWriter writer;
+	if (!writer.begin(filepath, img.width(), img.height())) {
+		spdlog::error("cannot open {} for writing", filepath);
+		return filepath;
 	}
-	fout.close();
+	writer.writeRows(img, 0, img.height());
+	writer.finish();
 	return filepath;
 }
 
-std::string makeGrayscaleString(int width, int height, std::vector<std::vector<Color>> img) {
+std::string makeGrayscaleString(const Framebuffer &img) {
 	std::stringstream ss;
-	for (int i = 0; i < height; ++i) {
-		for (int j = 0; j < width; ++j) {
-			ss << getGreyScaleCharacter(img[i][j][0], img[i][j][1], img[i][j][2]);
+	for (int i = 0; i < img.height(); ++i) {
+		auto row = img.colorRow(i);
+		for (int j = 0; j < img.width(); ++j) {
+			auto pixel = row + 3 * j;
+			ss << getGreyScaleCharacter(gammaCorrect(pixel[0]), gammaCorrect(pixel[1]), gammaCorrect(pixel[2]));
 		}
 		ss << std::endl;
 	}
@@ -50,12 +51,11 @@ std::string makeGrayscaleString(int width, int height, std::vector<std::vector<C
 }
 
 
-std::string makeGrayscaleTxt(int width, int height, const std::vector<std::vector<Color>> &img, const std::string &name,
-							 const std::string &path) {
+std::string makeGrayscaleTxt(const Framebuffer &img, const std::string &name, const std::string &path) {
 	auto fout = std::ofstream();
 	std::string filepath = mkdir(path, name);
 	fout.open(filepath);
-	fout << makeGrayscaleString(width, height, img);
+	fout << makeGrayscaleString(img);
 	fout.close();
 	return filepath;
 }
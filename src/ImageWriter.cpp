@@ -0,0 +1,178 @@
+/**
+ * @file ImageWriter.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "ImageWriter.h"
+#include <algorithm>
+#include "spdlog/spdlog.h"
+#include "stb_image_write.h"
+
+namespace {
+	uint8_t toByte(float linear) {
+		auto c = Interval(0, 1).clamp(gammaCorrect(std::max(linear, 0.0f)));
+		return static_cast<uint8_t>(255.999 * c);
+	}
+
+	void toBytes(const float *row, int width, uint8_t *out) {
+		for (int i = 0; i < width * 3; i++) {
+			out[i] = toByte(row[i]);
+		}
+	}
+} // namespace
+
+bool PPMWriter::begin(const std::string &filepath, int width, int height) {
+	img_width = width;
+	row_buffer.resize(static_cast<size_t>(width) * 3);
+	fout.open(filepath, std::ios::binary | std::ios::trunc);
+	if (!fout) {
+		return false;
+	}
+	fout << "P6\n" << width << ' ' << height << "\n255\n";
+	header_size = fout.tellp();
+	return static_cast<bool>(fout);
+}
+
+void PPMWriter::writeRows(const Framebuffer &img, int begin_row, int end_row) {
+	fout.seekp(header_size + static_cast<std::streamoff>(begin_row) * img_width * 3);
+	for (int y = begin_row; y < end_row; y++) {
+		toBytes(img.colorRow(y), img_width, row_buffer.data());
+		fout.write(reinterpret_cast<const char *>(row_buffer.data()), static_cast<std::streamsize>(row_buffer.size()));
+	}
+}
+
+bool PPMWriter::finish() {
+	fout.close();
+	return !fout.fail();
+}
+
+bool PNGWriter::begin(const std::string &filepath, int width, int height) {
+	this->filepath = filepath;
+	img_width = width;
+	img_height = height;
+	pixels.resize(static_cast<size_t>(width) * height * 3);
+	return true;
+}
+
+void PNGWriter::writeRows(const Framebuffer &img, int begin_row, int end_row) {
+	for (int y = begin_row; y < end_row; y++) {
+		toBytes(img.colorRow(y), img_width, pixels.data() + static_cast<size_t>(y) * img_width * 3);
+	}
+}
+
+bool PNGWriter::finish() {
+	return stbi_write_png(filepath.c_str(), img_width, img_height, 3, pixels.data(), img_width * 3) != 0;
+}
+
+bool PFMWriter::begin(const std::string &filepath, int width, int height) {
+	img_width = width;
+	img_height = height;
+	fout.open(filepath, std::ios::binary | std::ios::trunc);
+	if (!fout) {
+		return false;
+	}
+	// a negative scale marks little endian data
+	fout << "PF\n" << width << ' ' << height << "\n-1.0\n";
+	header_size = fout.tellp();
+	return static_cast<bool>(fout);
+}
+
+void PFMWriter::writeRows(const Framebuffer &img, int begin_row, int end_row) {
+	auto row_bytes = static_cast<std::streamoff>(img_width) * 3 * sizeof(float);
+	for (int y = begin_row; y < end_row; y++) {
+		// pfm stores the bottom row first
+		fout.seekp(header_size + (img_height - 1 - y) * row_bytes);
+		fout.write(reinterpret_cast<const char *>(img.colorRow(y)), row_bytes);
+	}
+}
+
+bool PFMWriter::finish() {
+	fout.close();
+	return !fout.fail();
+}
+
+std::unique_ptr<IImageWriter> makeImageWriter(const std::string &name) {
+	if (name.ends_with(".png")) {
+		return std::make_unique<PNGWriter>();
+	}
+	if (name.ends_with(".pfm")) {
+		return std::make_unique<PFMWriter>();
+	}
+	return std::make_unique<PPMWriter>();
+}
+
+AsyncImageWriter::AsyncImageWriter(std::unique_ptr<IImageWriter> writer, const std::string &filepath,
+								   const Framebuffer &img) :
+	writer(std::move(writer)), img(img), pixels_left(img.height(), img.width()) {
+	ok = this->writer->begin(filepath, img.width(), img.height());
+	if (!ok) {
+		spdlog::error("cannot open {} for writing", filepath);
+		return;
+	}
+	encoder = std::thread(&AsyncImageWriter::run, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+	if (encoder.joinable()) {
+		finish();
+	}
+}
+
+void AsyncImageWriter::chunkDone(const ImageChunk &chunk) {
+	if (!ok) {
+		return;
+	}
+	{
+		std::lock_guard lock(mutex);
+		for (int y = chunk.starty; y < chunk.starty + chunk.height; y++) {
+			pixels_left[y] -= chunk.width;
+			if (pixels_left[y] > 0)
+				continue;
+			if (!ready_rows.empty() && ready_rows.back().second == y) {
+				ready_rows.back().second = y + 1;
+			} else {
+				ready_rows.emplace_back(y, y + 1);
+			}
+		}
+	}
+	cv.notify_one();
+}
+
+bool AsyncImageWriter::finish() {
+	if (!ok) {
+		return false;
+	}
+	{
+		std::lock_guard lock(mutex);
+		finished = true;
+	}
+	cv.notify_one();
+	if (encoder.joinable()) {
+		encoder.join();
+	}
+	if (std::any_of(pixels_left.begin(), pixels_left.end(), [](int left) { return left > 0; })) {
+		// rows that never completed still go out with whatever the framebuffer holds
+		writer->writeRows(img, 0, img.height());
+	}
+	ok = writer->finish();
+	return ok;
+}
+
+void AsyncImageWriter::run() {
+	std::unique_lock lock(mutex);
+	while (true) {
+		cv.wait(lock, [this] { return finished || !ready_rows.empty(); });
+		while (!ready_rows.empty()) {
+			auto [begin_row, end_row] = ready_rows.front();
+			ready_rows.pop_front();
+			lock.unlock();
+			writer->writeRows(img, begin_row, end_row);
+			lock.lock();
+		}
+		if (finished)
+			break;
+	}
+}
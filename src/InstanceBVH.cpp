@@ -0,0 +1,134 @@
+/**
+ * @file InstanceBVH.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "InstanceBVH.h"
+#include "BVHBuilder.h"
+#include "Material.h"
+
+uint32_t InstanceBVH::addGeometry(std::shared_ptr<IHittable> geometry) {
+	geometries.push_back(std::move(geometry));
+	return static_cast<uint32_t>(geometries.size() - 1);
+}
+
+uint32_t InstanceBVH::addInstance(uint32_t geometry, const Affine3 &transform,
+								  const std::shared_ptr<IMaterial> &mat) {
+	Instance instance;
+	instance.geometry = geometry;
+	instance.material_id = mat == nullptr ? 0 : MaterialRegistry::instance().add(mat);
+	instances.push_back(instance);
+	setTransform(static_cast<uint32_t>(instances.size() - 1), transform);
+	return static_cast<uint32_t>(instances.size() - 1);
+}
+
+void InstanceBVH::setTransform(uint32_t instance, const Affine3 &transform) {
+	instances[instance].object_to_world = transform;
+	instances[instance].world_to_object = transform.inverse();
+}
+
+AABB InstanceBVH::worldBounds(const Instance &instance) const {
+	auto box = geometries[instance.geometry]->boundingBox();
+	if (box.x.min > box.x.max || box.y.min > box.y.max || box.z.min > box.z.max) {
+		return AABB(empty, empty, empty);
+	}
+	AABB bounds;
+	for (int corner = 0; corner < 8; corner++) {
+		Point3 p{corner & 1 ? box.x.max : box.x.min, corner & 2 ? box.y.max : box.y.min,
+				 corner & 4 ? box.z.max : box.z.min};
+		Point3 world = instance.object_to_world * p;
+		bounds = corner == 0 ? AABB(world, world) : AABB(bounds, AABB(world, world));
+	}
+	return bounds;
+}
+
+void InstanceBVH::build() {
+	nodes.clear();
+	instance_order.clear();
+	bbox = AABB(empty, empty, empty);
+	if (instances.empty()) {
+		return;
+	}
+	std::vector<AABB> bounds;
+	bounds.reserve(instances.size());
+	for (const auto &instance: instances) {
+		bounds.push_back(worldBounds(instance));
+		bbox = bounds.size() == 1 ? bounds.back() : AABB(bbox, bounds.back());
+	}
+	BVHBuildOptions options;
+	// entering an instance costs a ray transform and a whole bottom level traversal
+	options.intersection_cost = 4.0f;
+	auto result = buildBVH(bounds, options);
+	nodes = std::move(result.nodes);
+	instance_order = std::move(result.primitive_order);
+}
+
+size_t InstanceBVH::instanceCount() const { return instances.size(); }
+
+bool InstanceBVH::hitInstance(const Instance &instance, const Ray &r, Interval interval, HitRecord &record) const {
+	// the direction keeps its scale, so distances along the ray are the same in both spaces
+	Ray local(instance.world_to_object * r.pos(), instance.world_to_object.linear() * r.dir(), r.time());
+	if (!geometries[instance.geometry]->hit(local, interval, record)) {
+		return false;
+	}
+	record.p = instance.object_to_world * record.p;
+	// normals go through the inverse transpose, which keeps front_face valid as well
+	record.normal = (instance.world_to_object.linear().transpose() * record.normal).normalized();
+	if (instance.material_id != 0) {
+		record.material_id = instance.material_id;
+	}
+	return true;
+}
+
+bool InstanceBVH::hitLeaf(const LinearBVHNode &node, const Ray &r, Interval &interval, HitRecord &record) const {
+	bool hit_anything = false;
+	for (uint32_t i = 0; i < node.primitive_count; i++) {
+		if (hitInstance(instances[instance_order[node.primitive_offset + i]], r, interval, record)) {
+			hit_anything = true;
+			interval.max = record.t;
+		}
+	}
+	return hit_anything;
+}
+
+bool InstanceBVH::hit(const Ray &r, Interval interval, HitRecord &record) const {
+	if (nodes.empty()) {
+		return false;
+	}
+	return traverse(0, r, interval, record);
+}
+
+bool InstanceBVH::traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const {
+	return traverseLinearBVH(nodes.data(), root, r, interval, [&](const LinearBVHNode &node, Interval &range) {
+		return hitLeaf(node, r, range, record);
+	});
+}
+
+uint32_t InstanceBVH::hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const {
+	if (nodes.empty()) {
+		return 0;
+	}
+	return traverseLinearBVHPacket(
+			nodes.data(), packet, lanes, t_min,
+			[&](uint32_t node, int lane) {
+				if (!traverse(node, packet.rays[lane], Interval(t_min, packet.t_max[lane]), records[lane]))
+					return false;
+				packet.t_max[lane] = records[lane].t;
+				return true;
+			},
+			[&](const LinearBVHNode &node, uint32_t node_lanes) {
+				uint32_t hits = 0;
+				forEachLane(node_lanes, [&](int lane) {
+					Interval interval(t_min, packet.t_max[lane]);
+					if (hitLeaf(node, packet.rays[lane], interval, records[lane])) {
+						packet.t_max[lane] = records[lane].t;
+						hits |= 1u << lane;
+					}
+				});
+				return hits;
+			});
+}
+
+AABB InstanceBVH::boundingBox() const { return bbox; }
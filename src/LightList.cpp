@@ -0,0 +1,31 @@
+/**
+ * @file LightList.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "LightList.h"
+#include <algorithm>
+
+LightList::LightList(const IHittable &world) { world.collectLights(lights); }
+
+bool LightList::empty() const { return lights.empty(); }
+
+size_t LightList::size() const { return lights.size(); }
+
+Vec3 LightList::sample(const Point3 &origin) const {
+	auto idx = std::min(static_cast<size_t>(randomFloat() * lights.size()), lights.size() - 1);
+	return lights[idx]->sampleDirection(origin);
+}
+
+float LightList::pdf(const Point3 &origin, const Vec3 &direction) const {
+	if (lights.empty()) {
+		return 0;
+	}
+	float sum = 0;
+	for (const auto *light: lights) {
+		sum += light->directionPdf(origin, direction);
+	}
+	return sum / static_cast<float>(lights.size());
+}
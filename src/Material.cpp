@@ -10,35 +10,90 @@
 #include "MathUtil.h"
 #include "Texture.h"
 #include <memory>
+#include <typeinfo>
+
+namespace {
+// the scattering of the built in materials, shared by their virtual
+// functions and the switch in MaterialRegistry
+Ray lambertianRay(const Ray &r_in, const HitRecord &record) {
+    Vec3 ray_dir = record.normal + randomUnitVec3();
+    if (verySmall(ray_dir)) {
+        ray_dir = record.normal;
+    }
+    return Ray(record.p, ray_dir, r_in.time());
+}
+
+float lambertianPdf(const HitRecord &record, const Vec3 &direction) {
+    // normal plus a unit vector is cosine distributed, and albedo / pi *
+    // cos is exactly attenuation times this density
+    auto cos = record.normal.dot(direction.normalized());
+    return cos <= 0 ? 0 : static_cast<float>(cos / PI);
+}
+
+Ray metalRay(const Ray &r_in, const HitRecord &record, float fuzz) {
+    auto ray_dir = reflect(r_in.dir().normalized() + randomUnitVec3() * fuzz,
+                           record.normal);
+    return Ray(record.p, ray_dir, r_in.time());
+}
+
+float schlick(float cosine, float refr_idx) {
+    auto r0 = (1 - refr_idx) / (1 + refr_idx);
+    r0 *= r0;
+    return r0 + (1 - r0) * std::pow(1 - cosine, 5);
+}
+
+Ray dielectricRay(const Ray &r_in, const HitRecord &record, float ir) {
+    float ref_ratio = record.front_face ? (1.0 / ir) : ir;
+    auto unit = r_in.dir().normalized();
+
+    float cos = fmin((-unit).dot(record.normal), 1.0);
+    float sin = sqrt(1 - cos * cos);
+
+    bool can_refr = ref_ratio * sin < 1.0;
+    Vec3 dir;
+    if (can_refr && schlick(cos, ref_ratio) < randomFloat())
+        dir = refract(r_in.dir().normalized(), record.normal, ref_ratio);
+    else
+        dir = reflect(r_in.dir().normalized(), record.normal);
+
+    return Ray(record.p, dir, r_in.time());
+}
+} // namespace
 
 Color IMaterial::emitted(float u, float v, const Point3 &p) const {
-    return Eigen::Vector3d{0, 0, 0};
+    return Vec3{0, 0, 0};
+}
+
+float IMaterial::scatteringPdf(const Ray &r_in, const HitRecord &record,
+                               const Vec3 &direction) const {
+    return 0;
 }
 
+bool IMaterial::isEmissive() const { return false; }
+
 Lambertian::Lambertian(Color albedo)
     : albedo(std::make_shared<SolidColor>(std::move(albedo))) {}
 
 Lambertian::Lambertian(std::shared_ptr<ITexture> tex) : albedo(tex) {}
 
 bool Lambertian::scatter(const Ray &r_in, const HitRecord &record,
-                         Eigen::Vector3d &attenuation, Ray &scattered) const {
-    Eigen::Vector3d ray_dir = record.normal + randomUnitVec3();
-    if (verySmall(ray_dir)) {
-        ray_dir = record.normal;
-    }
-    scattered = Ray(record.p, ray_dir, r_in.time());
+                         Vec3 &attenuation, Ray &scattered) const {
+    scattered = lambertianRay(r_in, record);
     attenuation = albedo->value(record.u, record.v, record.p);
     return true;
 }
 
+float Lambertian::scatteringPdf(const Ray &r_in, const HitRecord &record,
+                                const Vec3 &direction) const {
+    return lambertianPdf(record, direction);
+}
+
 Metal::Metal(const Color &albedo, float fuzz)
     : albedo(std::make_shared<SolidColor>(albedo)), fuzz(fuzz) {}
 
 bool Metal::scatter(const Ray &r_in, const HitRecord &record,
-                    Eigen::Vector3d &attenuation, Ray &scattered) const {
-    auto ray_dir = reflect(r_in.dir().normalized() + randomUnitVec3() * fuzz,
-                           record.normal);
-    scattered = Ray(record.p, ray_dir, r_in.time());
+                    Vec3 &attenuation, Ray &scattered) const {
+    scattered = metalRay(r_in, record, fuzz);
     attenuation = albedo->value(record.u, record.v, record.p);
     return true;
 }
@@ -52,29 +107,14 @@ Dielectric::Dielectric(float idx, const Color &albedo)
     : ir(idx), albedo(std::make_shared<SolidColor>(albedo)) {}
 
 bool Dielectric::scatter(const Ray &r_in, const HitRecord &record,
-                         Eigen::Vector3d &attenuation, Ray &scattered) const {
+                         Vec3 &attenuation, Ray &scattered) const {
     attenuation = albedo->value(record.u, record.v, record.p);
-    float ref_ratio = record.front_face ? (1.0 / ir) : ir;
-    auto unit = r_in.dir().normalized();
-
-    float cos = fmin((-unit).dot(record.normal), 1.0);
-    float sin = sqrt(1 - cos * cos);
-
-    bool can_refr = ref_ratio * sin < 1.0;
-    Eigen::Vector3d dir;
-    if (can_refr && reflectance(cos, ref_ratio) < randomFloat())
-        dir = refract(r_in.dir().normalized(), record.normal, ref_ratio);
-    else
-        dir = reflect(r_in.dir().normalized(), record.normal);
-
-    scattered = Ray(record.p, dir, r_in.time());
+    scattered = dielectricRay(r_in, record, ir);
     return true;
 }
 
 float Dielectric::reflectance(float cosine, float refr_idx) {
-    auto r0 = (1 - refr_idx) / (1 + refr_idx);
-    r0 *= r0;
-    return r0 + (1 - r0) * std::pow(1 - cosine, 5);
+    return schlick(cosine, refr_idx);
 }
 
 DiffuseLight::DiffuseLight(std::shared_ptr<ITexture> t) : emit(t) {}
@@ -82,10 +122,179 @@ DiffuseLight::DiffuseLight(std::shared_ptr<ITexture> t) : emit(t) {}
 DiffuseLight::DiffuseLight(Color c) : emit(std::make_shared<SolidColor>(c)) {}
 
 bool DiffuseLight::scatter(const Ray &r_in, const HitRecord &record,
-                           Eigen::Vector3d &attenuation, Ray &scattered) const {
+                           Vec3 &attenuation, Ray &scattered) const {
     return false;
 }
 
 Color DiffuseLight::emitted(float u, float v, const Point3 &p) const {
     return emit->value(u, v, p);
 }
+
+bool DiffuseLight::isEmissive() const { return true; }
+
+MaterialRegistry::MaterialRegistry()
+    : materials{nullptr}, owners{nullptr},
+      records{MaterialRecord{MATERIAL_NONE, 0, 0, nullptr}} {
+    ids.emplace(nullptr, 0);
+}
+
+uint32_t MaterialRegistry::add(const std::shared_ptr<IMaterial> &material) {
+    std::lock_guard lock(mutex);
+    auto [it, inserted] =
+        ids.emplace(material.get(), static_cast<uint32_t>(materials.size()));
+    if (inserted) {
+        materials.push_back(material.get());
+        owners.push_back(material);
+        records.push_back(compile(material));
+    }
+    return it->second;
+}
+
+MaterialRecord
+MaterialRegistry::compile(const std::shared_ptr<IMaterial> &material) {
+    // only the exact built in types, a subclass may override anything
+    const auto &type = typeid(*material);
+    if (type == typeid(Lambertian)) {
+        const auto &m = static_cast<const Lambertian &>(*material);
+        return {MATERIAL_LAMBERTIAN, addTexture(m.albedo), 0, nullptr};
+    }
+    if (type == typeid(Metal)) {
+        const auto &m = static_cast<const Metal &>(*material);
+        return {MATERIAL_METAL, addTexture(m.albedo), m.fuzz, nullptr};
+    }
+    if (type == typeid(Dielectric)) {
+        const auto &m = static_cast<const Dielectric &>(*material);
+        return {MATERIAL_DIELECTRIC, addTexture(m.albedo), m.ir, nullptr};
+    }
+    if (type == typeid(DiffuseLight)) {
+        const auto &m = static_cast<const DiffuseLight &>(*material);
+        return {MATERIAL_DIFFUSE_LIGHT, addTexture(m.emit), 0, nullptr};
+    }
+    return {MATERIAL_CUSTOM, 0, 0, material.get()};
+}
+
+uint32_t
+MaterialRegistry::addTexture(const std::shared_ptr<ITexture> &texture) {
+    if (auto it = texture_ids.find(texture.get()); it != texture_ids.end()) {
+        return it->second;
+    }
+    TextureRecord record{TEXTURE_CUSTOM, 0, 0, 0, Color{0, 0, 0},
+                         texture.get()};
+    const auto &type = typeid(*texture);
+    if (type == typeid(SolidColor)) {
+        record.type = TEXTURE_SOLID;
+        record.color = static_cast<const SolidColor &>(*texture).color_val;
+    } else if (type == typeid(CheckerTexture)) {
+        const auto &checker = static_cast<const CheckerTexture &>(*texture);
+        record.type = TEXTURE_CHECKER;
+        record.inv_scale = checker.inv_scale;
+        record.even = addTexture(checker.even);
+        record.odd = addTexture(checker.odd);
+    } else if (type == typeid(ImageTexture)) {
+        record.type = TEXTURE_IMAGE;
+    } else if (type == typeid(NoiseTexture)) {
+        record.type = TEXTURE_NOISE;
+    } else if (type == typeid(TerrainTexture)) {
+        record.type = TEXTURE_TERRAIN;
+    }
+    auto id = static_cast<uint32_t>(textures.size());
+    textures.push_back(record);
+    texture_ids.emplace(texture.get(), id);
+    return id;
+}
+
+size_t MaterialRegistry::size() const { return materials.size(); }
+
+void MaterialRegistry::clear() {
+    std::lock_guard lock(mutex);
+    materials.assign(1, nullptr);
+    owners.assign(1, nullptr);
+    ids.clear();
+    ids.emplace(nullptr, 0);
+    records.assign(1, MaterialRecord{MATERIAL_NONE, 0, 0, nullptr});
+    textures.clear();
+    texture_ids.clear();
+}
+
+Color MaterialRegistry::emitted(uint32_t id, float u, float v,
+                                const Point3 &p) {
+    const auto &m = record(id);
+    switch (m.type) {
+        case MATERIAL_DIFFUSE_LIGHT:
+            return textureValue(m.texture, u, v, p);
+        case MATERIAL_CUSTOM:
+            return m.custom->emitted(u, v, p);
+        default:
+            return Color{0, 0, 0};
+    }
+}
+
+bool MaterialRegistry::scatter(uint32_t id, const Ray &r_in,
+                               const HitRecord &record, Vec3 &attenuation,
+                               Ray &scattered) {
+    const auto &m = MaterialRegistry::record(id);
+    switch (m.type) {
+        case MATERIAL_LAMBERTIAN:
+            scattered = lambertianRay(r_in, record);
+            break;
+        case MATERIAL_METAL:
+            scattered = metalRay(r_in, record, m.param);
+            break;
+        case MATERIAL_DIELECTRIC:
+            scattered = dielectricRay(r_in, record, m.param);
+            break;
+        case MATERIAL_CUSTOM:
+            return m.custom->scatter(r_in, record, attenuation, scattered);
+        default:
+            return false;
+    }
+    attenuation = textureValue(m.texture, record.u, record.v, record.p);
+    return true;
+}
+
+float MaterialRegistry::scatteringPdf(uint32_t id, const Ray &r_in,
+                                      const HitRecord &record,
+                                      const Vec3 &direction) {
+    const auto &m = MaterialRegistry::record(id);
+    switch (m.type) {
+        case MATERIAL_LAMBERTIAN:
+            return lambertianPdf(record, direction);
+        case MATERIAL_CUSTOM:
+            return m.custom->scatteringPdf(r_in, record, direction);
+        default:
+            return 0;
+    }
+}
+
+bool MaterialRegistry::isEmissive(uint32_t id) {
+    const auto &m = record(id);
+    return m.type == MATERIAL_DIFFUSE_LIGHT ||
+           (m.type == MATERIAL_CUSTOM && m.custom->isEmissive());
+}
+
+Color MaterialRegistry::textureValue(uint32_t id, float u, float v,
+                                     const Point3 &p) {
+    while (true) {
+        const auto &t = texture(id);
+        switch (t.type) {
+            case TEXTURE_SOLID:
+                return t.color;
+            case TEXTURE_CHECKER:
+                // nested checkers are followed by id instead of recursing
+                id = CheckerTexture::isEven(t.inv_scale, u, v) ? t.even : t.odd;
+                break;
+            // qualified calls, these never go through the vtable
+            case TEXTURE_IMAGE:
+                return static_cast<const ImageTexture *>(t.texture)
+                    ->ImageTexture::value(u, v, p);
+            case TEXTURE_NOISE:
+                return static_cast<const NoiseTexture *>(t.texture)
+                    ->NoiseTexture::value(u, v, p);
+            case TEXTURE_TERRAIN:
+                return static_cast<const TerrainTexture *>(t.texture)
+                    ->TerrainTexture::value(u, v, p);
+            default:
+                return t.texture->value(u, v, p);
+        }
+    }
+}
@@ -6,36 +6,42 @@
  */
 
 #include "MathUtil.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include "Simd.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "spdlog/spdlog.h"
 
-std::ostream &operator<<(std::ostream &out, const Eigen::Vector3d &other) {
+std::ostream &operator<<(std::ostream &out, const Vec3 &other) {
 	out << "Vec3: " << other[0] << " " << other[1] << " " << other[2];
 	return out;
 }
 
-Ray::Ray(Eigen::Vector3d pos, Eigen::Vector3d dir) : position(std::move(pos)), direction(std::move(dir)), tm(0) {}
+Pcg32::Pcg32() : Pcg32(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL) {}
 
-Ray::Ray(Eigen::Vector3d pos, Eigen::Vector3d dir, double time) :
-	position(std::move(pos)), direction(std::move(dir)), tm(time) {}
+Pcg32::Pcg32(uint64_t init_state, uint64_t stream) { seed(init_state, stream); }
 
-Point3 Ray::at(double t) const { return position + direction * t; }
-
-Eigen::Vector3d Ray::dir() const { return direction; }
-
-double Ray::time() const { return tm; }
+void Pcg32::seed(uint64_t init_state, uint64_t stream) {
+	state = 0;
+	inc = (stream << 1u) | 1u;
+	nextUInt();
+	state += init_state;
+	nextUInt();
+}
 
-Eigen::Vector3d Ray::pos() const { return position; }
 Interval::Interval() : min(-INF), max(INF) {}
-Interval::Interval(float min, float max) : min(min), max(max) {}
-bool Interval::within(float x) const { return (min <= x) && (x <= max); }
-bool Interval::surround(float x) const { return (min < x) && (x < max); }
+Interval::Interval(Real min, Real max) : min(min), max(max) {}
+bool Interval::within(Real x) const { return (min <= x) && (x <= max); }
+bool Interval::surround(Real x) const { return (min < x) && (x < max); }
 Interval::Interval(const Interval &first, const Interval &second) {
 	min = fmin(first.min, second.min);
 	max = fmax(first.max, second.max);
 }
 
-float Interval::clamp(float x) const {
+Real Interval::clamp(Real x) const {
 	if (x < min)
 		return min;
 	if (x > max)
@@ -43,7 +49,7 @@ float Interval::clamp(float x) const {
 	return x;
 }
 
-Interval Interval::expand(float delta) {
+Interval Interval::expand(Real delta) {
 	auto padding = delta / 2;
 	return Interval(min - padding, max + padding);
 }
@@ -70,28 +76,19 @@ Interval AABB::axis(int i) const {
 }
 
 bool AABB::hit(const Ray &r, Interval ray_int) const {
-	for (int i = 0; i < 3; i++) {
-		auto invD = 1.0 / r.dir()[i];
-		auto orig = r.pos()[i];
-
-		auto t0 = (axis(i).min - orig) * invD;
-		auto t1 = (axis(i).max - orig) * invD;
-
-		if (invD < 0.0) {
-			std::swap(t0, t1);
-		}
-
-		if (t0 > ray_int.min)
-			ray_int.min = t0;
-		if (t1 < ray_int.max)
-			ray_int.max = t1;
-
-		if (ray_int.max < ray_int.min) {
-			return false;
-		}
-	}
-	return true;
+	// same rules as the kernels in RayBox.h, the sign picks the entry bound and NaN never narrows
+	auto slab = [&](const Interval &bounds, int i) {
+		auto near = ((r.sign(i) ? bounds.max : bounds.min) - r.pos()[i]) * r.invDir()[i];
+		auto far = ((r.sign(i) ? bounds.min : bounds.max) - r.pos()[i]) * r.invDir()[i];
+		ray_int.min = near > ray_int.min ? near : ray_int.min;
+		ray_int.max = far < ray_int.max ? far : ray_int.max;
+	};
+	slab(x, 0);
+	slab(y, 1);
+	slab(z, 2);
+	return ray_int.min <= ray_int.max;
 }
+
 AABB::AABB(const AABB &up, const AABB &down) {
 	x = Interval(up.x, down.x);
 	y = Interval(up.y, down.y);
@@ -109,46 +106,9 @@ AABB AABB::pad() {
 	return AABB(new_x, new_y, new_z);
 }
 
-float Perlin::gradientDotProd(int hash, const Eigen::Vector3d &pt) const {
-	auto x = pt[0];
-	auto y = pt[1];
-	auto z = pt[2];
-	switch (hash & 0xF) {
-		case 0x0:
-			return x + y;
-		case 0x1:
-			return -x + y;
-		case 0x2:
-			return x - y;
-		case 0x3:
-			return -x - y;
-		case 0x4:
-			return x + z;
-		case 0x5:
-			return -x + z;
-		case 0x6:
-			return x - z;
-		case 0x7:
-			return -x - z;
-		case 0x8:
-			return y + z;
-		case 0x9:
-			return -y + z;
-		case 0xA:
-			return y - z;
-		case 0xB:
-			return -y - z;
-		case 0xC:
-			return y + x;
-		case 0xD:
-			return -y + z;
-		case 0xE:
-			return y - x;
-		case 0xF:
-			return -y - z;
-		default:
-			return 0; // never happens
-	}
+float Perlin::gradientDotProd(int hash, const Vec3 &pt) const {
+	const float *g = gradients[hash & 0xF];
+	return g[0] * pt[0] + g[1] * pt[1] + g[2] * pt[2];
 }
 
 float Perlin::fade(float t) const { return t * t * t * (t * (t * 6 - 15) + 10); }
@@ -164,15 +124,11 @@ float Perlin::rawNoise(const Point3 &p) const {
 	y -= floor(y);
 	z -= floor(z);
 
-	int llb, lrb, ulb, urb, llf, lrf, ulf, urf;
-	llb = perm[perm[perm[xi] + yi] + zi];
-	lrb = perm[perm[perm[xi + 1] + yi] + zi];
-	ulb = perm[perm[perm[xi] + yi + 1] + zi];
-	urb = perm[perm[perm[xi + 1] + yi + 1] + zi];
-	llf = perm[perm[perm[xi] + yi] + zi + 1];
-	lrf = perm[perm[perm[xi + 1] + yi] + zi + 1];
-	ulf = perm[perm[perm[xi] + yi + 1] + zi + 1];
-	urf = perm[perm[perm[xi + 1] + yi + 1] + zi + 1];
+	// corners that share the lower levels of the hash share their lookups
+	int a = perm[xi] + yi, b = perm[xi + 1] + yi;
+	int aa = perm[a] + zi, ab = perm[a + 1] + zi, ba = perm[b] + zi, bb = perm[b + 1] + zi;
+	int llb = perm[aa], lrb = perm[ba], ulb = perm[ab], urb = perm[bb];
+	int llf = perm[aa + 1], lrf = perm[ba + 1], ulf = perm[ab + 1], urf = perm[bb + 1];
 	float dotllb = gradientDotProd(llb, {x, y, z});
 	float dotlrb = gradientDotProd(lrb, {x - 1, y, z});
 	float dotulb = gradientDotProd(ulb, {x, y - 1, z});
@@ -200,14 +156,215 @@ float Perlin::rawNoise(const Point3 &p) const {
 }
 
 float Perlin::octaveNoise(const Point3 &p, float frequency, int octave_count, float persistence) const {
-	float sum = 0;
 	float max_value = 0;
 	float amplitude = 1;
 	for (int i = 0; i < octave_count; ++i) {
-		sum += rawNoise(p * frequency) * amplitude;
 		max_value += amplitude;
 		amplitude *= persistence;
+	}
+	return octaveSum(p, frequency, 0, octave_count, persistence) / max_value;
+}
+
+#if defined(__AVX2__)
+namespace {
+	/**
+	 * Perlin::gradients[hash & 15] dotted with x, y, z, picked with blends instead of a table lookup per lane
+	 */
+	__m256 gradientDot(__m256i hash, __m256 x, __m256 y, __m256 z) {
+		auto h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+		auto below8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+		auto below4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+		auto x_second = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+															 _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+		auto u = _mm256_blendv_ps(y, x, below8);
+		auto v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, x_second), y, below4);
+		// bit 0 of the hash negates u, bit 1 negates v
+		auto u_sign = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31);
+		auto v_sign = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30);
+		u = _mm256_xor_ps(u, _mm256_castsi256_ps(u_sign));
+		v = _mm256_xor_ps(v, _mm256_castsi256_ps(v_sign));
+		return _mm256_add_ps(u, v);
+	}
+} // namespace
+#endif
+
+float Perlin::octaveSum(const Point3 &p, float frequency, int first_octave, int octave_count,
+						float persistence) const {
+	constexpr int width = Float8::width;
+	float amplitude = 1;
+	for (int i = 0; i < first_octave; ++i) {
+		amplitude *= persistence;
 		frequency *= 2;
 	}
-	return sum / max_value;
+	float sum = 0;
+	for (int octave = first_octave; octave < octave_count; octave += width) {
+		// lanes past the last octave are evaluated all the same and weighted 0
+		alignas(32) float amplitudes[width];
+		// fractional position in the lattice cell, and the gradient dotted with the offset to every corner.
+		// bit 0 of the corner index is +x, bit 1 +y, bit 2 +z
+		Float8 x, y, z, dots[8];
+#if defined(__AVX2__)
+		alignas(32) float px[width], py[width], pz[width];
+		for (int lane = 0; lane < width; lane++) {
+			px[lane] = p[0] * frequency;
+			py[lane] = p[1] * frequency;
+			pz[lane] = p[2] * frequency;
+			amplitudes[lane] = octave + lane < octave_count ? amplitude : 0;
+			amplitude *= persistence;
+			frequency *= 2;
+		}
+		__m256 position[3] = {_mm256_load_ps(px), _mm256_load_ps(py), _mm256_load_ps(pz)};
+		__m256 fraction[3], fraction_minus_one[3];
+		__m256i cell[3];
+		for (int axis = 0; axis < 3; axis++) {
+			auto lower = _mm256_floor_ps(position[axis]);
+			cell[axis] = _mm256_and_si256(_mm256_cvttps_epi32(lower), _mm256_set1_epi32(255));
+			fraction[axis] = _mm256_sub_ps(position[axis], lower);
+			fraction_minus_one[axis] = _mm256_sub_ps(fraction[axis], _mm256_set1_ps(1));
+		}
+		auto one = _mm256_set1_epi32(1);
+		auto gather = [&](__m256i index) { return _mm256_i32gather_epi32(perm, index, 4); };
+		auto a = _mm256_add_epi32(gather(cell[0]), cell[1]);
+		auto b = _mm256_add_epi32(gather(_mm256_add_epi32(cell[0], one)), cell[1]);
+		auto aa = _mm256_add_epi32(gather(a), cell[2]);
+		auto ab = _mm256_add_epi32(gather(_mm256_add_epi32(a, one)), cell[2]);
+		auto ba = _mm256_add_epi32(gather(b), cell[2]);
+		auto bb = _mm256_add_epi32(gather(_mm256_add_epi32(b, one)), cell[2]);
+		__m256i hashes[8] = {gather(aa),
+							 gather(ba),
+							 gather(ab),
+							 gather(bb),
+							 gather(_mm256_add_epi32(aa, one)),
+							 gather(_mm256_add_epi32(ba, one)),
+							 gather(_mm256_add_epi32(ab, one)),
+							 gather(_mm256_add_epi32(bb, one))};
+		for (int corner = 0; corner < 8; corner++) {
+			dots[corner] = {gradientDot(hashes[corner], corner & 1 ? fraction_minus_one[0] : fraction[0],
+										(corner >> 1) & 1 ? fraction_minus_one[1] : fraction[1],
+										corner >> 2 ? fraction_minus_one[2] : fraction[2])};
+		}
+		x = {fraction[0]};
+		y = {fraction[1]};
+		z = {fraction[2]};
+#else
+		alignas(32) float fx[width], fy[width], fz[width];
+		alignas(32) float gx[8][width], gy[8][width], gz[8][width];
+		for (int lane = 0; lane < width; lane++) {
+			float px = p[0] * frequency, py = p[1] * frequency, pz = p[2] * frequency;
+			float x0 = std::floor(px), y0 = std::floor(py), z0 = std::floor(pz);
+			int xi = static_cast<int>(x0) & 255, yi = static_cast<int>(y0) & 255, zi = static_cast<int>(z0) & 255;
+			fx[lane] = px - x0;
+			fy[lane] = py - y0;
+			fz[lane] = pz - z0;
+			amplitudes[lane] = octave + lane < octave_count ? amplitude : 0;
+			amplitude *= persistence;
+			frequency *= 2;
+
+			int a = perm[xi] + yi, b = perm[xi + 1] + yi;
+			int aa = perm[a] + zi, ab = perm[a + 1] + zi, ba = perm[b] + zi, bb = perm[b + 1] + zi;
+			int hashes[8] = {perm[aa],	   perm[ba],	 perm[ab],	   perm[bb],
+							 perm[aa + 1], perm[ba + 1], perm[ab + 1], perm[bb + 1]};
+			for (int corner = 0; corner < 8; corner++) {
+				const float *g = gradients[hashes[corner] & 0xF];
+				gx[corner][lane] = g[0];
+				gy[corner][lane] = g[1];
+				gz[corner][lane] = g[2];
+			}
+		}
+		x = Float8::load(fx);
+		y = Float8::load(fy);
+		z = Float8::load(fz);
+		auto one = Float8::broadcast(1);
+		Float8 xs[2] = {x, x - one}, ys[2] = {y, y - one}, zs[2] = {z, z - one};
+		for (int corner = 0; corner < 8; corner++) {
+			auto dx = Float8::load(gx[corner]) * xs[corner & 1];
+			auto dy = Float8::load(gy[corner]) * ys[(corner >> 1) & 1];
+			dots[corner] = dx + dy + Float8::load(gz[corner]) * zs[corner >> 2];
+		}
+#endif
+		auto fade8 = [](const Float8 &t) {
+			return t * t * t * (t * (t * Float8::broadcast(6) - Float8::broadcast(15)) + Float8::broadcast(10));
+		};
+		auto lerp8 = [](const Float8 &begin, const Float8 &end, const Float8 &weight) {
+			return begin + weight * (end - begin);
+		};
+		auto u = fade8(x), v = fade8(y), w = fade8(z);
+		auto y0 = lerp8(lerp8(dots[0], dots[1], u), lerp8(dots[2], dots[3], u), v);
+		auto y1 = lerp8(lerp8(dots[4], dots[5], u), lerp8(dots[6], dots[7], u), v);
+		alignas(32) float noise[width];
+		(lerp8(y0, y1, w) * Float8::load(amplitudes)).store(noise);
+		for (float n: noise) {
+			sum += n;
+		}
+	}
+	return sum;
+}
+
+OctaveNoise::OctaveNoise(float frequency, int octave_count, float persistence) :
+	frequency(frequency), octave_count(octave_count), persistence(persistence), max_value(0) {
+	float amplitude = 1;
+	for (int i = 0; i < octave_count; ++i) {
+		max_value += amplitude;
+		amplitude *= persistence;
+	}
+}
+
+void OctaveNoise::bake(const AABB &box, int resolution) {
+	Real extent = 0;
+	for (int axis = 0; axis < 3; axis++) {
+		extent = std::max(extent, box.axis(axis).max - box.axis(axis).min);
+	}
+	auto cell_size = static_cast<float>(extent / resolution);
+	baked_octaves = 0;
+	for (float f = frequency; baked_octaves < octave_count && f * cell_size <= 1.0f / 8; f *= 2) {
+		baked_octaves++;
+	}
+	grid.clear();
+	if (baked_octaves == 0) {
+		spdlog::warn("a {} cell grid is too coarse for noise of frequency {}, nothing baked", resolution, frequency);
+		return;
+	}
+	bounds = box;
+	inv_cell_size = 1 / cell_size;
+	for (int axis = 0; axis < 3; axis++) {
+		cells[axis] = std::max(1, static_cast<int>(std::ceil((box.axis(axis).max - box.axis(axis).min) / cell_size)));
+	}
+	grid.resize(static_cast<size_t>(cells[0] + 1) * (cells[1] + 1) * (cells[2] + 1));
+	size_t i = 0;
+	for (int z = 0; z <= cells[2]; z++) {
+		for (int y = 0; y <= cells[1]; y++) {
+			for (int x = 0; x <= cells[0]; x++) {
+				Point3 p{box.x.min + x * cell_size, box.y.min + y * cell_size, box.z.min + z * cell_size};
+				grid[i++] = noise.octaveSum(p, frequency, 0, baked_octaves, persistence);
+			}
+		}
+	}
+	spdlog::info("baked {} of {} noise octaves on a {} * {} * {} grid, {:.1f} MB", baked_octaves, octave_count,
+				 cells[0], cells[1], cells[2], grid.size() * sizeof(float) / 1e6);
+}
+
+int OctaveNoise::bakedOctaves() const { return baked_octaves; }
+
+float OctaveNoise::baked(const Point3 &p) const {
+	int index[3];
+	float t[3];
+	for (int axis = 0; axis < 3; axis++) {
+		auto g = static_cast<float>((p[axis] - bounds.axis(axis).min) * inv_cell_size);
+		index[axis] = std::clamp(static_cast<int>(g), 0, cells[axis] - 1);
+		t[axis] = std::clamp(g - index[axis], 0.0f, 1.0f);
+	}
+	size_t stride_y = cells[0] + 1, stride_z = stride_y * (cells[1] + 1);
+	const float *c = grid.data() + index[2] * stride_z + index[1] * stride_y + index[0];
+	auto lerp = [](float begin, float end, float weight) { return begin + weight * (end - begin); };
+	float y0 = lerp(lerp(c[0], c[1], t[0]), lerp(c[stride_y], c[stride_y + 1], t[0]), t[1]);
+	c += stride_z;
+	float y1 = lerp(lerp(c[0], c[1], t[0]), lerp(c[stride_y], c[stride_y + 1], t[0]), t[1]);
+	return lerp(y0, y1, t[2]);
+}
+
+float OctaveNoise::value(const Point3 &p) const {
+	if (grid.empty() || !bounds.axis(0).within(p[0]) || !bounds.axis(1).within(p[1]) || !bounds.axis(2).within(p[2])) {
+		return noise.octaveSum(p, frequency, 0, octave_count, persistence) / max_value;
+	}
+	return (baked(p) + noise.octaveSum(p, frequency, baked_octaves, octave_count, persistence)) / max_value;
 }
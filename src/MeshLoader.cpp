@@ -0,0 +1,658 @@
+/**
+ * @file MeshLoader.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "MeshLoader.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include "spdlog/spdlog.h"
+
+namespace {
+	constexpr char cache_magic[8] = {'H', 'K', 'T', 'R', 'M', 'E', 'S', 'H'};
+	constexpr uint32_t cache_version = 1;
+	// sections start on cache lines, which also satisfies the alignment of the nodes
+	constexpr size_t section_alignment = 64;
+	constexpr uint32_t missing_index = UINT32_MAX;
+
+	size_t alignSection(size_t size) { return (size + section_alignment - 1) / section_alignment * section_alignment; }
+
+	double secondsSince(std::chrono::steady_clock::time_point begin) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/**
+	 * read only private mapping of a whole file
+	 */
+	class MappedFile {
+	public:
+		static std::shared_ptr<MappedFile> open(const std::string &filepath) {
+			int fd = ::open(filepath.c_str(), O_RDONLY);
+			if (fd == -1) {
+				return nullptr;
+			}
+			struct stat st;
+			if (fstat(fd, &st) == -1 || st.st_size == 0) {
+				::close(fd);
+				return nullptr;
+			}
+			auto size = static_cast<size_t>(st.st_size);
+			void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (memory == MAP_FAILED) {
+				spdlog::error("cannot map {}: {}", filepath, std::strerror(errno));
+				return nullptr;
+			}
+			return std::shared_ptr<MappedFile>(new MappedFile(static_cast<const char *>(memory), size));
+		}
+
+		~MappedFile() { munmap(const_cast<char *>(data), size); }
+
+		MappedFile(const MappedFile &other) = delete;
+
+		MappedFile &operator=(const MappedFile &other) = delete;
+
+		const char *const data;
+		const size_t size;
+
+	private:
+		MappedFile(const char *data, size_t size) : data(data), size(size) {}
+	};
+
+	struct CacheHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t node_size;
+		// the source file the cache was made from
+		uint64_t source_size;
+		int64_t source_mtime;
+		uint64_t vertex_count;
+		uint64_t normal_count;
+		uint64_t uv_count;
+		uint64_t triangle_count;
+		uint64_t node_count;
+		uint64_t positions_offset;
+		uint64_t normals_offset;
+		uint64_t uvs_offset;
+		uint64_t triangles_offset;
+		uint64_t nodes_offset;
+		double bounds[6];
+	};
+
+	struct ParsedMesh {
+		std::vector<Eigen::Vector3f> positions;
+		std::vector<Eigen::Vector3f> normals;
+		std::vector<Eigen::Vector2f> uvs;
+		std::vector<uint32_t> indices;
+	};
+
+	int64_t modificationTime(const struct stat &st) {
+		return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	}
+
+	const char *skipBlank(const char *p, const char *end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+			p++;
+		return p;
+	}
+
+	const char *skipLine(const char *p, const char *end) {
+		p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+		return p == nullptr ? end : p + 1;
+	}
+
+	template<typename T>
+	bool parseNumber(const char *&p, const char *end, T &value) {
+		p = skipBlank(p, end);
+		// from_chars takes no leading plus
+		if (p < end && *p == '+')
+			p++;
+		auto [next, error] = std::from_chars(p, end, value);
+		if (error != std::errc()) {
+			return false;
+		}
+		p = next;
+		return true;
+	}
+
+	/**
+	 * one corner of an OBJ face, indices into the position, uv and normal lists
+	 */
+	struct ObjCorner {
+		uint32_t v, vt, vn;
+
+		bool operator==(const ObjCorner &other) const = default;
+	};
+
+	struct ObjCornerHash {
+		size_t operator()(const ObjCorner &c) const {
+			return std::hash<uint64_t>()((static_cast<uint64_t>(c.v) << 32) ^ (static_cast<uint64_t>(c.vt) << 16) ^
+										 c.vn);
+		}
+	};
+
+	/**
+	 * v/vt/vn with any of vt and vn left out, indices are one based or negative counting from the back
+	 */
+	bool parseObjCorner(const char *&p, const char *end, const ParsedMesh &raw, ObjCorner &corner) {
+		auto resolve = [](int64_t idx, size_t count, uint32_t &out) {
+			auto resolved = idx > 0 ? idx - 1 : static_cast<int64_t>(count) + idx;
+			if (idx == 0 || resolved < 0 || resolved >= static_cast<int64_t>(count))
+				return false;
+			out = static_cast<uint32_t>(resolved);
+			return true;
+		};
+		int64_t idx;
+		if (!parseNumber(p, end, idx) || !resolve(idx, raw.positions.size(), corner.v))
+			return false;
+		corner.vt = corner.vn = missing_index;
+		if (p < end && *p == '/') {
+			p++;
+			if (p < end && *p != '/') {
+				if (!parseNumber(p, end, idx) || !resolve(idx, raw.uvs.size(), corner.vt))
+					return false;
+			}
+			if (p < end && *p == '/') {
+				p++;
+				if (!parseNumber(p, end, idx) || !resolve(idx, raw.normals.size(), corner.vn))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool parseObj(const MappedFile &file, ParsedMesh &mesh) {
+		ParsedMesh raw;
+		std::vector<ObjCorner> corners;
+		std::vector<ObjCorner> face;
+		bool indexed_attributes = false;
+		const char *p = file.data;
+		const char *end = file.data + file.size;
+		size_t line = 0;
+		while (p < end) {
+			line++;
+			p = skipBlank(p, end);
+			bool ok = true;
+			if (end - p > 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+				p += 2;
+				Eigen::Vector3f v;
+				ok = parseNumber(p, end, v.x()) && parseNumber(p, end, v.y()) && parseNumber(p, end, v.z());
+				raw.positions.push_back(v);
+			} else if (end - p > 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+				p += 3;
+				Eigen::Vector3f n;
+				ok = parseNumber(p, end, n.x()) && parseNumber(p, end, n.y()) && parseNumber(p, end, n.z());
+				raw.normals.push_back(n);
+			} else if (end - p > 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+				p += 3;
+				Eigen::Vector2f uv;
+				ok = parseNumber(p, end, uv.x()) && parseNumber(p, end, uv.y());
+				raw.uvs.push_back(uv);
+			} else if (end - p > 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+				p += 2;
+				face.clear();
+				while (ok && (p = skipBlank(p, end)) < end && *p != '\n' && *p != '#') {
+					ObjCorner corner;
+					ok = parseObjCorner(p, end, raw, corner);
+					indexed_attributes |= corner.vt != missing_index || corner.vn != missing_index;
+					face.push_back(corner);
+				}
+				ok = ok && face.size() >= 3;
+				// polygons become fans around their first corner
+				for (size_t i = 2; ok && i < face.size(); i++) {
+					corners.insert(corners.end(), {face[0], face[i - 1], face[i]});
+				}
+			}
+			if (!ok) {
+				spdlog::error("cannot parse obj line {}", line);
+				return false;
+			}
+			// groups, materials and smoothing groups are not needed for a single mesh
+			p = skipLine(p, end);
+		}
+
+		if (!indexed_attributes) {
+			mesh.positions = std::move(raw.positions);
+			mesh.indices.reserve(corners.size());
+			for (const auto &corner: corners) {
+				mesh.indices.push_back(corner.v);
+			}
+			return true;
+		}
+		// obj indexes every attribute on its own, the mesh wants one index per vertex
+		bool has_normals = !raw.normals.empty();
+		bool has_uvs = !raw.uvs.empty();
+		std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> vertices;
+		vertices.reserve(raw.positions.size());
+		mesh.indices.reserve(corners.size());
+		for (const auto &corner: corners) {
+			auto [it, inserted] = vertices.try_emplace(corner, static_cast<uint32_t>(mesh.positions.size()));
+			if (inserted) {
+				mesh.positions.push_back(raw.positions[corner.v]);
+				// corners without a normal get a zero one, the mesh shades those flat
+				if (has_normals)
+					mesh.normals.push_back(corner.vn == missing_index ? Eigen::Vector3f::Zero().eval()
+																	  : raw.normals[corner.vn]);
+				if (has_uvs)
+					mesh.uvs.push_back(corner.vt == missing_index ? Eigen::Vector2f::Zero().eval()
+																  : raw.uvs[corner.vt]);
+			}
+			mesh.indices.push_back(it->second);
+		}
+		return true;
+	}
+
+	enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Invalid };
+
+	PlyType plyType(std::string_view name) {
+		if (name == "char" || name == "int8")
+			return PlyType::Int8;
+		if (name == "uchar" || name == "uint8")
+			return PlyType::UInt8;
+		if (name == "short" || name == "int16")
+			return PlyType::Int16;
+		if (name == "ushort" || name == "uint16")
+			return PlyType::UInt16;
+		if (name == "int" || name == "int32")
+			return PlyType::Int32;
+		if (name == "uint" || name == "uint32")
+			return PlyType::UInt32;
+		if (name == "float" || name == "float32")
+			return PlyType::Float32;
+		if (name == "double" || name == "float64")
+			return PlyType::Float64;
+		return PlyType::Invalid;
+	}
+
+	struct PlyProperty {
+		std::string name;
+		PlyType type;
+		// the type of the element count for list properties, Invalid for scalars
+		PlyType count_type = PlyType::Invalid;
+	};
+
+	struct PlyElement {
+		std::string name;
+		size_t count;
+		std::vector<PlyProperty> properties;
+	};
+
+	/**
+	 * reads the values of the body one at a time, from text or from little endian binary
+	 */
+	class PlyReader {
+	public:
+		PlyReader(const char *p, const char *end, bool ascii) : p(p), end(end), ascii(ascii) {}
+
+		bool read(PlyType type, double &value) {
+			if (ascii) {
+				while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+					p++;
+				return parseNumber(p, end, value);
+			}
+			switch (type) {
+				case PlyType::Int8:
+					return readBinary<int8_t>(value);
+				case PlyType::UInt8:
+					return readBinary<uint8_t>(value);
+				case PlyType::Int16:
+					return readBinary<int16_t>(value);
+				case PlyType::UInt16:
+					return readBinary<uint16_t>(value);
+				case PlyType::Int32:
+					return readBinary<int32_t>(value);
+				case PlyType::UInt32:
+					return readBinary<uint32_t>(value);
+				case PlyType::Float32:
+					return readBinary<float>(value);
+				case PlyType::Float64:
+					return readBinary<double>(value);
+				default:
+					return false;
+			}
+		}
+
+	private:
+		template<typename T>
+		bool readBinary(double &value) {
+			if (end - p < static_cast<ptrdiff_t>(sizeof(T)))
+				return false;
+			T raw;
+			std::memcpy(&raw, p, sizeof(T));
+			p += sizeof(T);
+			value = static_cast<double>(raw);
+			return true;
+		}
+
+		const char *p;
+		const char *end;
+		bool ascii;
+	};
+
+	bool parsePly(const MappedFile &file, ParsedMesh &mesh) {
+		const char *end = file.data + file.size;
+		std::string_view text(file.data, file.size);
+		if (!text.starts_with("ply")) {
+			spdlog::error("not a ply file");
+			return false;
+		}
+		auto header_end = text.find("end_header");
+		if (header_end == std::string_view::npos) {
+			spdlog::error("ply header has no end_header");
+			return false;
+		}
+		bool ascii = false;
+		std::vector<PlyElement> elements;
+		const char *p = file.data;
+		const char *body = skipLine(file.data + header_end, end);
+		while (p < file.data + header_end) {
+			const char *next = skipLine(p, end);
+			std::string_view line(p, next - p);
+			while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+				line.remove_suffix(1);
+			p = next;
+			std::vector<std::string_view> words;
+			for (size_t pos = 0; pos < line.size();) {
+				auto word_end = std::min(line.find(' ', pos), line.size());
+				if (word_end > pos)
+					words.push_back(line.substr(pos, word_end - pos));
+				pos = word_end + 1;
+			}
+			if (words.empty())
+				continue;
+			if (words[0] == "format" && words.size() >= 2) {
+				if (words[1] == "ascii") {
+					ascii = true;
+				} else if (words[1] != "binary_little_endian") {
+					spdlog::error("unsupported ply format {}", words[1]);
+					return false;
+				}
+			} else if (words[0] == "element" && words.size() == 3) {
+				size_t count = 0;
+				std::from_chars(words[2].data(), words[2].data() + words[2].size(), count);
+				elements.push_back({std::string(words[1]), count, {}});
+			} else if (words[0] == "property" && !elements.empty()) {
+				PlyProperty property;
+				if (words.size() == 5 && words[1] == "list") {
+					property = {std::string(words[4]), plyType(words[3]), plyType(words[2])};
+					if (property.count_type == PlyType::Invalid) {
+						spdlog::error("unsupported ply list count type {}", words[2]);
+						return false;
+					}
+				} else if (words.size() == 3) {
+					property = {std::string(words[2]), plyType(words[1])};
+				} else {
+					spdlog::error("cannot parse ply header line {}", line);
+					return false;
+				}
+				if (property.type == PlyType::Invalid) {
+					spdlog::error("unsupported ply property type in {}", line);
+					return false;
+				}
+				elements.back().properties.push_back(property);
+			}
+		}
+
+		PlyReader reader(body, end, ascii);
+		std::vector<double> values;
+		std::vector<uint32_t> polygon;
+		for (const auto &element: elements) {
+			bool is_vertex = element.name == "vertex";
+			bool is_face = element.name == "face";
+			// where each vertex attribute sits among the properties
+			int slot[8];
+			std::fill(std::begin(slot), std::end(slot), -1);
+			int index_list = -1;
+			for (int i = 0; i < static_cast<int>(element.properties.size()); i++) {
+				const auto &name = element.properties[i].name;
+				static constexpr std::string_view names[8][3] = {
+						{"x"}, {"y"}, {"z"}, {"nx"}, {"ny"}, {"nz"}, {"u", "s", "texture_u"}, {"v", "t", "texture_v"}};
+				for (int k = 0; k < 8; k++) {
+					if (std::find(std::begin(names[k]), std::end(names[k]), name) != std::end(names[k]))
+						slot[k] = i;
+				}
+				if (element.properties[i].count_type != PlyType::Invalid &&
+					(name == "vertex_indices" || name == "vertex_index"))
+					index_list = i;
+			}
+			if (is_vertex && (slot[0] < 0 || slot[1] < 0 || slot[2] < 0)) {
+				spdlog::error("ply vertices have no position");
+				return false;
+			}
+			bool has_normals = is_vertex && slot[3] >= 0 && slot[4] >= 0 && slot[5] >= 0;
+			bool has_uvs = is_vertex && slot[6] >= 0 && slot[7] >= 0;
+			values.resize(element.properties.size());
+			for (size_t item = 0; item < element.count; item++) {
+				for (size_t i = 0; i < element.properties.size(); i++) {
+					const auto &property = element.properties[i];
+					bool ok;
+					if (property.count_type == PlyType::Invalid) {
+						ok = reader.read(property.type, values[i]);
+					} else {
+						double count;
+						ok = reader.read(property.count_type, count);
+						polygon.clear();
+						for (size_t k = 0; ok && k < static_cast<size_t>(count); k++) {
+							double idx;
+							ok = reader.read(property.type, idx);
+							polygon.push_back(static_cast<uint32_t>(idx));
+						}
+						if (ok && is_face && static_cast<int>(i) == index_list) {
+							for (size_t k = 2; k < polygon.size(); k++) {
+								mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[k - 1], polygon[k]});
+							}
+						}
+					}
+					if (!ok) {
+						spdlog::error("ply {} {} is truncated", element.name, item);
+						return false;
+					}
+				}
+				if (is_vertex) {
+					auto value = [&](int k) { return static_cast<float>(values[slot[k]]); };
+					mesh.positions.emplace_back(value(0), value(1), value(2));
+					if (has_normals)
+						mesh.normals.emplace_back(value(3), value(4), value(5));
+					if (has_uvs)
+						mesh.uvs.emplace_back(value(6), value(7));
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * whether every index of the mapped buffers stays inside them. children must come after their parent,
+	 * which rules out cycles, and no node may lie deeper than the traversal stack reaches
+	 */
+	bool validView(const MeshView &view) {
+		if ((!view.normals.empty() && view.normals.size() != view.positions.size()) ||
+			(!view.uvs.empty() && view.uvs.size() != view.positions.size())) {
+			return false;
+		}
+		for (const auto &triangle: view.triangles) {
+			if (triangle.v[0] >= view.positions.size() || triangle.v[1] >= view.positions.size() ||
+				triangle.v[2] >= view.positions.size()) {
+				return false;
+			}
+		}
+		std::vector<uint8_t> depth(view.nodes.size(), 0);
+		for (size_t i = 0; i < view.nodes.size(); i++) {
+			const auto &node = view.nodes[i];
+			if (node.isLeaf()) {
+				if (node.primitive_offset > view.triangles.size() ||
+					node.primitive_count > view.triangles.size() - node.primitive_offset) {
+					return false;
+				}
+				continue;
+			}
+			if (node.axis > 2 || i + 1 >= view.nodes.size() || node.second_child_offset <= i + 1 ||
+				node.second_child_offset >= view.nodes.size() || depth[i] + 1 >= BVHNode::max_depth) {
+				return false;
+			}
+			auto child_depth = static_cast<uint8_t>(depth[i] + 1);
+			depth[i + 1] = std::max(depth[i + 1], child_depth);
+			depth[node.second_child_offset] = std::max(depth[node.second_child_offset], child_depth);
+		}
+		return true;
+	}
+
+	std::shared_ptr<TriangleMesh> openCache(const std::string &cache_path, const struct stat &source,
+											const std::shared_ptr<IMaterial> &mat) {
+		auto file = MappedFile::open(cache_path);
+		if (file == nullptr || file->size < sizeof(CacheHeader)) {
+			return nullptr;
+		}
+		CacheHeader header;
+		std::memcpy(&header, file->data, sizeof(CacheHeader));
+		if (std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 || header.version != cache_version ||
+			header.node_size != sizeof(LinearBVHNode)) {
+			spdlog::warn("mesh cache {} has another format, rebuilding it", cache_path);
+			return nullptr;
+		}
+		if (header.source_size != static_cast<uint64_t>(source.st_size) ||
+			header.source_mtime != modificationTime(source)) {
+			spdlog::info("mesh cache {} is stale, rebuilding it", cache_path);
+			return nullptr;
+		}
+		auto fits = [&](uint64_t offset, uint64_t count, size_t element_size) {
+			return offset % section_alignment == 0 && offset <= file->size &&
+				   count <= (file->size - offset) / element_size;
+		};
+		if (!fits(header.positions_offset, header.vertex_count, sizeof(Eigen::Vector3f)) ||
+			!fits(header.normals_offset, header.normal_count, sizeof(Eigen::Vector3f)) ||
+			!fits(header.uvs_offset, header.uv_count, sizeof(Eigen::Vector2f)) ||
+			!fits(header.triangles_offset, header.triangle_count, sizeof(MeshTriangle)) ||
+			!fits(header.nodes_offset, header.node_count, sizeof(LinearBVHNode))) {
+			spdlog::warn("mesh cache {} is truncated, rebuilding it", cache_path);
+			return nullptr;
+		}
+		MeshView view;
+		view.positions = {reinterpret_cast<const Eigen::Vector3f *>(file->data + header.positions_offset),
+						  header.vertex_count};
+		view.normals = {reinterpret_cast<const Eigen::Vector3f *>(file->data + header.normals_offset),
+						header.normal_count};
+		view.uvs = {reinterpret_cast<const Eigen::Vector2f *>(file->data + header.uvs_offset), header.uv_count};
+		view.triangles = {reinterpret_cast<const MeshTriangle *>(file->data + header.triangles_offset),
+						  header.triangle_count};
+		view.nodes = {reinterpret_cast<const LinearBVHNode *>(file->data + header.nodes_offset), header.node_count};
+		view.bounds = AABB(Point3{static_cast<Real>(header.bounds[0]), static_cast<Real>(header.bounds[1]),
+								  static_cast<Real>(header.bounds[2])},
+						   Point3{static_cast<Real>(header.bounds[3]), static_cast<Real>(header.bounds[4]),
+								  static_cast<Real>(header.bounds[5])});
+		if (!validView(view)) {
+			spdlog::warn("mesh cache {} indexes past its own buffers, rebuilding it", cache_path);
+			return nullptr;
+		}
+		return std::make_shared<TriangleMesh>(view, file, mat);
+	}
+
+	bool writeCache(const std::string &cache_path, const struct stat &source, const MeshView &view) {
+		CacheHeader header{};
+		std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+		header.version = cache_version;
+		header.node_size = sizeof(LinearBVHNode);
+		header.source_size = static_cast<uint64_t>(source.st_size);
+		header.source_mtime = modificationTime(source);
+		header.vertex_count = view.positions.size();
+		header.normal_count = view.normals.size();
+		header.uv_count = view.uvs.size();
+		header.triangle_count = view.triangles.size();
+		header.node_count = view.nodes.size();
+		header.positions_offset = alignSection(sizeof(CacheHeader));
+		header.normals_offset = alignSection(header.positions_offset + view.positions.size_bytes());
+		header.uvs_offset = alignSection(header.normals_offset + view.normals.size_bytes());
+		header.triangles_offset = alignSection(header.uvs_offset + view.uvs.size_bytes());
+		header.nodes_offset = alignSection(header.triangles_offset + view.triangles.size_bytes());
+		header.bounds[0] = view.bounds.x.min;
+		header.bounds[1] = view.bounds.y.min;
+		header.bounds[2] = view.bounds.z.min;
+		header.bounds[3] = view.bounds.x.max;
+		header.bounds[4] = view.bounds.y.max;
+		header.bounds[5] = view.bounds.z.max;
+
+		// written next to the cache and renamed over it, a reader never maps a half written file
+		auto temp_path = cache_path + ".tmp";
+		std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+		auto section = [&](uint64_t offset, const void *data, size_t size) {
+			static constexpr char zeros[section_alignment] = {};
+			out.write(zeros, static_cast<std::streamsize>(offset - static_cast<uint64_t>(out.tellp())));
+			out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+		};
+		out.write(reinterpret_cast<const char *>(&header), sizeof(CacheHeader));
+		section(header.positions_offset, view.positions.data(), view.positions.size_bytes());
+		section(header.normals_offset, view.normals.data(), view.normals.size_bytes());
+		section(header.uvs_offset, view.uvs.data(), view.uvs.size_bytes());
+		section(header.triangles_offset, view.triangles.data(), view.triangles.size_bytes());
+		section(header.nodes_offset, view.nodes.data(), view.nodes.size_bytes());
+		out.close();
+		std::error_code error;
+		if (!out || (std::filesystem::rename(temp_path, cache_path, error), error)) {
+			spdlog::warn("cannot write mesh cache {}", cache_path);
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+std::string meshCachePath(const std::string &filepath) { return filepath + ".hkmesh"; }
+
+std::shared_ptr<TriangleMesh> loadMesh(const std::string &filepath, std::shared_ptr<IMaterial> mat) {
+	auto begin = std::chrono::steady_clock::now();
+	struct stat source;
+	if (stat(filepath.c_str(), &source) == -1) {
+		spdlog::error("cannot open mesh {}: {}", filepath, std::strerror(errno));
+		return nullptr;
+	}
+	auto cache_path = meshCachePath(filepath);
+	if (auto mesh = openCache(cache_path, source, mat)) {
+		spdlog::info("mapped {} triangles of {} from its cache in {:.2f}ms", mesh->triangleCount(), filepath,
+					 secondsSince(begin) * 1e3);
+		return mesh;
+	}
+
+	auto file = MappedFile::open(filepath);
+	if (file == nullptr) {
+		spdlog::error("cannot read mesh {}", filepath);
+		return nullptr;
+	}
+	auto extension = std::filesystem::path(filepath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	ParsedMesh parsed;
+	bool ok;
+	if (extension == ".obj") {
+		ok = parseObj(*file, parsed);
+	} else if (extension == ".ply") {
+		ok = parsePly(*file, parsed);
+	} else {
+		spdlog::error("unknown mesh format {}", extension);
+		return nullptr;
+	}
+	if (!ok) {
+		spdlog::error("cannot load mesh {}", filepath);
+		return nullptr;
+	}
+	file.reset();
+	auto parse_time = secondsSince(begin);
+	auto mesh = std::make_shared<TriangleMesh>(std::move(parsed.positions), parsed.indices, mat,
+											   std::move(parsed.normals), std::move(parsed.uvs));
+	auto build_time = secondsSince(begin) - parse_time;
+	writeCache(cache_path, source, mesh->view());
+	spdlog::info("loaded {} triangles of {}: parsed in {:.3f}s, hierarchy built in {:.3f}s, {:.3f}s in total",
+				 mesh->triangleCount(), filepath, parse_time, build_time, secondsSince(begin));
+	return mesh;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file RayPacket.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "RayPacket.h"
+
+void RayPacket::set(int lane, const Ray &ray, float t_max) {
+	auto pos = ray.pos();
+	auto dir = ray.dir();
+	rays[lane] = ray;
+	ox[lane] = static_cast<float>(pos[0]);
+	oy[lane] = static_cast<float>(pos[1]);
+	oz[lane] = static_cast<float>(pos[2]);
+	dx[lane] = static_cast<float>(dir[0]);
+	dy[lane] = static_cast<float>(dir[1]);
+	dz[lane] = static_cast<float>(dir[2]);
+	// same rounding as the scalar traversal so both cull exactly the same boxes
+	inv_x[lane] = static_cast<float>(1.0 / dir[0]);
+	inv_y[lane] = static_cast<float>(1.0 / dir[1]);
+	inv_z[lane] = static_cast<float>(1.0 / dir[2]);
+	this->t_max[lane] = t_max;
+	active |= 1u << lane;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file SpherePool.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "SpherePool.h"
+#include <algorithm>
+#include <cmath>
+#include "BVHBuilder.h"
+#include "Material.h"
+
+void SpherePool::add(const Point3 &center, Real radius, const std::shared_ptr<IMaterial> &mat) {
+	add(center, center, radius, mat);
+}
+
+void SpherePool::add(const Point3 &init_center, const Point3 &final_center, Real radius,
+					 const std::shared_ptr<IMaterial> &mat) {
+	centers.push_back(init_center);
+	motions.emplace_back(final_center - init_center);
+	radii.push_back(radius);
+	material_ids.push_back(MaterialRegistry::instance().add(mat));
+	if (MaterialRegistry::isEmissive(material_ids.back()) && init_center == final_center) {
+		lights.push_back(std::make_shared<Sphere>(radius, init_center, mat));
+	}
+}
+
+void SpherePool::build() {
+	blocks.clear();
+	slot_sphere.clear();
+	nodes.clear();
+	if (centers.empty()) {
+		bbox = AABB(empty, empty, empty);
+		return;
+	}
+	std::vector<AABB> bounds;
+	bounds.reserve(centers.size());
+	for (size_t i = 0; i < centers.size(); i++) {
+		auto rvec = Vec3{radii[i], radii[i], radii[i]};
+		Point3 final_center = centers[i] + motions[i];
+		bounds.emplace_back(
+				AABB(AABB(centers[i] - rvec, centers[i] + rvec), AABB(final_center - rvec, final_center + rvec)));
+		bbox = i == 0 ? bounds.back() : AABB(bbox, bounds.back());
+	}
+	BVHBuildOptions options;
+	options.max_leaf_size = block_size;
+	// a whole block costs about as much as a couple of node tests, so leaves may as well be full
+	options.intersection_cost = 0.25f;
+	auto result = buildBVH(bounds, options);
+	nodes = std::move(result.nodes);
+	// every leaf gets a block of its own, its primitive offset becomes the block index
+	for (auto &node: nodes) {
+		if (!node.isLeaf())
+			continue;
+		SphereBlock block{};
+		for (uint32_t lane = 0; lane < node.primitive_count; lane++) {
+			auto sphere = result.primitive_order[node.primitive_offset + lane];
+			const auto &c = centers[sphere];
+			const auto &m = motions[sphere];
+			block.x[lane] = static_cast<float>(c.x());
+			block.y[lane] = static_cast<float>(c.y());
+			block.z[lane] = static_cast<float>(c.z());
+			block.motion_x[lane] = static_cast<float>(m.x());
+			block.motion_y[lane] = static_cast<float>(m.y());
+			block.motion_z[lane] = static_cast<float>(m.z());
+			block.radius[lane] = static_cast<float>(radii[sphere]);
+			block.magnitude[lane] =
+					static_cast<float>(std::max(c.lpNorm<Eigen::Infinity>(), (c + m).lpNorm<Eigen::Infinity>()));
+			block.moving = block.moving || !m.isZero(0);
+		}
+		for (uint32_t lane = 0; lane < block_size; lane++) {
+			slot_sphere.push_back(lane < node.primitive_count ? result.primitive_order[node.primitive_offset + lane]
+															  : 0);
+		}
+		node.primitive_offset = static_cast<uint32_t>(blocks.size());
+		blocks.push_back(block);
+	}
+}
+
+size_t SpherePool::size() const { return centers.size(); }
+
+SpherePool::FloatRay::FloatRay(const Ray &r) {
+	const auto &pos = r.pos();
+	const auto &d = r.dir();
+	for (int i = 0; i < 3; i++) {
+		origin[i] = static_cast<float>(pos[i]);
+		dir[i] = static_cast<float>(d[i]);
+	}
+	time = r.time();
+	float a = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+	inv_a = 1.0f / a;
+	inv_length = 1.0f / std::sqrt(a);
+	magnitude = std::max({std::fabs(origin[0]), std::fabs(origin[1]), std::fabs(origin[2])});
+}
+
+uint32_t SpherePool::candidates(const SphereBlock &block, const FloatRay &ray, Interval interval) {
+	auto cx = Float8::load(block.x);
+	auto cy = Float8::load(block.y);
+	auto cz = Float8::load(block.z);
+	if (block.moving) {
+		auto time = Float8::broadcast(ray.time);
+		cx = cx + time * Float8::load(block.motion_x);
+		cy = cy + time * Float8::load(block.motion_y);
+		cz = cz + time * Float8::load(block.motion_z);
+	}
+	auto ocx = Float8::broadcast(ray.origin[0]) - cx;
+	auto ocy = Float8::broadcast(ray.origin[1]) - cy;
+	auto ocz = Float8::broadcast(ray.origin[2]) - cz;
+	auto h = ocx * Float8::broadcast(ray.dir[0]) + ocy * Float8::broadcast(ray.dir[1]) +
+			 ocz * Float8::broadcast(ray.dir[2]);
+	auto oc2 = ocx * ocx + ocy * ocy + ocz * ocz;
+	auto inv_a = Float8::broadcast(ray.inv_a);
+	auto r = Float8::load(block.radius);
+	auto r2 = r * r;
+	// squared distance between center and ray, compared against the squared radius. rounding the
+	// inputs to float moves it by a few ulp of |oc|^2 and of |oc| * magnitude, the slack covers both
+	auto magnitude = Float8::broadcast(ray.magnitude) + Float8::load(block.magnitude);
+	auto slack = Float8::broadcast(4e-6f) * (oc2 + magnitude * magnitude);
+	auto reach = oc2 - h * h * inv_a <= r2 + slack;
+	// the hits lie within half a chord of the point closest to the center
+	auto t_center = (Float8::broadcast(0) - h) * inv_a;
+	auto inv_length = Float8::broadcast(ray.inv_length);
+	auto half = (sqrt(r2 + slack) + Float8::broadcast(1e-6f) * (magnitude + sqrt(oc2))) * inv_length;
+	auto in_range = (t_center + half >= Float8::broadcast(static_cast<float>(interval.min))) &
+					(t_center - half <= Float8::broadcast(static_cast<float>(interval.max)));
+	return (reach & in_range).bits();
+}
+
+bool SpherePool::hitBlock(uint32_t block_idx, uint32_t count, const Ray &r, const FloatRay &ray, Interval &interval,
+						  HitRecord &record) const {
+	auto lanes = candidates(blocks[block_idx], ray, interval) & ((1u << count) - 1);
+	bool hit_anything = false;
+	forEachLane(lanes, [&](int lane) {
+		auto sphere = slot_sphere[block_idx * block_size + lane];
+		const auto &motion = motions[sphere];
+		// same center as Sphere::getPosition
+		Point3 center = motion.isZero(0) ? centers[sphere] : centers[sphere] + r.time() * motion;
+		if (Sphere::intersect(r, center, radii[sphere], material_ids[sphere], interval, record)) {
+			hit_anything = true;
+			interval.max = record.t;
+		}
+	});
+	return hit_anything;
+}
+
+bool SpherePool::hit(const Ray &r, Interval interval, HitRecord &record) const {
+	if (nodes.empty()) {
+		return false;
+	}
+	return traverse(0, r, interval, record);
+}
+
+bool SpherePool::traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const {
+	FloatRay ray(r);
+	return traverseLinearBVH(nodes.data(), root, r, interval, [&](const LinearBVHNode &node, Interval &range) {
+		return hitBlock(node.primitive_offset, node.primitive_count, r, ray, range, record);
+	});
+}
+
+uint32_t SpherePool::hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const {
+	if (nodes.empty()) {
+		return 0;
+	}
+	return traverseLinearBVHPacket(
+			nodes.data(), packet, lanes, t_min,
+			[&](uint32_t node, int lane) {
+				if (!traverse(node, packet.rays[lane], Interval(t_min, packet.t_max[lane]), records[lane]))
+					return false;
+				packet.t_max[lane] = records[lane].t;
+				return true;
+			},
+			[&](const LinearBVHNode &node, uint32_t node_lanes) {
+				uint32_t hits = 0;
+				forEachLane(node_lanes, [&](int lane) {
+					FloatRay ray(packet.rays[lane]);
+					Interval interval(t_min, packet.t_max[lane]);
+					if (hitBlock(node.primitive_offset, node.primitive_count, packet.rays[lane], ray, interval,
+								 records[lane])) {
+						packet.t_max[lane] = records[lane].t;
+						hits |= 1u << lane;
+					}
+				});
+				return hits;
+			});
+}
+
+AABB SpherePool::boundingBox() const { return bbox; }
+
+void SpherePool::collectLights(std::vector<const IHittable *> &lights) const {
+	for (const auto &light: this->lights) {
+		lights.push_back(light.get());
+	}
+}
@@ -13,11 +13,7 @@ SolidColor::SolidColor(const Color &c) : color_val(c) {}
 SolidColor::SolidColor(float r, float g, float b) : color_val(Color{r, g, b}) {}
 Color SolidColor::value(float u, float v, const Point3 &p) const { return color_val; }
 Color CheckerTexture::value(float u, float v, const Point3 &p) const {
-	auto u_int = static_cast<int>(u * 50 * inv_scale);
-	auto v_int = static_cast<int>(v * 50 * inv_scale);
-
-	bool is_even = (u_int + v_int) % 2 == 0;
-	return is_even ? even->value(u, v, p) : odd->value(u, v, p);
+	return isEven(inv_scale, u, v) ? even->value(u, v, p) : odd->value(u, v, p);
 }
 CheckerTexture::CheckerTexture(float scale, std::shared_ptr<ITexture> even_tex, std::shared_ptr<ITexture> odd_tex) :
 	inv_scale(1 / scale), even(std::move(even_tex)), odd(std::move(odd_tex)) {}
@@ -28,36 +24,42 @@ CheckerTexture::CheckerTexture(float scale, const Color &even_color, const Color
 }
 
 
-Color ImageTexture::value(float u, float v, const Point3 &p) const {
-	if (img.height() <= 0)
-		return Color{0, 1, 1};
-
-	u = Interval(0, 1).clamp(u);
-	v = 1.0 - Interval(0, 1).clamp(v);
+Color ImageTexture::value(float u, float v, const Point3 &p) const { return filtered(u, v, 0); }
 
-	auto i = static_cast<int>(u * img.width());
-	auto j = static_cast<int>(v * img.height());
-	auto pixel = img.pixelData(i, j);
-
-	float color_scale = 1.0 / 255.0;
-	return Color{color_scale * pixel[0], color_scale * pixel[1], color_scale * pixel[2]};
+Color ImageTexture::filtered(float u, float v, float width) const {
+	auto &cache = TextureCache::instance();
+	switch (filter) {
+		case TEXTURE_FILTER_NEAREST:
+			return cache.nearest(texture_id, 0, u, v);
+		case TEXTURE_FILTER_BILINEAR:
+			return cache.bilinear(texture_id, 0, u, v);
+		default:
+			return cache.trilinear(texture_id, u, v, width);
+	}
 }
 
-
-ImageTexture::ImageTexture(const std::string &image, const std::string &parent) : img(Image(image, parent)) {}
+ImageTexture::ImageTexture(const std::string &image, const std::string &parent, TextureFilter filter, bool srgb) :
+	filter(filter) {
+	Image img(image, parent);
+	texture_id = TextureCache::instance().add(img.pixelData(0, 0), img.width(), img.height(), srgb);
+}
 
 NoiseTexture::NoiseTexture(float frequency, int octave_count, float presistence) :
-	frequency(frequency), octave_count(octave_count), persistence(presistence) {}
+	noise(frequency, octave_count, presistence) {}
 
 Color NoiseTexture::value(float u, float v, const Point3 &p) const {
-	return Color{1, 1, 1} * fabs(sin(10 * noise.octaveNoise(p, frequency, octave_count, persistence) + 5));
+	return Color{1, 1, 1} * fabs(sin(10 * noise.value(p) + 5));
 }
 
+void NoiseTexture::bake(const AABB &bounds, int resolution) { noise.bake(bounds, resolution); }
+
 TerrainTexture::TerrainTexture(float frequency, int octave_count, float presistence) :
-	frequency(frequency), octave_count(octave_count), persistence(presistence) {}
+	noise(frequency, octave_count, presistence) {}
+
+void TerrainTexture::bake(const AABB &bounds, int resolution) { noise.bake(bounds, resolution); }
 
 Color TerrainTexture::value(float u, float v, const Point3 &p) const {
-	float height = noise.octaveNoise(p, frequency, octave_count, persistence);
+	float height = noise.value(p);
 	if (Interval(-1, 0).within(height)) {
 		return Color{0, 0, 1} + Color{0, 0, 0xee / 255.0} * height;
 	}
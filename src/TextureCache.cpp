@@ -0,0 +1,271 @@
+/**
+ * @file TextureCache.cpp
+ * @author ayano
+ * @date 10/18/26
+ * @brief
+ */
+
+#include "TextureCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+namespace {
+	constexpr int tile_size = TextureTile::size;
+
+	float srgbToLinear(float c) { return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f); }
+
+	int tilesAlong(int texels) { return (texels + tile_size - 1) / tile_size; }
+
+	/**
+	 * one level of the pyramid while it is built, linear RGB, row major
+	 */
+	struct LevelImage {
+		int width;
+		int height;
+		std::vector<float> rgb;
+
+		const float *at(int x, int y) const {
+			x = std::min(x, width - 1);
+			y = std::min(y, height - 1);
+			return rgb.data() + 3 * (static_cast<size_t>(y) * width + x);
+		}
+	};
+
+	LevelImage downsample(const LevelImage &level) {
+		LevelImage next{std::max(1, (level.width + 1) / 2), std::max(1, (level.height + 1) / 2), {}};
+		next.rgb.resize(3 * static_cast<size_t>(next.width) * next.height);
+		for (int y = 0; y < next.height; y++) {
+			for (int x = 0; x < next.width; x++) {
+				// odd sizes repeat the last row or column instead of reading past it
+				const float *a = level.at(2 * x, 2 * y), *b = level.at(2 * x + 1, 2 * y);
+				const float *c = level.at(2 * x, 2 * y + 1), *d = level.at(2 * x + 1, 2 * y + 1);
+				float *out = next.rgb.data() + 3 * (static_cast<size_t>(y) * next.width + x);
+				for (int i = 0; i < 3; i++)
+					out[i] = 0.25f * (a[i] + b[i] + c[i] + d[i]);
+			}
+		}
+		return next;
+	}
+
+	/**
+	 * append the tiles of a level to the file, edge tiles repeat the last texel
+	 * @return number of tiles written
+	 */
+	uint32_t writeTiles(const LevelImage &level, std::FILE *file) {
+		TextureTile tile;
+		uint32_t count = 0;
+		for (int ty = 0; ty < tilesAlong(level.height); ty++) {
+			for (int tx = 0; tx < tilesAlong(level.width); tx++) {
+				for (int y = 0; y < tile_size; y++) {
+					for (int x = 0; x < tile_size; x++) {
+						std::copy_n(level.at(tx * tile_size + x, ty * tile_size + y), 3,
+									tile.texels + 3 * (y * tile_size + x));
+					}
+				}
+				std::fwrite(&tile, sizeof(tile), 1, file);
+				count++;
+			}
+		}
+		return count;
+	}
+
+	/**
+	 * tiles a thread read last, direct mapped. a bilinear footprint on a tile edge reads two or four tiles
+	 * and a scanline keeps coming back to the tiles of the one before, neither needs a shard lock
+	 */
+	struct ThreadTiles {
+		static constexpr int size = 256;
+
+		uint64_t keys[size];
+		std::shared_ptr<const TextureTile> tiles[size];
+		// TextureCache::clear() bumps the generation, a thread drops its tiles when it sees a new one
+		uint64_t generation = 0;
+
+		ThreadTiles() { std::fill_n(keys, size, ~0ull); }
+
+		void reset(uint64_t to) {
+			std::fill_n(keys, size, ~0ull);
+			std::fill_n(tiles, size, nullptr);
+			generation = to;
+		}
+	};
+
+	std::atomic<uint64_t> tile_generation{0};
+	thread_local ThreadTiles thread_tiles;
+} // namespace
+
+TextureCache &TextureCache::instance() {
+	static TextureCache cache;
+	return cache;
+}
+
+TextureCache::TextureCache() { setBudget(256ull << 20); }
+
+TextureCache::~TextureCache() {
+	for (auto &texture: textures) {
+		std::fclose(texture->file);
+	}
+}
+
+uint32_t TextureCache::add(const unsigned char *rgb, int width, int height, bool srgb) {
+	float decode[256];
+	for (int i = 0; i < 256; i++) {
+		decode[i] = srgb ? srgbToLinear(i / 255.0f) : i / 255.0f;
+	}
+	LevelImage level{width, height, {}};
+	level.rgb.resize(3 * static_cast<size_t>(width) * height);
+	std::transform(rgb, rgb + level.rgb.size(), level.rgb.begin(), [&](unsigned char c) { return decode[c]; });
+
+	auto texture = std::make_unique<Texture>();
+	texture->file = std::tmpfile();
+	if (texture->file == nullptr) {
+		spdlog::critical("cannot create the tile file of a {} * {} texture, aborting", width, height);
+		exit(-1);
+	}
+	uint32_t tile_count = 0;
+	while (true) {
+		texture->levels.push_back(Level{level.width, level.height, tilesAlong(level.width), tile_count});
+		tile_count += writeTiles(level, texture->file);
+		if (level.width == 1 && level.height == 1)
+			break;
+		level = downsample(level);
+	}
+	std::fflush(texture->file);
+
+	std::lock_guard lock(add_mutex);
+	auto id = static_cast<uint32_t>(textures.size());
+	spdlog::info("texture {}: {} * {}, {} levels, {} tiles, {:.1f} MB on disk", id, width, height,
+				 texture->levels.size(), tile_count, tile_count * sizeof(TextureTile) / 1e6);
+	textures.push_back(std::move(texture));
+	return id;
+}
+
+void TextureCache::setBudget(size_t bytes) {
+	budget = bytes;
+	for (auto &shard: shards) {
+		std::lock_guard lock(shard.mutex);
+		shard.capacity = std::max<size_t>(1, bytes / sizeof(TextureTile) / shard_count);
+		while (shard.lru.size() > shard.capacity) {
+			shard.tiles.erase(shard.lru.back().first);
+			shard.lru.pop_back();
+		}
+	}
+}
+
+size_t TextureCache::getBudget() const { return budget; }
+
+void TextureCache::clear() {
+	thread_tiles.reset(tile_generation.fetch_add(1, std::memory_order_relaxed) + 1);
+	for (auto &shard: shards) {
+		std::lock_guard lock(shard.mutex);
+		shard.lru.clear();
+		shard.tiles.clear();
+		shard.hits = shard.misses = 0;
+	}
+}
+
+TextureCache::Stats TextureCache::stats() const {
+	Stats result{0, 0, 0};
+	for (auto &shard: shards) {
+		std::lock_guard lock(shard.mutex);
+		result.hits += shard.hits;
+		result.misses += shard.misses;
+		result.resident_bytes += shard.lru.size() * sizeof(TextureTile);
+	}
+	return result;
+}
+
+int TextureCache::levels(uint32_t id) const { return static_cast<int>(textures[id]->levels.size()); }
+
+std::shared_ptr<const TextureTile> TextureCache::load(const Texture &texture, uint32_t index) const {
+	auto tile = std::make_shared<TextureTile>();
+	// pread keeps no file position, so threads missing at the same time do not need to agree on one
+	auto offset = static_cast<off_t>(index) * sizeof(TextureTile);
+	auto read = pread(fileno(texture.file), tile->texels, sizeof(TextureTile), offset);
+	if (read != static_cast<ssize_t>(sizeof(TextureTile))) {
+		spdlog::error("short read of texture tile {}", index);
+	}
+	return tile;
+}
+
+std::shared_ptr<const TextureTile> TextureCache::tile(uint32_t id, uint32_t index) const {
+	auto key = static_cast<uint64_t>(id) << 32 | index;
+	auto &shard = shards[(key * 0x9E3779B97F4A7C15ull) >> 60];
+	std::lock_guard lock(shard.mutex);
+	auto found = shard.tiles.find(key);
+	if (found != shard.tiles.end()) {
+		shard.hits++;
+		shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+		return found->second->second;
+	}
+	shard.misses++;
+	auto loaded = load(*textures[id], index);
+	shard.lru.emplace_front(key, loaded);
+	shard.tiles[key] = shard.lru.begin();
+	if (shard.lru.size() > shard.capacity) {
+		// a tile still held by a lookup stays alive until that lookup lets go of it
+		shard.tiles.erase(shard.lru.back().first);
+		shard.lru.pop_back();
+	}
+	return loaded;
+}
+
+Color TextureCache::texel(uint32_t id, const Level &level, int x, int y) const {
+	auto index = level.first_tile + (y / tile_size) * level.tiles_x + x / tile_size;
+	auto key = static_cast<uint64_t>(id) << 32 | index;
+	auto slot = (key ^ key >> 7) % ThreadTiles::size;
+	auto generation = tile_generation.load(std::memory_order_relaxed);
+	if (thread_tiles.generation != generation)
+		thread_tiles.reset(generation);
+	if (thread_tiles.keys[slot] != key) {
+		thread_tiles.tiles[slot] = tile(id, index);
+		thread_tiles.keys[slot] = key;
+	}
+	const float *t = thread_tiles.tiles[slot]->texels + 3 * ((y % tile_size) * tile_size + x % tile_size);
+	return Color{t[0], t[1], t[2]};
+}
+
+Color TextureCache::nearest(uint32_t id, int level, float u, float v) const {
+	const auto &l = textures[id]->levels[level];
+	u = Interval(0, 1).clamp(u);
+	v = 1 - Interval(0, 1).clamp(v);
+	int x = std::min(static_cast<int>(u * l.width), l.width - 1);
+	int y = std::min(static_cast<int>(v * l.height), l.height - 1);
+	return texel(id, l, x, y);
+}
+
+Color TextureCache::bilinear(uint32_t id, int level, float u, float v) const {
+	const auto &l = textures[id]->levels[level];
+	// texel centers sit at half integers
+	float x = Interval(0, 1).clamp(u) * l.width - 0.5f;
+	float y = (1 - Interval(0, 1).clamp(v)) * l.height - 0.5f;
+	float fx = std::floor(x), fy = std::floor(y);
+	float dx = x - fx, dy = y - fy;
+	int x0 = std::clamp(static_cast<int>(fx), 0, l.width - 1), x1 = std::min(x0 + 1, l.width - 1);
+	int y0 = std::clamp(static_cast<int>(fy), 0, l.height - 1), y1 = std::min(y0 + 1, l.height - 1);
+	// left of the first texel center the weight of x0 is still 1
+	if (fx < 0)
+		x1 = x0;
+	if (fy < 0)
+		y1 = y0;
+	Color top = (1 - dx) * texel(id, l, x0, y0) + dx * texel(id, l, x1, y0);
+	Color bottom = (1 - dx) * texel(id, l, x0, y1) + dx * texel(id, l, x1, y1);
+	return (1 - dy) * top + dy * bottom;
+}
+
+Color TextureCache::trilinear(uint32_t id, float u, float v, float width) const {
+	const auto &levels = textures[id]->levels;
+	auto size = static_cast<float>(std::max(levels[0].width, levels[0].height));
+	float level = std::log2(std::max(width * size, 1.0f));
+	int top = static_cast<int>(levels.size()) - 1;
+	if (level >= top)
+		return bilinear(id, top, u, v);
+	int fine = static_cast<int>(level);
+	float t = level - fine;
+	if (t == 0)
+		return bilinear(id, fine, u, v);
+	return (1 - t) * bilinear(id, fine, u, v) + t * bilinear(id, fine + 1, u, v);
+}
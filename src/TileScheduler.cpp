@@ -0,0 +1,112 @@
+/**
+ * @file TileScheduler.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "TileScheduler.h"
+#include <algorithm>
+
+TileScheduler::TileScheduler(int width, int height, int tile_dimension, int worker_count) :
+	worker_count(std::max(1, worker_count)) {
+	tile_dimension = std::max(1, tile_dimension);
+	int tiles_x = (width + tile_dimension - 1) / tile_dimension;
+	int tiles_y = (height + tile_dimension - 1) / tile_dimension;
+	uint32_t side = 1;
+	while (side < static_cast<uint32_t>(std::max(tiles_x, tiles_y))) {
+		side <<= 1;
+	}
+
+	std::vector<std::pair<uint32_t, ImageChunk>> ordered;
+	ordered.reserve(tiles_x * tiles_y);
+	int idx = 0;
+	for (int ty = 0; ty < tiles_y; ty++) {
+		for (int tx = 0; tx < tiles_x; tx++) {
+			ImageChunk chunk;
+			chunk.chunk_idx = idx++;
+			chunk.startx = tx * tile_dimension;
+			chunk.starty = ty * tile_dimension;
+			chunk.width = std::min(tile_dimension, width - chunk.startx);
+			chunk.height = std::min(tile_dimension, height - chunk.starty);
+			ordered.emplace_back(hilbertIndex(side, tx, ty), chunk);
+		}
+	}
+	std::sort(ordered.begin(), ordered.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+	tiles.reserve(ordered.size());
+	for (const auto &[key, chunk]: ordered) {
+		tiles.push_back(chunk);
+	}
+
+	ranges = std::make_unique<WorkerRange[]>(this->worker_count);
+	auto count = static_cast<uint32_t>(tiles.size());
+	for (int i = 0; i < this->worker_count; i++) {
+		auto begin = static_cast<uint32_t>(static_cast<uint64_t>(count) * i / this->worker_count);
+		auto end = static_cast<uint32_t>(static_cast<uint64_t>(count) * (i + 1) / this->worker_count);
+		ranges[i].range.store(pack(begin, end), std::memory_order_relaxed);
+	}
+}
+
+bool TileScheduler::next(int worker, ImageChunk &chunk) { return pop(worker, chunk) || steal(worker, chunk); }
+
+int TileScheduler::tileCount() const { return static_cast<int>(tiles.size()); }
+
+int TileScheduler::workerCount() const { return worker_count; }
+
+uint64_t TileScheduler::stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+uint32_t TileScheduler::hilbertIndex(uint32_t n, uint32_t x, uint32_t y) {
+	uint32_t d = 0;
+	for (uint32_t s = n / 2; s > 0; s /= 2) {
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+uint64_t TileScheduler::pack(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+
+bool TileScheduler::pop(int worker, ImageChunk &chunk) {
+	auto &own = ranges[worker].range;
+	auto current = own.load(std::memory_order_acquire);
+	while (true) {
+		auto begin = static_cast<uint32_t>(current >> 32);
+		auto end = static_cast<uint32_t>(current);
+		if (begin >= end)
+			return false;
+		if (own.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+			chunk = tiles[begin];
+			return true;
+		}
+	}
+}
+
+bool TileScheduler::steal(int worker, ImageChunk &chunk) {
+	for (int offset = 1; offset < worker_count; offset++) {
+		auto &victim = ranges[(worker + offset) % worker_count].range;
+		auto current = victim.load(std::memory_order_acquire);
+		while (true) {
+			auto begin = static_cast<uint32_t>(current >> 32);
+			auto end = static_cast<uint32_t>(current);
+			if (begin >= end)
+				break;
+			auto take = (end - begin + 1) / 2;
+			if (victim.compare_exchange_weak(current, pack(begin, end - take), std::memory_order_acq_rel)) {
+				steals.fetch_add(1, std::memory_order_relaxed);
+				chunk = tiles[end - take];
+				// our own run is empty, so nobody else writes it until the stolen tiles are published
+				ranges[worker].range.store(pack(end - take + 1, end), std::memory_order_release);
+				return true;
+			}
+		}
+	}
+	return false;
+}
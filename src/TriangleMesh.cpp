@@ -0,0 +1,314 @@
+/**
+ * @file TriangleMesh.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "TriangleMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "BVHBuilder.h"
+#include "Material.h"
+#include "spdlog/spdlog.h"
+
+namespace {
+	/**
+	 * buffers of a mesh built in memory
+	 */
+	struct MeshBuffers {
+		std::vector<Eigen::Vector3f> positions;
+		std::vector<Eigen::Vector3f> normals;
+		std::vector<Eigen::Vector2f> uvs;
+		std::vector<MeshTriangle> triangles;
+		std::vector<LinearBVHNode> nodes;
+	};
+} // namespace
+
+TriangleMesh::TriangleMesh(std::vector<Eigen::Vector3f> positions, const std::vector<uint32_t> &indices,
+						   std::shared_ptr<IMaterial> mat, std::vector<Eigen::Vector3f> normals,
+						   std::vector<Eigen::Vector2f> uvs) :
+	material_id(MaterialRegistry::instance().add(mat)) {
+	auto buffers = std::make_shared<MeshBuffers>();
+	buffers->positions = std::move(positions);
+	buffers->normals = std::move(normals);
+	buffers->uvs = std::move(uvs);
+	const auto vertex_count = buffers->positions.size();
+	if (!buffers->normals.empty() && buffers->normals.size() != vertex_count) {
+		spdlog::warn("mesh has {} normals for {} vertices, using flat shading", buffers->normals.size(),
+					 vertex_count);
+		buffers->normals.clear();
+	}
+	if (!buffers->uvs.empty() && buffers->uvs.size() != vertex_count) {
+		spdlog::warn("mesh has {} uvs for {} vertices, ignoring them", buffers->uvs.size(), vertex_count);
+		buffers->uvs.clear();
+	}
+	std::vector<MeshTriangle> input;
+	input.reserve(indices.size() / 3);
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		MeshTriangle triangle{{indices[i], indices[i + 1], indices[i + 2]}};
+		if (triangle.v[0] >= vertex_count || triangle.v[1] >= vertex_count || triangle.v[2] >= vertex_count) {
+			spdlog::warn("mesh triangle {} refers to a missing vertex, skipping it", i / 3);
+			continue;
+		}
+		input.push_back(triangle);
+	}
+
+	AABB bbox(empty, empty, empty);
+	if (!input.empty()) {
+		std::vector<AABB> bounds;
+		bounds.reserve(input.size());
+		for (const auto &triangle: input) {
+			Point3 a = buffers->positions[triangle.v[0]].cast<Real>();
+			Point3 b = buffers->positions[triangle.v[1]].cast<Real>();
+			Point3 c = buffers->positions[triangle.v[2]].cast<Real>();
+			// axis aligned triangles have flat boxes, pad them like Triangle does
+			bounds.push_back(AABB(AABB(a, b), AABB(a, c)).pad());
+			bbox = bounds.size() == 1 ? bounds.back() : AABB(bbox, bounds.back());
+		}
+		auto result = buildBVH(bounds);
+		buffers->nodes = std::move(result.nodes);
+		// store the triangles in leaf order so primitive offsets index them directly
+		buffers->triangles.reserve(input.size());
+		for (auto triangle: result.primitive_order) {
+			buffers->triangles.push_back(input[triangle]);
+		}
+	}
+	mesh = MeshView{buffers->positions, buffers->normals, buffers->uvs, buffers->triangles, buffers->nodes, bbox};
+	storage = std::move(buffers);
+	makeLightDistribution();
+}
+
+TriangleMesh::TriangleMesh(const MeshView &view, std::shared_ptr<const void> storage,
+						   std::shared_ptr<IMaterial> mat) :
+	mesh(view), storage(std::move(storage)), material_id(MaterialRegistry::instance().add(mat)) {
+	makeLightDistribution();
+}
+
+void TriangleMesh::makeLightDistribution() {
+	if (!MaterialRegistry::isEmissive(material_id)) {
+		return;
+	}
+	area_cdf.reserve(mesh.triangles.size());
+	Real total = 0;
+	for (const auto &triangle: mesh.triangles) {
+		const auto &a = mesh.positions[triangle.v[0]];
+		Vec3 n = (mesh.positions[triangle.v[1]] - a).cross(mesh.positions[triangle.v[2]] - a).cast<Real>();
+		total += n.norm() / 2;
+		area_cdf.push_back(total);
+	}
+	if (total <= 0) {
+		area_cdf.clear();
+	}
+}
+
+const MeshView &TriangleMesh::view() const { return mesh; }
+
+size_t TriangleMesh::triangleCount() const { return mesh.triangles.size(); }
+
+size_t TriangleMesh::vertexCount() const { return mesh.positions.size(); }
+
+size_t TriangleMesh::memoryUsage() const {
+	return mesh.positions.size_bytes() + mesh.normals.size_bytes() + mesh.uvs.size_bytes() +
+		   mesh.triangles.size_bytes() + mesh.nodes.size_bytes();
+}
+
+TriangleMesh::ShearedRay::ShearedRay(const Ray &r) : origin(r.pos().cast<double>()) {
+	Eigen::Vector3d dir = r.dir().cast<double>();
+	kz = 0;
+	if (std::fabs(dir.y()) > std::fabs(dir[kz]))
+		kz = 1;
+	if (std::fabs(dir.z()) > std::fabs(dir[kz]))
+		kz = 2;
+	kx = kz == 2 ? 0 : kz + 1;
+	ky = kx == 2 ? 0 : kx + 1;
+	// keep the winding of the triangles when the ray points down the dominant axis
+	if (dir[kz] < 0)
+		std::swap(kx, ky);
+	sx = dir[kx] / dir[kz];
+	sy = dir[ky] / dir[kz];
+	sz = 1.0 / dir[kz];
+}
+
+bool TriangleMesh::hitTriangle(uint32_t triangle, const Ray &r, const ShearedRay &ray, Interval &interval,
+							   HitRecord &record) const {
+	const auto &tri = mesh.triangles[triangle];
+	Eigen::Vector3d a = mesh.positions[tri.v[0]].cast<double>() - ray.origin;
+	Eigen::Vector3d b = mesh.positions[tri.v[1]].cast<double>() - ray.origin;
+	Eigen::Vector3d c = mesh.positions[tri.v[2]].cast<double>() - ray.origin;
+	// in the sheared space the ray is the z axis and the test is two dimensional
+	double ax = a[ray.kx] - ray.sx * a[ray.kz];
+	double ay = a[ray.ky] - ray.sy * a[ray.kz];
+	double bx = b[ray.kx] - ray.sx * b[ray.kz];
+	double by = b[ray.ky] - ray.sy * b[ray.kz];
+	double cx = c[ray.kx] - ray.sx * c[ray.kz];
+	double cy = c[ray.ky] - ray.sy * c[ray.kz];
+	// scaled barycentric coordinates, the signed areas of the edges as seen from the ray
+	double e0 = cx * by - cy * bx;
+	double e1 = ax * cy - ay * cx;
+	double e2 = bx * ay - by * ax;
+	if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0)) {
+		return false;
+	}
+	double det = e0 + e1 + e2;
+	if (det == 0) {
+		return false;
+	}
+	double scaled_t = ray.sz * (e0 * a[ray.kz] + e1 * b[ray.kz] + e2 * c[ray.kz]);
+	double t = scaled_t / det;
+	if (!interval.surround(t)) {
+		return false;
+	}
+	double b0 = e0 / det;
+	double b1 = e1 / det;
+	double b2 = e2 / det;
+
+	const auto &p0 = mesh.positions[tri.v[0]];
+	const auto &p1 = mesh.positions[tri.v[1]];
+	const auto &p2 = mesh.positions[tri.v[2]];
+	Vec3 geometric = (p1 - p0).cross(p2 - p0).cast<Real>().normalized();
+	record.t = static_cast<Real>(t);
+	record.p = r.at(t);
+	record.material_id = material_id;
+	record.setFaceNormal(r, geometric);
+	if (!mesh.normals.empty()) {
+		Vec3 shading =
+				(b0 * mesh.normals[tri.v[0]].cast<double>() + b1 * mesh.normals[tri.v[1]].cast<double>() +
+				 b2 * mesh.normals[tri.v[2]].cast<double>())
+						.cast<Real>();
+		if (shading.squaredNorm() > 0) {
+			shading.normalize();
+			// shading normals stay on the side the ray arrived from
+			record.normal = shading.dot(record.normal) < 0 ? -shading : shading;
+		}
+	}
+	if (mesh.uvs.empty()) {
+		record.u = static_cast<Real>(b1);
+		record.v = static_cast<Real>(b2);
+	} else {
+		Eigen::Vector2d uv = b0 * mesh.uvs[tri.v[0]].cast<double>() + b1 * mesh.uvs[tri.v[1]].cast<double>() +
+							 b2 * mesh.uvs[tri.v[2]].cast<double>();
+		record.u = static_cast<Real>(uv.x());
+		record.v = static_cast<Real>(uv.y());
+	}
+	interval.max = t;
+	return true;
+}
+
+bool TriangleMesh::hitLeaf(const LinearBVHNode &node, const Ray &r, const ShearedRay &ray, Interval &interval,
+						   HitRecord &record) const {
+	bool hit_anything = false;
+	for (uint32_t i = 0; i < node.primitive_count; i++) {
+		hit_anything |= hitTriangle(node.primitive_offset + i, r, ray, interval, record);
+	}
+	return hit_anything;
+}
+
+bool TriangleMesh::hit(const Ray &r, Interval interval, HitRecord &record) const {
+	if (mesh.nodes.empty()) {
+		return false;
+	}
+	return traverse(0, r, interval, record);
+}
+
+bool TriangleMesh::traverse(uint32_t root, const Ray &r, Interval interval, HitRecord &record) const {
+	ShearedRay ray(r);
+	return traverseLinearBVH(mesh.nodes.data(), root, r, interval, [&](const LinearBVHNode &node, Interval &range) {
+		return hitLeaf(node, r, ray, range, record);
+	});
+}
+
+uint32_t TriangleMesh::hitPacket(RayPacket &packet, uint32_t lanes, float t_min, HitRecord *records) const {
+	if (mesh.nodes.empty()) {
+		return 0;
+	}
+	return traverseLinearBVHPacket(
+			mesh.nodes.data(), packet, lanes, t_min,
+			[&](uint32_t node, int lane) {
+				if (!traverse(node, packet.rays[lane], Interval(t_min, packet.t_max[lane]), records[lane]))
+					return false;
+				packet.t_max[lane] = records[lane].t;
+				return true;
+			},
+			[&](const LinearBVHNode &node, uint32_t node_lanes) {
+				uint32_t hits = 0;
+				forEachLane(node_lanes, [&](int lane) {
+					ShearedRay ray(packet.rays[lane]);
+					Interval interval(t_min, packet.t_max[lane]);
+					if (hitLeaf(node, packet.rays[lane], ray, interval, records[lane])) {
+						packet.t_max[lane] = records[lane].t;
+						hits |= 1u << lane;
+					}
+				});
+				return hits;
+			});
+}
+
+AABB TriangleMesh::boundingBox() const { return mesh.bounds; }
+
+void TriangleMesh::collectLights(std::vector<const IHittable *> &lights) const {
+	if (!area_cdf.empty()) {
+		lights.push_back(this);
+	}
+}
+
+Vec3 TriangleMesh::sampleDirection(const Point3 &origin) const {
+	// degenerate triangles add nothing to the sum, so upper_bound never lands on one
+	auto target = randomFloat() * area_cdf.back();
+	auto found = std::upper_bound(area_cdf.begin(), area_cdf.end(), target);
+	const auto &tri = mesh.triangles[std::min<size_t>(found - area_cdf.begin(), area_cdf.size() - 1)];
+	Point3 a = mesh.positions[tri.v[0]].cast<Real>();
+	Vec3 u = mesh.positions[tri.v[1]].cast<Real>() - a;
+	Vec3 v = mesh.positions[tri.v[2]].cast<Real>() - a;
+	auto s = randomFloat();
+	auto t = randomFloat();
+	// fold the other half of the parallelogram back onto the triangle
+	if (s + t > 1) {
+		s = 1 - s;
+		t = 1 - t;
+	}
+	return a + s * u + t * v - origin;
+}
+
+float TriangleMesh::directionPdf(const Point3 &origin, const Vec3 &direction) const {
+	if (area_cdf.empty()) {
+		return 0;
+	}
+	Ray r(origin, direction);
+	Interval interval(EPS, INF);
+	HitRecord record;
+	uint32_t triangle;
+	Real pdf = 0;
+	// every crossing could have been the sampled point, their area densities add up
+	while (hitIndex(r, interval, record, triangle)) {
+		const auto &tri = mesh.triangles[triangle];
+		const auto &a = mesh.positions[tri.v[0]];
+		Vec3 normal = (mesh.positions[tri.v[1]] - a).cross(mesh.positions[tri.v[2]] - a).cast<Real>().normalized();
+		auto distance_squared = record.t * record.t * direction.squaredNorm();
+		auto cos = std::fabs(direction.dot(normal)) / direction.norm();
+		if (cos > 0) {
+			pdf += distance_squared / cos;
+		}
+		interval.min = record.t;
+	}
+	return static_cast<float>(pdf / area_cdf.back());
+}
+
+bool TriangleMesh::hitIndex(const Ray &r, Interval interval, HitRecord &record, uint32_t &triangle) const {
+	if (mesh.nodes.empty()) {
+		return false;
+	}
+	ShearedRay ray(r);
+	return traverseLinearBVH(mesh.nodes.data(), 0, r, interval, [&](const LinearBVHNode &node, Interval &range) {
+		bool hit_anything = false;
+		for (uint32_t i = 0; i < node.primitive_count; i++) {
+			// a hit lowers range.max, so the last one is the closest so far
+			if (hitTriangle(node.primitive_offset + i, r, ray, range, record)) {
+				triangle = node.primitive_offset + i;
+				hit_anything = true;
+			}
+		}
+		return hit_anything;
+	});
+}
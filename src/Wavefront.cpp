@@ -0,0 +1,106 @@
+/**
+ * @file Wavefront.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "Wavefront.h"
+#include <algorithm>
+#include "Camera.h"
+#include "Material.h"
+#include "RayPacket.h"
+
+WavefrontIntegrator::WavefrontIntegrator(size_t batch_size) : batch_size(batch_size) {}
+
+void WavefrontIntegrator::renderTile(Camera &camera, const IHittable &world, FramebufferTile &tile, int first_sample,
+									 int samples) {
+	const auto &chunk = tile.chunk();
+	const size_t pixels = static_cast<size_t>(chunk.width) * chunk.height;
+	const size_t total = pixels * samples;
+	const auto background = camera.getBackground();
+	sums.assign(pixels, Color{0, 0, 0});
+	for (size_t first = 0; first < total; first += batch_size) {
+		generate(camera, chunk, first_sample, first, std::min(batch_size, total - first));
+		// a path still alive after render_depth bounces contributes nothing, same as the recursion
+		for (int bounce = 0; bounce < camera.getRenderDepth() && !paths.empty(); bounce++) {
+			intersect(world, background);
+			sortByMaterial();
+			shade(bounce, camera.getRouletteMinDepth());
+			std::swap(paths, survivors);
+		}
+	}
+	for (int i = 0; i < chunk.height; i++) {
+		for (int j = 0; j < chunk.width; j++) {
+			tile.accumulateColor(j, i, sums[i * chunk.width + j], samples);
+		}
+	}
+}
+
+void WavefrontIntegrator::generate(Camera &camera, const ImageChunk &chunk, int first_sample, size_t first,
+								   size_t count) {
+	const size_t pixels = static_cast<size_t>(chunk.width) * chunk.height;
+	paths.clear();
+	for (size_t n = first; n < first + count; n++) {
+		// sample major, so neighbouring paths start from neighbouring pixels
+		auto sample = static_cast<uint32_t>(first_sample + n / pixels);
+		auto pixel = static_cast<uint32_t>(n % pixels);
+		int x = chunk.startx + static_cast<int>(pixel % chunk.width);
+		int y = chunk.starty + static_cast<int>(pixel / chunk.width);
+		seedSampleStream(camera.getFrame(), static_cast<uint32_t>(y * camera.getWidth() + x), sample);
+		auto ray = camera.getRay(x, y);
+		paths.push_back(PathState{ray, Color{1, 1, 1}, threadRng(), pixel});
+	}
+}
+
+void WavefrontIntegrator::intersect(const IHittable &world, const Color &background) {
+	records.resize(paths.size());
+	hit_bins.clear();
+	RayPacket packet{};
+	for (size_t base = 0; base < paths.size(); base += RayPacket::size) {
+		packet.active = 0;
+		auto lanes = std::min<size_t>(RayPacket::size, paths.size() - base);
+		for (size_t lane = 0; lane < lanes; lane++) {
+			packet.set(static_cast<int>(lane), paths[base + lane].ray);
+		}
+		auto hits = world.hitPacket(packet, packet.active, EPS, records.data() + base);
+		forEachLane(packet.active, [&](int lane) {
+			auto idx = static_cast<uint32_t>(base + lane);
+			if (hits & (1u << lane)) {
+				auto material_id = records[idx].material_id;
+				hit_bins.push_back(HitBin{MaterialRegistry::record(material_id).type, material_id, idx});
+			} else {
+				auto &path = paths[idx];
+				sums[path.pixel] += path.throughput.cwiseProduct(background);
+			}
+		});
+	}
+}
+
+void WavefrontIntegrator::sortByMaterial() { std::sort(hit_bins.begin(), hit_bins.end()); }
+
+void WavefrontIntegrator::shade(int bounce, int roulette_min_depth) {
+	survivors.clear();
+	for (const auto &bin: hit_bins) {
+		const auto &path = paths[bin.path];
+		const auto &record = records[bin.path];
+		threadRng() = path.rng;
+		Ray scattered;
+		Color attenuation;
+		Color emission = MaterialRegistry::emitted(bin.material_id, record.u, record.v, record.p);
+		sums[path.pixel] += path.throughput.cwiseProduct(emission);
+		if (!MaterialRegistry::scatter(bin.material_id, path.ray, record, attenuation, scattered)) {
+			continue;
+		}
+		Color throughput = path.throughput.cwiseProduct(attenuation);
+		// the same roulette as Camera::shade, drawn at the same point of the random stream
+		if (bounce + 1 >= roulette_min_depth) {
+			auto survival = std::min<Real>(throughput.maxCoeff(), 1);
+			if (randomFloat() >= survival) {
+				continue;
+			}
+			throughput /= survival;
+		}
+		survivors.push_back(PathState{scattered, throughput, threadRng(), path.pixel});
+	}
+}
@@ -0,0 +1,189 @@
+/**
+ * @file WideBVH.cpp
+ * @author ayano
+ * @date 10/17/26
+ * @brief
+ */
+
+#include "WideBVH.h"
+#include <algorithm>
+#include <array>
+#include "BVHBuilder.h"
+
+namespace {
+	float surfaceArea(const LinearBVHNode &node) {
+		float dx = node.bounds_max[0] - node.bounds_min[0];
+		float dy = node.bounds_max[1] - node.bounds_min[1];
+		float dz = node.bounds_max[2] - node.bounds_min[2];
+		return dx * dy + dy * dz + dz * dx;
+	}
+} // namespace
+
+template<int Width>
+WideBVH<Width>::WideBVH(const HittableList &list) : WideBVH(list.objects, 0, list.objects.size()) {}
+
+template<int Width>
+WideBVH<Width>::WideBVH(const std::vector<std::shared_ptr<IHittable>> &objects, size_t start, size_t end) {
+	if (start == end) {
+		bbox = AABB(empty, empty, empty);
+		return;
+	}
+	std::vector<AABB> bounds;
+	bounds.reserve(end - start);
+	bbox = objects[start]->boundingBox();
+	for (size_t i = start; i < end; i++) {
+		bounds.emplace_back(objects[i]->boundingBox());
+		bbox = AABB(bbox, bounds.back());
+	}
+	auto result = buildBVH(bounds);
+	primitives.reserve(end - start);
+	for (auto idx: result.primitive_order) {
+		primitives.emplace_back(objects[start + idx]);
+	}
+	if (!result.nodes[0].isLeaf()) {
+		collapse(result.nodes, 0);
+		return;
+	}
+	// a single leaf still gets a node, traversal always starts with a box test
+	WideBVHNode<Width> root{};
+	for (int axis = 0; axis < 3; axis++) {
+		std::fill_n(root.bounds_min[axis], Width, INF);
+		std::fill_n(root.bounds_max[axis], Width, -INF);
+		root.bounds_min[axis][0] = result.nodes[0].bounds_min[axis];
+		root.bounds_max[axis][0] = result.nodes[0].bounds_max[axis];
+	}
+	root.child[0] = result.nodes[0].primitive_offset;
+	root.primitive_count[0] = result.nodes[0].primitive_count;
+	nodes.push_back(root);
+}
+
+template<int Width>
+uint32_t WideBVH<Width>::collapse(const std::vector<LinearBVHNode> &binary, uint32_t binary_index) {
+	// open the largest interior child until the node is full or only leaves are left
+	std::array<uint32_t, Width> children{};
+	int child_count = 2;
+	children[0] = binary_index + 1;
+	children[1] = binary[binary_index].second_child_offset;
+	while (child_count < Width) {
+		int largest = -1;
+		for (int i = 0; i < child_count; i++) {
+			if (!binary[children[i]].isLeaf() &&
+				(largest < 0 || surfaceArea(binary[children[i]]) > surfaceArea(binary[children[largest]]))) {
+				largest = i;
+			}
+		}
+		if (largest < 0)
+			break;
+		auto opened = children[largest];
+		children[largest] = opened + 1;
+		children[child_count++] = binary[opened].second_child_offset;
+	}
+
+	auto index = static_cast<uint32_t>(nodes.size());
+	nodes.emplace_back();
+	WideBVHNode<Width> node{};
+	for (int axis = 0; axis < 3; axis++) {
+		std::fill_n(node.bounds_min[axis], Width, INF);
+		std::fill_n(node.bounds_max[axis], Width, -INF);
+	}
+	std::array<Point3, Width> centers;
+	for (int i = 0; i < child_count; i++) {
+		const auto &child = binary[children[i]];
+		for (int axis = 0; axis < 3; axis++) {
+			node.bounds_min[axis][i] = child.bounds_min[axis];
+			node.bounds_max[axis][i] = child.bounds_max[axis];
+			centers[i][axis] = 0.5f * (child.bounds_min[axis] + child.bounds_max[axis]);
+		}
+		if (child.isLeaf()) {
+			node.child[i] = child.primitive_offset;
+			node.primitive_count[i] = child.primitive_count;
+		} else {
+			node.child[i] = collapse(binary, children[i]);
+		}
+	}
+	// children sorted along the diagonal of each octant, a cheap stand in for sorting by entry distance
+	for (int octant = 0; octant < 8; octant++) {
+		Vec3 diagonal(octant & 1 ? -1 : 1, octant & 2 ? -1 : 1, octant & 4 ? -1 : 1);
+		std::array<int, Width> order;
+		for (int i = 0; i < Width; i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.begin() + child_count,
+						 [&](int a, int b) { return centers[a].dot(diagonal) < centers[b].dot(diagonal); });
+		node.order[octant] = 0;
+		for (int k = 0; k < Width; k++)
+			node.order[octant] |= static_cast<uint32_t>(order[k]) << (4 * k);
+	}
+	nodes[index] = node;
+	return index;
+}
+
+template<int Width>
+bool WideBVH<Width>::hit(const Ray &r, Interval interval, HitRecord &record) const {
+	if (nodes.empty()) {
+		return false;
+	}
+	const SlabRay slab_ray(r);
+	const int octant = slab_ray.sign[0] | slab_ray.sign[1] << 1 | slab_ray.sign[2] << 2;
+	struct StackEntry {
+		uint32_t child;
+		uint32_t primitive_count;
+		float near;
+	};
+	// every level leaves at most Width - 1 siblings behind
+	StackEntry stack[(Width - 1) * BVHNode::max_depth + 1];
+	int stack_size = 0;
+	stack[stack_size++] = {0, 0, -INF};
+	bool hit_anything = false;
+	while (stack_size > 0) {
+		auto entry = stack[--stack_size];
+		// a closer hit was found after the child was pushed
+		if (entry.near > interval.max)
+			continue;
+		if (entry.primitive_count > 0) {
+			for (uint32_t i = 0; i < entry.primitive_count; i++) {
+				if (primitives[entry.child + i]->hit(r, interval, record)) {
+					hit_anything = true;
+					interval.max = record.t;
+				}
+			}
+			continue;
+		}
+		const auto &node = nodes[entry.child];
+		float near[Width];
+		uint32_t mask;
+		if constexpr (Width == 4) {
+			mask = rayBox4(slab_ray, node.bounds_min, node.bounds_max, interval.min, interval.max, near);
+		} else {
+			mask = rayBox8(slab_ray, node.bounds_min, node.bounds_max, interval.min, interval.max, near);
+		}
+		// push back to front so the nearest child is popped first
+		uint32_t order = node.order[octant];
+		for (int k = Width - 1; k >= 0; k--) {
+			int i = (order >> (4 * k)) & 0xF;
+			if (mask & (1u << i)) {
+				stack[stack_size++] = {node.child[i], node.primitive_count[i], near[i]};
+			}
+		}
+	}
+	return hit_anything;
+}
+
+template<int Width>
+AABB WideBVH<Width>::boundingBox() const {
+	return bbox;
+}
+
+template<int Width>
+void WideBVH<Width>::collectLights(std::vector<const IHittable *> &lights) const {
+	for (const auto &primitive: primitives) {
+		primitive->collectLights(lights);
+	}
+}
+
+template<int Width>
+const std::vector<WideBVHNode<Width>> &WideBVH<Width>::getNodes() const {
+	return nodes;
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
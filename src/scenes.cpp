@@ -9,12 +9,15 @@
 #include <memory>
 #include <spdlog/fmt/fmt.h>
 #include <string>
+#include "BVH.h"
 #include "Camera.h"
 #include "GlobUtil.hpp"
 #include "GraphicObjects.h"
 #include "ImageUtil.h"
+#include "InstanceBVH.h"
 #include "Material.h"
 #include "MathUtil.h"
+#include "SpherePool.h"
 #include "Texture.h"
 
 void render(HittableList world, Camera camera, const std::string &name = "test.ppm",
@@ -28,7 +31,20 @@ void render(HittableList world, Camera camera, const std::string &name = "test.p
 #endif
 }
 
-void randomSpheres() {
+void buildSceneBVH(Scene &scene) {
+	if (scene.bvh) {
+		scene.world = HittableList(std::make_shared<BVHNode>(scene.world));
+	}
+}
+
+void renderScene(Scene scene) {
+	buildSceneBVH(scene);
+	render(scene.world, scene.camera, scene.file);
+	// the next scene registers its own materials, these would only pile up
+	MaterialRegistry::instance().clear();
+}
+
+Scene makeRandomSpheres() {
 
 	auto camera = Camera(1920, 16.0 / 9.0, 30, {-13, 2, 3}, {4, 1, 0}, 0.6);
 
@@ -44,34 +60,36 @@ void randomSpheres() {
 	auto left_ball_material = std::make_shared<Lambertian>(Color{0.357, 0.816, 0.98});
 	auto center_ball_material = std::make_shared<Metal>(Metal(Color{0.965, 0.671, 0.729}, 0.4));
 	auto right_ball_material = std::make_shared<Dielectric>(Dielectric(1.5, Color{0.8, 0.8, 0.8}));
-	world.add(std::make_shared<Quad>(Eigen::Vector3d{-500, 0, -500}, Eigen::Vector3d{0, 0, 1000},
-									 Eigen::Vector3d{1000, 0, 0}, ground_material));
-	world.add(std::make_shared<Sphere>(Sphere(1, Eigen::Vector3d{0, 1, 0}, center_ball_material)));
-	world.add(std::make_shared<Sphere>(Sphere(1, Eigen::Vector3d{4, 1, 0}, right_ball_material)));
-	world.add(std::make_shared<Sphere>(Sphere(1, Eigen::Vector3d{-4, 1, 0}, left_ball_material)));
+	world.add(std::make_shared<Quad>(Vec3{-500, 0, -500}, Vec3{0, 0, 1000},
+									 Vec3{1000, 0, 0}, ground_material));
+	world.add(std::make_shared<Sphere>(Sphere(1, Vec3{0, 1, 0}, center_ball_material)));
+	world.add(std::make_shared<Sphere>(Sphere(1, Vec3{4, 1, 0}, right_ball_material)));
+	world.add(std::make_shared<Sphere>(Sphere(1, Vec3{-4, 1, 0}, left_ball_material)));
+	// the small spheres live in one pool instead of ~500 separate objects
+	auto spheres = std::make_shared<SpherePool>();
 	int obj = 0;
 	for (int i = -22; i < 22; i += 2) {
 		for (int j = -22; j < 22; j += 2) {
 			obj++;
-			auto coord = Eigen::Vector3d{(i + randomFloat(-1, 1)), 0.2, (j + randomFloat(-1, 1))};
-			auto displacement = Eigen::Vector3d{0, randomFloat(0, 0), 0};
+			auto coord = Vec3{(i + randomFloat(-1, 1)), 0.2, (j + randomFloat(-1, 1))};
+			auto displacement = Vec3{0, randomFloat(0, 0), 0};
 			auto material = static_cast<int>(3.0 * randomFloat());
-			if ((coord - Eigen::Vector3d{0, 1, 0}).norm() > 0.9) {
-				Eigen::Vector3d color = randomVec3().cwiseProduct(randomVec3());
+			if ((coord - Vec3{0, 1, 0}).norm() > 0.9) {
+				Vec3 color = randomVec3().cwiseProduct(randomVec3());
 				std::shared_ptr<IMaterial> sphere_mat;
 				switch (material) {
 					case 0:
 						sphere_mat = std::make_shared<Lambertian>(color);
-						world.add(std::make_shared<Sphere>(0.2, coord, coord + displacement, sphere_mat));
+						spheres->add(coord, coord + displacement, 0.2, sphere_mat);
 						break;
 					case 1:
 						sphere_mat = std::make_shared<Metal>(color, randomFloat(0.2, 0.5));
-						world.add(std::make_shared<Sphere>(0.2, coord, coord + displacement, sphere_mat));
+						spheres->add(coord, coord + displacement, 0.2, sphere_mat);
 						break;
 					case 2:
 						color = randomVec3(0.7, 1);
 						sphere_mat = std::make_shared<Dielectric>(randomFloat(1, 2), color);
-						world.add(std::make_shared<Sphere>(0.2, coord, coord + displacement, sphere_mat));
+						spheres->add(coord, coord + displacement, 0.2, sphere_mat);
 						break;
 					default:
 						break;
@@ -79,11 +97,14 @@ void randomSpheres() {
 			}
 		}
 	}
-	world = HittableList(std::make_shared<BVHNode>(world));
-	render(world, camera, "randomSpheres.ppm");
+	spheres->build();
+	world.add(spheres);
+	return {"randomSpheres.ppm", world, camera, true};
 }
 
-void twoSpheres() {
+void randomSpheres() { renderScene(makeRandomSpheres()); }
+
+Scene makeTwoSpheres() {
 	auto camera = Camera(400, 16.0 / 9.0, 30, {0, 0, 0}, {0, 0, -30}, 0.6);
 	camera.setSampleCount(100);
 	camera.setShutterSpeed(1.0 / 24.0);
@@ -97,11 +118,12 @@ void twoSpheres() {
 	auto sphere_material = std::make_shared<Lambertian>(Lambertian(checker));
 	world.add(std::make_shared<Sphere>(20.0, Point3{0, -20.0, -30}, sphere_material));
 	world.add(std::make_shared<Sphere>(20.0, Point3{0, 20.0, -30}, sphere_material));
-	world = HittableList(std::make_shared<BVHNode>(world));
-	render(world, camera, "twoSpheres.ppm");
+	return {"twoSpheres.ppm", world, camera, true};
 }
 
-void huajiSphere() {
+void twoSpheres() { renderScene(makeTwoSpheres()); }
+
+Scene makeHuajiSphere() {
 	auto camera = Camera(400, 16.0 / 9.0, 45, {0, 0, 0}, {0, 0, -30}, 0.1);
 	camera.setSampleCount(100);
 	camera.setShutterSpeed(1.0 / 24.0);
@@ -113,11 +135,12 @@ void huajiSphere() {
 	auto huaji_texture = std::make_shared<ImageTexture>("huaji.jpeg");
 	auto huaji_material = std::make_shared<Lambertian>(huaji_texture);
 	world.add(std::make_shared<Sphere>(10.0, Point3{0, 0, -30}, huaji_material));
-	world = HittableList(std::make_shared<BVHNode>(world));
-	render(world, camera, "huajiSphere.ppm");
+	return {"huajiSphere.ppm", world, camera, true};
 }
 
-void perlinSpheres() {
+void huajiSphere() { renderScene(makeHuajiSphere()); }
+
+Scene makePerlinSpheres() {
 	HittableList world;
 	Camera camera(1920, 16.0 / 9.0, 20, Point3{-13, 2, 3}, Point3{0, 0, 0}, 0);
 	camera.setSampleCount(100);
@@ -129,11 +152,12 @@ void perlinSpheres() {
 	auto tex = std::make_shared<NoiseTexture>(1, 10, 0.5);
 	world.add(std::make_shared<Sphere>(1000, Point3{0, -1000, 0}, std::make_shared<Lambertian>(tex)));
 	world.add(std::make_shared<Sphere>(2, Point3{0, 2, 0}, std::make_shared<Lambertian>(tex)));
-
-	render(world, camera, "perlinSpheres.ppm");
+	return {"perlinSpheres.ppm", world, camera, false};
 }
 
-void terrain() {
+void perlinSpheres() { renderScene(makePerlinSpheres()); }
+
+Scene makeTerrain() {
 	HittableList world;
 	Camera camera(400, 16.0 / 9.0, 20, Point3{0, 0, -50}, Point3{0, 0, 0}, 0);
 	camera.setSampleCount(10);
@@ -144,10 +168,11 @@ void terrain() {
 	camera.setBackground(Color{0.7, 0.8, 1});
 	auto tex = std::make_shared<TerrainTexture>(0.5, 10, 0.5);
 	world.add(std::make_shared<Sphere>(10, Point3{0, 0, 0}, std::make_shared<Lambertian>(tex)));
-
-	render(world, camera, "terrain.ppm");
+	return {"terrain.ppm", world, camera, false};
 }
 
+void terrain() { renderScene(makeTerrain()); }
+
 void rotationTest() {
 	HittableList world;
 	Camera camera(400, 16.0 / 9.0, 70, {0, 0, 0}, {0, 0, 1}, 0);
@@ -172,26 +197,30 @@ void rotationTest() {
 	world.add(std::make_shared<Sphere>(1, Point3{-5, 0, 0}, mat_negx));
 
 	world = HittableList(std::make_shared<BVHNode>(world));
-	auto rot_init = Eigen::Vector3d{0, 2 * PI / 36, 0};
+	auto rot_init = Vec3{0, 2 * PI / 36, 0};
 	for (int i = 0; i < 36; ++i) {
 		camera.setRotation(rot_init * i);
+		camera.setFrame(i);
 		render(world, camera, "frame_" + std::to_string(i) + "_" + vecToStr(camera.getRotation()) + ".ppm",
 			   std::string(IMG_OUTPUT_DIR) + "/theta");
 	}
 	camera.setRotation({0, 0, 0});
-	rot_init = Eigen::Vector3d{2 * PI / 36, 0, 0};
+	rot_init = Vec3{2 * PI / 36, 0, 0};
 	for (int i = 0; i < 36; ++i) {
 		camera.setRotation(rot_init * i);
+		camera.setFrame(i);
 		render(world, camera, "frame_" + std::to_string(i) + "_" + vecToStr(camera.getRotation()) + ".ppm",
 			   std::string(IMG_OUTPUT_DIR) + "/phi");
 	}
 	camera.setRotation({0, 0, 0});
-	rot_init = Eigen::Vector3d{0, 0, 2 * PI / 36};
+	rot_init = Vec3{0, 0, 2 * PI / 36};
 	for (int i = 0; i < 36; ++i) {
 		camera.setRotation(rot_init * i);
+		camera.setFrame(i);
 		render(world, camera, "frame_" + std::to_string(i) + "_" + vecToStr(camera.getRotation()) + ".ppm",
 			   std::string(IMG_OUTPUT_DIR) + "/psi");
 	}
+	MaterialRegistry::instance().clear();
 }
 
 void targetingTest() {
@@ -202,19 +231,19 @@ void targetingTest() {
 	auto ball_dist = 8;
 	auto ball_rad = 1;
 	auto world = HittableList();
-	std::vector<Eigen::Vector3d> pos1;
-	std::vector<Eigen::Vector3d> pos2;
-	for (double i = 0; i < 2 * PI; i += 2 * PI / ball_cnt) {
-		double x = ball_dist * cos(i);
-		double z = ball_dist * sin(i);
+	std::vector<Vec3> pos1;
+	std::vector<Vec3> pos2;
+	for (Real i = 0; i < 2 * PI; i += 2 * PI / ball_cnt) {
+		Real x = ball_dist * cos(i);
+		Real z = ball_dist * sin(i);
 		pos1.emplace_back(x, 0, z);
 		pos2.emplace_back(0, x, z);
 		auto color = Color{i / (2 * PI), 0, 0};
 		auto color2 = Color{0, i / (2 * PI), 0};
 		auto mat = std::make_shared<Lambertian>(color);
 		auto mat2 = std::make_shared<Lambertian>(color2);
-		world.add(std::make_shared<Sphere>(ball_rad, Eigen::Vector3d{x, 0, z}, mat));
-		world.add(std::make_shared<Sphere>(ball_rad, Eigen::Vector3d{0, x, z}, mat2));
+		world.add(std::make_shared<Sphere>(ball_rad, Vec3{x, 0, z}, mat));
+		world.add(std::make_shared<Sphere>(ball_rad, Vec3{0, x, z}, mat2));
 	}
 
 	Camera overview = camera;
@@ -243,20 +272,21 @@ void targetingTest() {
 		idx++;
 		camera.Render(world, ss.str(), std::string(IMG_OUTPUT_DIR) + "/verticalTargetTest");
 	}
+	MaterialRegistry::instance().clear();
 }
 
-void quads() {
+Scene makeQuads() {
 	HittableList world;
 
 	auto blue = std::make_shared<Lambertian>(Color{0.36, 0.81, 0.98});
 	auto pink = std::make_shared<Lambertian>(Color{0.96, 0.66, 0.72});
 	auto white = std::make_shared<Lambertian>(Color{1, 1, 1});
 
-	world.add(std::make_shared<Quad>(Point3{-3, -2, 5}, Eigen::Vector3d{0, 0, -4}, Eigen::Vector3d{0, 4, 0}, blue));
-	world.add(std::make_shared<Quad>(Point3{-2, -2, 0}, Eigen::Vector3d{4, 0, 0}, Eigen::Vector3d{0, 4, 0}, white));
-	world.add(std::make_shared<Quad>(Point3{3, -2, 1}, Eigen::Vector3d{0, 0, 4}, Eigen::Vector3d{0, 4, 0}, pink));
-	world.add(std::make_shared<Quad>(Point3{-2, 3, 1}, Eigen::Vector3d{4, 0, 0}, Eigen::Vector3d{0, 0, 4}, blue));
-	world.add(std::make_shared<Quad>(Point3{-2, -3, 5}, Eigen::Vector3d{4, 0, 0}, Eigen::Vector3d{0, 0, -4}, pink));
+	world.add(std::make_shared<Quad>(Point3{-3, -2, 5}, Vec3{0, 0, -4}, Vec3{0, 4, 0}, blue));
+	world.add(std::make_shared<Quad>(Point3{-2, -2, 0}, Vec3{4, 0, 0}, Vec3{0, 4, 0}, white));
+	world.add(std::make_shared<Quad>(Point3{3, -2, 1}, Vec3{0, 0, 4}, Vec3{0, 4, 0}, pink));
+	world.add(std::make_shared<Quad>(Point3{-2, 3, 1}, Vec3{4, 0, 0}, Vec3{0, 0, 4}, blue));
+	world.add(std::make_shared<Quad>(Point3{-2, -3, 5}, Vec3{4, 0, 0}, Vec3{0, 0, -4}, pink));
 	Camera camera(1920, 9.0 / 9.0, 90, {0, 0, 9}, {0, 0, 0}, 0);
 	camera.setSampleCount(100);
 	camera.setShutterSpeed(1.0 / 24.0);
@@ -264,10 +294,12 @@ void quads() {
 	camera.setRenderThreadCount(20);
 	camera.setChunkDimension(64);
 	camera.setBackground(Color{0.7, 0.8, 1});
-	render(world, camera, "quads.ppm");
+	return {"quads.ppm", world, camera, false};
 }
 
-void triangles() {
+void quads() { renderScene(makeQuads()); }
+
+Scene makeTriangles() {
 	HittableList world;
 
 	auto blue = std::make_shared<Lambertian>(Color{0.36, 0.81, 0.98});
@@ -276,8 +308,8 @@ void triangles() {
 
 	Point3 p1{1.5, 1.5, 0};
 	Point3 p2{-1.5, -1.5, 0};
-	Eigen::Vector3d vertical{3, 0, 0};
-	Eigen::Vector3d horizontal{0, 3, 0};
+	Vec3 vertical{3, 0, 0};
+	Vec3 horizontal{0, 3, 0};
 
 	world.add(std::make_shared<Triangle>(p1, -vertical, -horizontal, blue));
 	world.add(std::make_shared<Triangle>(p2, vertical, horizontal, pink));
@@ -288,39 +320,45 @@ void triangles() {
 	camera.setRenderThreadCount(20);
 	camera.setChunkDimension(64);
 	camera.setBackground(Color{0.7, 0.8, 1});
-	render(world, camera, "triangle.ppm");
+	return {"triangle.ppm", world, camera, false};
 }
 
-void cornellBox() {
+void triangles() { renderScene(makeTriangles()); }
+
+Scene makeCornellBox() {
 	auto red = std::make_shared<Lambertian>(Color{.65, .05, .05});
 	auto white = std::make_shared<Lambertian>(Color{.73, .73, .73});
 	auto green = std::make_shared<Lambertian>(Color{.12, .45, .15});
 	auto light = std::make_shared<DiffuseLight>(Color{15, 15, 15});
 	HittableList world;
 
-	world.add(std::make_shared<Quad>(Point3{555, 0, 0}, Eigen::Vector3d{0, 555, 0}, Eigen::Vector3d{0, 0, 555}, green));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Eigen::Vector3d{0, 555, 0}, Eigen::Vector3d{0, 0, 555}, red));
-	world.add(std::make_shared<Quad>(Point3{343, 554, 332}, Eigen::Vector3d{-130, 0, 0}, Eigen::Vector3d{0, 0, -105},
+	world.add(std::make_shared<Quad>(Point3{555, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, green));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, red));
+	world.add(std::make_shared<Quad>(Point3{343, 554, 332}, Vec3{-130, 0, 0}, Vec3{0, 0, -105},
 									 light));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Eigen::Vector3d{555, 0, 0}, Eigen::Vector3d{0, 0, 555}, white));
-	world.add(std::make_shared<Quad>(Point3{555, 555, 555}, Eigen::Vector3d{-555, 0, 0}, Eigen::Vector3d{0, 0, -555},
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{555, 0, 0}, Vec3{0, 0, 555}, white));
+	world.add(std::make_shared<Quad>(Point3{555, 555, 555}, Vec3{-555, 0, 0}, Vec3{0, 0, -555},
 									 white));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 555}, Eigen::Vector3d{555, 0, 0}, Eigen::Vector3d{0, 555, 0}, white));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 555}, Vec3{555, 0, 0}, Vec3{0, 555, 0}, white));
 
 	Camera camera(1920, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
-	camera.setSampleCount(10000);
+	// light sampling reaches the noise of 10000 samples without it at about a tenth of that
+	camera.setSampleCount(1024);
 	camera.setShutterSpeed(1.0 / 24.0);
 	camera.setRenderDepth(4);
 	camera.setRenderThreadCount(20);
 	camera.setChunkDimension(64);
 	camera.setBackground(Color{0, 0, 0});
+	// long enough to be worth resuming, a killed render picks up from its last checkpoint
+	camera.setProgressivePassSamples(256);
+	camera.setCheckpointPath(mkdir(IMG_OUTPUT_DIR, "emptyCornell.ckpt"));
 
-	world = HittableList(std::make_shared<BVHNode>(world));
-
-	render(world, camera, "emptyCornell.ppm");
+	return {"emptyCornell.ppm", world, camera, true};
 }
 
-void cornellBoxWithObjects() {
+void cornellBox() { renderScene(makeCornellBox()); }
+
+Scene makeCornellBoxWithObjects() {
 	auto red = std::make_shared<Lambertian>(Color{.65, .05, .05});
 	auto white = std::make_shared<Lambertian>(Color{.73, .73, .73});
 	auto green = std::make_shared<Lambertian>(Color{.12, .45, .15});
@@ -328,14 +366,14 @@ void cornellBoxWithObjects() {
 	auto light = std::make_shared<DiffuseLight>(Color{15, 15, 15});
 	HittableList world;
 
-	world.add(std::make_shared<Quad>(Point3{555, 0, 0}, Eigen::Vector3d{0, 555, 0}, Eigen::Vector3d{0, 0, 555}, green));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Eigen::Vector3d{0, 555, 0}, Eigen::Vector3d{0, 0, 555}, red));
-	world.add(std::make_shared<Quad>(Point3{343, 554, 332}, Eigen::Vector3d{-130, 0, 0}, Eigen::Vector3d{0, 0, -105},
+	world.add(std::make_shared<Quad>(Point3{555, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, green));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{0, 555, 0}, Vec3{0, 0, 555}, red));
+	world.add(std::make_shared<Quad>(Point3{343, 554, 332}, Vec3{-130, 0, 0}, Vec3{0, 0, -105},
 									 light));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Eigen::Vector3d{555, 0, 0}, Eigen::Vector3d{0, 0, 555}, white));
-	world.add(std::make_shared<Quad>(Point3{555, 555, 555}, Eigen::Vector3d{-555, 0, 0}, Eigen::Vector3d{0, 0, -555},
+	world.add(std::make_shared<Quad>(Point3{0, 0, 0}, Vec3{555, 0, 0}, Vec3{0, 0, 555}, white));
+	world.add(std::make_shared<Quad>(Point3{555, 555, 555}, Vec3{-555, 0, 0}, Vec3{0, 0, -555},
 									 white));
-	world.add(std::make_shared<Quad>(Point3{0, 0, 555}, Eigen::Vector3d{555, 0, 0}, Eigen::Vector3d{0, 555, 0}, white));
+	world.add(std::make_shared<Quad>(Point3{0, 0, 555}, Vec3{555, 0, 0}, Vec3{0, 555, 0}, white));
 
 	Camera camera(800, 16.0 / 9.0, 40, {278, 278, -800}, {278, 278, 0}, 0);
 	camera.setSampleCount(20);
@@ -345,20 +383,36 @@ void cornellBoxWithObjects() {
 	camera.setChunkDimension(64);
 	camera.setBackground(Color{0, 0, 0});
 
-	std::shared_ptr<IHittable> box1 = box(Point3{0, 0, 0}, Point3{165, 330, 165}, white);
-
-	box1 = std::make_shared<Rotation>(box1, 0, deg2Rad(-15), 0, Point3{0, 0, 0});
-	box1 = std::make_shared<Translate>(box1, Eigen::Vector3d{265, 0, 295});
-
-	std::shared_ptr<IHittable> box2 = box(Point3{0, 0, 0}, Point3{165, 165, 165}, red);
-
-	box2 = std::make_shared<Rotation>(box2, 0, deg2Rad(18), 0, Point3{0, 0, 0});
-	box2 = std::make_shared<Translate>(box2, Eigen::Vector3d{130, 0, 65});
-
-	world.add(box1);
-	world.add(box2);
-
-	world = HittableList(std::make_shared<BVHNode>(world));
+	// both boxes are instances of one unit cube
+	auto boxes = std::make_shared<InstanceBVH>();
+	auto cube = boxes->addGeometry(box(Point3{0, 0, 0}, Point3{1, 1, 1}, white));
+	boxes->addInstance(cube, Translation3{265, 0, 295} *
+									 AngleAxis(deg2Rad(15), Vec3::UnitY()) *
+									 Eigen::Scaling(Vec3{165, 330, 165}));
+	boxes->addInstance(cube, Translation3{130, 0, 65} *
+									 AngleAxis(deg2Rad(-18), Vec3::UnitY()) *
+									 Eigen::Scaling(Vec3{165, 165, 165}),
+					   red);
+	boxes->build();
+
+	world.add(boxes);
+
+	return {"cornell.ppm", world, camera, true};
+}
 
-	render(world, camera, "cornell.ppm");
+void cornellBoxWithObjects() { renderScene(makeCornellBoxWithObjects()); }
+
+const std::vector<std::pair<std::string, Scene (*)()>> &sceneSuite() {
+	static const std::vector<std::pair<std::string, Scene (*)()>> suite = {
+			{"randomSpheres", makeRandomSpheres},
+			{"twoSpheres", makeTwoSpheres},
+			{"huajiSphere", makeHuajiSphere},
+			{"perlinSpheres", makePerlinSpheres},
+			{"terrain", makeTerrain},
+			{"quads", makeQuads},
+			{"triangles", makeTriangles},
+			{"cornellBox", makeCornellBox},
+			{"cornellBoxWithObjects", makeCornellBoxWithObjects},
+	};
+	return suite;
 }